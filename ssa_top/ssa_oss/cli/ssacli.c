@@ -30,18 +30,72 @@
  *  Example:
  *      ssacli "{STORE=path/to/cred,DST=my/place/to/store} {IDENT=MACADDR} {CA=CREATE=my/path/to/store,EXPIR=3y,..}
  *
+ *  What a command returns, such as an IDENT attribute, is written to stdout, one line per command:
+ *      ssacli "{IDENT=BASEMACADDRESS}" "{IDENT=SERIALNUMBER}"
+ *
+ *  Batch mode runs many commands in one process, one command per line of a file or of stdin:
+ *      ssacli --batch [file]
+ *  Blank lines and lines starting with '#' are skipped.  Every command is run even if an earlier one
+ *  failed, and a "<line number> <status> <message>" record is written to stdout for it.
+ *  The exit status is that of the first command that failed.
+ *
+ *  Daemon mode keeps one process, with its provider state, serving commands from local scripts:
+ *      ssacli --daemon <socket path> [workers]
+ *  It listens on a Unix stream socket that only its own user can use (and root).  A client writes
+ *  command lines as in batch mode, as many as it likes without waiting, and reads one record per line
+ *  back, in order; e.g. printf '{MOUNT=UNMOUNT,MOUNTPOINT=/mnt/a}\n' | socat - UNIX-CONNECT:<socket path>
+ *  Connections are served by a pool of worker threads, one connection at a time each.  KEY=STDIN is
+ *  refused.  A connection that sends nothing for SSACLI_DAEMON_IDLE_S seconds is closed.
+ *
+ *  Structured output: with --json first, every command (argument, batch line or daemon line) gets one
+ *  JSON record on stdout instead, with what the provider returned in base64:
+ *      ssacli --json "{IDENT=BASEMACADDRESS}"  ->  {"cmd":1,"status":0,"message":"ok","provider":"IDENT",
+ *                                                  "api":"BASEMACADDRESS","data":"MDA6MTE6MjI6MzM6NDQ6NTUA"}
+ *  "cmd" is the argument number, or the line number in batch and daemon mode; "data" is null when the
+ *  command returned nothing.  In argument mode processing still stops after the first failing command.
+ *
  *  Note:  with some simple parsing the same pattern as the providers themselves can/should be used to process the
  *  series of {} strings and ProviderAttributeStrings.
  *  Note2: The character set permitted for ANY and ALL inputs to the ssa handlers is limited, see rdkssa.h
  *
  */
 
+#define _GNU_SOURCE     // struct ucred
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include "rdkssa.h"
 #include "safec_lib.h"
 // after error reporting, exit or not?
 #define DO_EXIT 1
 #define DONT_EXIT 0
 
+#define BATCH_ARG   "--batch"
+#define DAEMON_ARG  "--daemon"
+#define JSON_ARG    "--json"
+#define BATCH_LINE_MAX  MAX_ATTRIBUTE_NAME_LENGTH   /* processCmd takes no longer command */
+
+#ifndef SSACLI_DAEMON_WORKERS
+#define SSACLI_DAEMON_WORKERS   (4)
+#endif
+#define SSACLI_DAEMON_MAX_WORKERS   (64)
+#ifndef SSACLI_DAEMON_IDLE_S
+#define SSACLI_DAEMON_IDLE_S    (30)
+#endif
+
+/* what a command did, for its output record */
+typedef struct {
+    char provider[MAX_ATTRIBUTE_NAME_LENGTH+1];
+    char api[MAX_ATTRIBUTE_NAME_LENGTH+1];
+    rdkssaDataBufPtr_t data;    /* returned by the provider, from rdkssaDataBufAlloc; or NULL */
+} cmdResult_t;
+
+static int jsonRecords;         /* --json: write JSON records rather than text */
+
 static rdkssaStatus_t handleError( rdkssaStatus_t err, int doExit );
 
 /**
@@ -49,18 +103,20 @@ static rdkssaStatus_t handleError( rdkssaStatus_t err, int doExit );
  */
 static void cliCheck( int argc, char *argv[]  )
 {
-    if ( argc < 2 ) {
-        RDKSSA_LOG_ERROR("syntax: ssacli \"{cmds}\" ...\n");
+    if ( argc < 2 || ( strcmp( argv[1], BATCH_ARG ) == 0 && argc > 3 ) ||
+         ( strcmp( argv[1], DAEMON_ARG ) == 0 && ( argc < 3 || argc > 4 ) ) ) {
+        RDKSSA_LOG_ERROR("syntax: ssacli [" JSON_ARG "] \"{cmds}\" ... | " BATCH_ARG " [file] | " DAEMON_ARG " <socket> [workers]\n");
         exit( 1 );
     }
 }
 
 /**
- * cleanupVector        -       free everything of an allocated array of pointers to allocation memory
+ * cleanupVector        -       free a vector from parseProvCmds; vector and strings are one allocation
  */
 static void cleanupVector( const char ***v )
 {
-    rdkssaCleanupVector( (char ***)v ); // this is allocated space so it's not really a const
+    free( (void *)*v );
+    *v = NULL;
 }
 
 /**
@@ -69,6 +125,9 @@ static void cleanupVector( const char ***v )
  * According to the rules, each attrib is separated by ',' and the list terminates with '}'
  * When '}' is found, parsing stops!  
  *
+ * The vector and a copy of provCmds share one allocation sized from the input; the copy is
+ * split in place so the attributes point into it.  Release with cleanupVector.
+ *
  * Returns a vector of strings if successful, NULL if failures due to syntax or some other weirdness
  */
 static const char **parseProvCmds( const char *provCmds )
@@ -79,16 +138,26 @@ static const char **parseProvCmds( const char *provCmds )
         RDKSSA_LOG_ERROR( "null argument\n" );
         return NULL;
     }
-    char **newVector = calloc( (MAX_SUPPORTED_ATTRIBUTES+1), sizeof(char *) );
+    // one entry per ',' plus the last, then the NULL terminator
+    size_t len = strlen( provCmds );
+    int entries = 1;
+    const char *str;
+    for ( str = strchr( provCmds, ATTRIB_DELIM ); str != NULL && entries < MAX_SUPPORTED_ATTRIBUTES;
+          str = strchr( str+1, ATTRIB_DELIM ) ) {
+        entries++;
+    }
+    char **newVector = malloc( (entries+1)*sizeof(char *) + len+1 );
     if ( newVector == NULL ) {
         RDKSSA_LOG_ERROR( "vector allocation failure\n" );
         return NULL;
     }
+    char *arena = (char *)( newVector+entries+1 );
+    memcpy( arena, provCmds, len+1 );
 
     int strIx=0;
-    const char *delim;
+    char *delim;
     const char *value;
-    const char *str = provCmds;  /* I don't like to eat input args */
+    str = arena;  /* I don't like to eat input args */
     do {
         delim = strchr( str, ATTRIB_DELIM ); /* is there a comma separator? */
         if ( delim == NULL ) {
@@ -108,37 +177,33 @@ static const char **parseProvCmds( const char *provCmds )
                 goto theCleaners;
             }
         }
-        int attrlen = delim-str;
-        newVector[strIx] = malloc( attrlen+1 );
-        errno_t  rc = -1;
-
-        if ( newVector[strIx] == NULL ) {
-            RDKSSA_LOG_ERROR( "malloc failure\n" );
-            goto theCleaners;
-        }
-        rc = strncpy_s( newVector[strIx], attrlen+1 , str, attrlen );
-        ERR_CHK(rc);
-        newVector[strIx][attrlen] = '\0';
+        int isTail = ( *delim == COMMAND_TAIL );
+        *delim = '\0';
+        newVector[strIx] = (char *)str;
         RDKSSA_LOG_INFO( "attrib = %s\n",newVector[strIx] );
         strIx++;
         str=delim+1;
-    } while ( *delim != COMMAND_TAIL && strIx < MAX_SUPPORTED_ATTRIBUTES );
+        if ( isTail ) {
+            break;
+        }
+    } while ( strIx < entries && strIx < MAX_SUPPORTED_ATTRIBUTES );
     if ( strIx >= MAX_SUPPORTED_ATTRIBUTES ) {
         RDKSSA_LOG_ERROR( "too many attribs in provCmds\n" );
         goto theCleaners;
     }
+    newVector[strIx] = NULL;
 
 #ifdef RDKSSA_DEBUG_ENABLED
     int i;
     RDKSSA_LOG_DEBUG( "Here's what the parser brought home:\n");
-    for(i=0; i<MAX_SUPPORTED_ATTRIBUTES; i++) {
-        if ( newVector[i] != NULL ) { RDKSSA_LOG_DEBUG( "(%d) : %s\n", i, newVector[i] ); }
+    for(i=0; newVector[i] != NULL; i++) {
+        RDKSSA_LOG_DEBUG( "(%d) : %s\n", i, newVector[i] );
     }
 #endif // RDKSSA_DEBUG_ENABLED  
     return (const char **)newVector;
 
 theCleaners:
-    rdkssaCleanupVector( &newVector );
+    free( newVector );
     return NULL;
 }
 
@@ -151,11 +216,12 @@ theCleaners:
  * MOUNT
  */
 
-typedef rdkssaStatus_t (*provWrapperFunc)( const char *provAPIname, const char *vector[] );
-static  rdkssaStatus_t callStorProvider( const char *provAPIname, const char *vector[] );
-static  rdkssaStatus_t callCAProvider( const char *provAPIname, const char *vector[] );
-static  rdkssaStatus_t callIdentProvider( const char *provAPIname, const char *vector[] );
-static  rdkssaStatus_t callMountProvider( const char *provAPIname, const char *vector[] );
+/* a wrapper that gets data back from its API hands it over in *out, from rdkssaDataBufAlloc */
+typedef rdkssaStatus_t (*provWrapperFunc)( const char *provAPIname, const char *vector[], rdkssaDataBufPtr_t *out );
+static  rdkssaStatus_t callStorProvider( const char *provAPIname, const char *vector[], rdkssaDataBufPtr_t *out );
+static  rdkssaStatus_t callCAProvider( const char *provAPIname, const char *vector[], rdkssaDataBufPtr_t *out );
+static  rdkssaStatus_t callIdentProvider( const char *provAPIname, const char *vector[], rdkssaDataBufPtr_t *out );
+static  rdkssaStatus_t callMountProvider( const char *provAPIname, const char *vector[], rdkssaDataBufPtr_t *out );
 
 
 static struct {
@@ -175,9 +241,10 @@ static struct {
  * theProv		=	The name string of a supported provder
  * provCmds		=	pointer either to the provider name if no attribute vector expected, or 
  *					pointer to first char of name=value,... sets to be parsed into the provider's vector.
+ * res			=	gets the API name and any data the provider returned
  * returns		=	result of either a parse error, or provider's status
  */
-static rdkssaStatus_t callProvider( const char *theProv, const char *provCmds )
+static rdkssaStatus_t callProvider( const char *theProv, const char *provCmds, cmdResult_t *res )
 {
 	int i;
 	rdkssaStatus_t retStatus;
@@ -219,8 +286,9 @@ static rdkssaStatus_t callProvider( const char *theProv, const char *provCmds )
 		return rdkssaSyntaxError;
 	}
 	RDKSSA_LOG_DEBUG( "cmd: %s\n", cmd );
+	strcpy( res->api, cmd );	/* length checked */
 	const char **provAttributex = cmdVector+1;
-	retStatus=selectedProvider( cmd, provAttributex );
+	retStatus=selectedProvider( cmd, provAttributex, &res->data );
 	cleanupVector( &cmdVector );
 	return retStatus;
 }	
@@ -232,7 +300,7 @@ static rdkssaStatus_t callProvider( const char *theProv, const char *provCmds )
  *   CA=UPDATE rdkssaCAUpdatePKCS12
 
  */
-static rdkssaStatus_t callCAProvider( const char *apiName, const char *apiVector[] )
+static rdkssaStatus_t callCAProvider( const char *apiName, const char *apiVector[], rdkssaDataBufPtr_t *out )
 {
 	return rdkssaNYIError;
 }
@@ -240,38 +308,117 @@ static rdkssaStatus_t callCAProvider( const char *apiName, const char *apiVector
 /**
  * callStorProvider -       handle "STOR="
  */
-static rdkssaStatus_t callStorProvider( const char *apiName, const char *apiVector[] )
+static rdkssaStatus_t callStorProvider( const char *apiName, const char *apiVector[], rdkssaDataBufPtr_t *out )
 {
 	return rdkssaNYIError;
 }
 
 
 /**
-* callIdenProvider -       handle "IDENT="
+ * callDataApi      -       Call an API that returns data in a rdkssaDataBuf_t, in *out
+ *
+ * A buffer of CLI_DATA_SIZE is tried first; if the API says it needs more, the call is made again
+ * with what it asked for (up to MAX_ATTRIBUTE_BUFF_LENGTH).  *out is NULL unless the call succeeded.
+ */
+#define CLI_DATA_SIZE   (256)
+
+static rdkssaStatus_t callDataApi( rdkssaStatus_t (*api)( rdkssa_blobptr_t, const char * const [] ),
+                                   const char * const attributes[], rdkssaDataBufPtr_t *out )
+{
+	size_t size = CLI_DATA_SIZE, needed;
+	rdkssaStatus_t stat = rdkssaGeneralFailure;
+	int tries;
+
+	for ( tries = 0; tries < 2; tries++ ) {
+		if ( ( *out = rdkssaDataBufAlloc( size ) ) == NULL ) {
+			RDKSSA_LOG_ERROR( "data buffer allocation failure\n" );
+			return rdkssaGeneralFailure;
+		}
+		stat = api( *out, attributes );
+		if ( RDKSSA_SUCCESS( stat ) ) {
+			break;
+		}
+		needed = (*out)->sizeOfData;
+		rdkssaDataBufRelease( *out );
+		*out = NULL;
+		if ( stat != rdkssaBadLength || needed <= size || needed > MAX_ATTRIBUTE_BUFF_LENGTH ) {
+			break;
+		}
+		size = needed;
+	}
+	return stat;
+}
+
+/**
+* callIdenProvider -       handle "IDENT=<attribute>", e.g. IDENT=BASEMACADDRESS, returning its value
 */
-static rdkssaStatus_t callIdentProvider( const char *apiName, const char *apiVector[] )
+static rdkssaStatus_t callIdentProvider( const char *apiName, const char *apiVector[], rdkssaDataBufPtr_t *out )
 {
-	return rdkssaNYIError;
+	const char * const attributes[] = { apiName, NULL };
+
+	if ( apiVector[0] != NULL ) {
+		RDKSSA_LOG_ERROR( "IDENT takes one attribute\n" );
+		return rdkssaSyntaxError;
+	}
+	return callDataApi( rdkssaGetIdentityAttribute, attributes, out );
 }
 
 /**
  * callMountProvider - 		handle "MOUNT="
  *
- * The default OSS implementation of the Mount provider only supports
+ * The default OSS implementation of the Mount provider supports
  * MOUNT API with attributes:
  *  MOUNTPOINT=<mountpoint>
  *  PATH=<path> attributes.
+ *  BACKEND=HELPER|FSCRYPT
+ * UNMOUNT API with attributes:
+ *  MOUNTPOINT=<mountpoint> and/or PATH=<path>, each may be repeated
+ *  LAZY=YES|NO
+ * BATCH API (rdkssaMountBatch) with attributes:
+ *  MOUNTPOINT=<mountpoint>,PATH=<path>[,KEY=<key>] per volume, repeated
+ *  WORKERS=<n>
+ *  BACKEND=HELPER|FSCRYPT
  *
- * UNMOUNT API, and KEY=, PARTITION= are not supported at this time.
+ * KEY=, PARTITION= are not supported at this time.
  *
  * if they are supported in the future via the Cli, additional logic is needed here to handle 
  */
-static rdkssaStatus_t callMountProvider( const char *apiName, const char *apiVector[] )
+// MOUNT=BATCH, naming the volumes that failed
+static rdkssaStatus_t callMountBatch( const char *apiVector[] )
+{
+		rdkssaStatus_t status[MAX_SUPPORTED_ATTRIBUTES];
+		rdkssaStatus_t retStatus;
+		int i, n = 0;
+
+		for ( i = 0; i < MAX_SUPPORTED_ATTRIBUTES; i++ ) {
+			status[i] = rdkssaOK;	/* stays so if the attributes are rejected before any mount */
+		}
+		retStatus = rdkssaMountBatch( status, apiVector );
+		/* say which volumes failed */
+		for ( i = 0; apiVector[i] != NULL; i++ ) {
+			if ( strncmp( apiVector[i], "MOUNTPOINT=", strlen("MOUNTPOINT=") ) != 0 ) {
+				continue;
+			}
+			if ( !RDKSSA_SUCCESS( status[n] ) ) {
+				fprintf( stderr, "%s - error %d\n", apiVector[i], status[n] );
+			}
+			n++;
+		}
+		return retStatus;
+}
+
+static rdkssaStatus_t callMountProvider( const char *apiName, const char *apiVector[], rdkssaDataBufPtr_t *out )
 {
 		RDKSSA_LOG_DEBUG( "Calling provider: %s\n", apiName );
 		if ( strcmp( apiName, "MOUNT" ) == 0 ) {
 			return rdkssaMount(NULL, apiVector);
 		} 
+		if ( strcmp( apiName, "UNMOUNT" ) == 0 ) {
+			return rdkssaUnmount(NULL, apiVector);
+		} 
+		if ( strcmp( apiName, "BATCH" ) == 0 ) {
+			return callMountBatch( apiVector );
+		} 
 		return rdkssaNYIError;
 }
 
@@ -289,10 +436,13 @@ static rdkssaStatus_t callMountProvider( const char *apiName, const char *apiVec
  * attributestring : attrib  |  name=value
  *
  * Calls helper functions to parse the command string 
+ * res gets the provider and API names and any data returned; release it with cmdResultRelease
  */
-static rdkssaStatus_t processCmd( const char *cmdStr )
+static rdkssaStatus_t processCmd( const char *cmdStr, cmdResult_t *res )
 {
     RDKSSA_LOG_INFO( "processCmd [%s]\n", cmdStr?cmdStr:"NULL" );
+    res->provider[0] = res->api[0] = '\0';
+    res->data = NULL;
 
     if ( cmdStr == NULL ) {
         RDKSSA_LOG_ERROR( "null pointer error processing cmd\n");
@@ -314,7 +464,7 @@ static rdkssaStatus_t processCmd( const char *cmdStr )
     rdkssaStatus_t rc = rdkssaSyntaxError; 
     RDKSSA_LOG_DEBUG("Parsing provider name from [%s]\n", charp);
 
-	char provName[MAX_ATTRIBUTE_NAME_LENGTH];	// length check already done
+	char *provName = res->provider;	// length check already done
 	char *cp = provName;
 	while( (*cp = *charp) != '\0' && *charp != '=' ) {	// copy up to = or eostring
 		cp++;charp++;
@@ -326,21 +476,24 @@ static rdkssaStatus_t processCmd( const char *cmdStr )
 	} else {
 		charp = provName;
 	}
-	rc = callProvider( provName, charp );
+	rc = callProvider( provName, charp, res );
 	
     RDKSSA_LOG_DEBUG("processCmd Ret rc =[%d]\n", rc);
     return rc;
 }
 
 /**
- * handleError      -       Given an error code, print and optionally exit
+ * statusMessage    -       Text for a status, for error messages and batch records
  */
-static rdkssaStatus_t handleError( rdkssaStatus_t err, int doExit )
+static const char *statusMessage( rdkssaStatus_t err )
 {
-    if ( err == rdkssaOK ) return rdkssaOK;
-    char *msg="unknown";
+    const char *msg="unknown";
 
     switch( err ) {
+        case rdkssaOK:
+                msg = "ok"; break;
+        case rdkssaAlreadyMounted:
+                msg = "already mounted"; break;
         case rdkssaGeneralFailure:
                 msg = "general failure"; break;
         case rdkssaBadPointer:
@@ -353,12 +506,32 @@ static rdkssaStatus_t handleError( rdkssaStatus_t err, int doExit )
                 msg = "bad length"; break;
         case rdkssaValidityError:
                 msg = "expired"; break;
+        case rdkssaMissingSource:
+                msg = "missing source"; break;
+        case rdkssaFileError:
+                msg = "file error"; break;
+        case rdkssaMissingAttribute:
+                msg = "missing attribute"; break;
+        case rdkssaProviderNotFound:
+                msg = "provider not found"; break;
+        case rdkssaTimeout:
+                msg = "timeout"; break;
             /* more here */
         case rdkssaNYIError:
                 msg = "NYI"; break;
         default:
                 msg = "UNK"; break;
     }
+    return msg;
+}
+
+/**
+ * handleError      -       Given an error code, print and optionally exit
+ */
+static rdkssaStatus_t handleError( rdkssaStatus_t err, int doExit )
+{
+    if ( RDKSSA_SUCCESS( err ) ) return err;
+    const char *msg = statusMessage( err );
 
     RDKSSA_LOG_ERROR( "%s - error\n", msg);
     fprintf(stderr, "%s - error \n", msg);
@@ -368,27 +541,439 @@ static rdkssaStatus_t handleError( rdkssaStatus_t err, int doExit )
     return err;
 }
 
+/**
+ * cmdResultRelease -       Give back the data of a command result
+ */
+static void cmdResultRelease( cmdResult_t *res )
+{
+    if ( res->data != NULL ) {
+        rdkssaDataBufRelease( res->data );
+        res->data = NULL;
+    }
+}
+
+// a JSON string, escaping what must be
+static void jsonString( FILE *out, const char *str )
+{
+    const unsigned char *p;
+
+    fputc( '"', out );
+    for ( p = (const unsigned char *)str; *p != '\0'; p++ ) {
+        if ( *p == '"' || *p == '\\' ) {
+            fprintf( out, "\\%c", *p );
+        } else if ( *p < 0x20 ) {
+            fprintf( out, "\\u%04x", *p );
+        } else {
+            fputc( *p, out );
+        }
+    }
+    fputc( '"', out );
+}
+
+// standard base64 with padding
+static void base64Write( FILE *out, const uint8_t *data, size_t len )
+{
+    static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char quad[4];
+    uint32_t bits;
+    size_t i;
+
+    for ( i = 0; i < len; i += 3 ) {
+        bits = (uint32_t)data[i] << 16;
+        if ( i+1 < len ) bits |= (uint32_t)data[i+1] << 8;
+        if ( i+2 < len ) bits |= data[i+2];
+        quad[0] = b64[bits >> 18];
+        quad[1] = b64[( bits >> 12 ) & 0x3f];
+        quad[2] = i+1 < len ? b64[( bits >> 6 ) & 0x3f] : '=';
+        quad[3] = i+2 < len ? b64[bits & 0x3f] : '=';
+        fwrite( quad, 1, sizeof( quad ), out );
+    }
+}
+
+/**
+ * writeData        -       What a command returned, as is, on a line of its own (less a string's terminating 0)
+ */
+static void writeData( FILE *out, rdkssaDataBufPtr_t data )
+{
+    size_t len = data->sizeOfData;
+
+    if ( len > 0 && data->dataBuffer[len-1] == '\0' ) {
+        len--;
+    }
+    fwrite( data->dataBuffer, 1, len, out );
+    fputc( '\n', out );
+    fflush( out );
+}
+
+/**
+ * writeRecord      -       The output record for command number n: text, or JSON with --json
+ */
+static void writeRecord( FILE *out, unsigned n, rdkssaStatus_t stat, const cmdResult_t *res )
+{
+    if ( !jsonRecords ) {
+        fprintf( out, "%u %d %s\n", n, stat, statusMessage( stat ) );
+    } else {
+        fprintf( out, "{\"cmd\":%u,\"status\":%d,\"message\":\"%s\",\"provider\":", n, stat, statusMessage( stat ) );
+        jsonString( out, res->provider );
+        fputs( ",\"api\":", out );
+        jsonString( out, res->api );
+        if ( res->data != NULL ) {
+            fputs( ",\"data\":\"", out );
+            base64Write( out, res->data->dataBuffer, res->data->sizeOfData );
+            fputs( "\"}\n", out );
+        } else {
+            fputs( ",\"data\":null}\n", out );
+        }
+    }
+    fflush( out );
+}
+
+/**
+ * hasKeyFromStdin  -       Does the command take its key from stdin (a KEY=STDIN attribute)?
+ */
+static int hasKeyFromStdin( const char *cmdStr )
+{
+    const char *p = cmdStr;
+    const size_t len = strlen( "KEY=STDIN" );
+
+    while ( ( p = strstr( p, "KEY=STDIN" ) ) != NULL ) {
+        if ( p > cmdStr && ( p[-1] == ATTRIB_DELIM || p[-1] == COMMAND_HEAD ) &&
+             ( p[len] == ATTRIB_DELIM || p[len] == COMMAND_TAIL ) ) {
+            return 1;
+        }
+        p += len;
+    }
+    return 0;
+}
+
+/**
+ * processBatch     -       Run one command per line of in, and keep going after errors
+ *
+ * Each line is a command string as it would be given as an argument.  A record for it is
+ * written to out (see writeRecord).  If stdin is not free for a key (the commands come from it, or a daemon has none),
+ * a command can't read its key from stdin.  A line longer than BATCH_LINE_MAX is a syntax error:
+ * daemon clients can't make the reader hold more than that.
+ * Returns rdkssaOK if every command succeeded, else the status of the first that failed
+ */
+static rdkssaStatus_t processBatch( FILE *in, FILE *out, int refuseKeyStdin )
+{
+    rdkssaStatus_t stat, firstErr = rdkssaOK;
+    cmdResult_t res;
+    char line[BATCH_LINE_MAX+3];        /* room for "\r\n" and the terminator */
+    size_t len;
+    unsigned lineNo = 0;
+    int c;
+
+    while ( fgets( line, sizeof( line ), in ) != NULL ) {
+        lineNo++;
+        len = strlen( line );
+        if ( len == sizeof( line ) - 1 && line[len-1] != '\n' ) {
+            /* the buffer filled before the end of the line: drop the rest of it */
+            while ( ( c = getc( in ) ) != EOF && c != '\n' ) {
+            }
+        }
+        while ( len > 0 && ( line[len-1] == '\n' || line[len-1] == '\r' ) ) {
+            line[--len] = '\0';
+        }
+        if ( len == 0 || line[0] == '#' ) {
+            continue;
+        }
+        if ( len > BATCH_LINE_MAX ) {
+            RDKSSA_LOG_ERROR( "line %u: longer than %d characters\n", lineNo, BATCH_LINE_MAX );
+            res.provider[0] = res.api[0] = '\0';
+            res.data = NULL;
+            stat = rdkssaSyntaxError;
+        } else if ( refuseKeyStdin && hasKeyFromStdin( line ) ) {
+            RDKSSA_LOG_ERROR( "line %u: KEY=STDIN can't be used here\n", lineNo );
+            res.provider[0] = res.api[0] = '\0';
+            res.data = NULL;
+            stat = rdkssaSyntaxError;
+        } else {
+            stat = processCmd( line, &res );
+        }
+        handleError( stat, DONT_EXIT );
+        writeRecord( out, lineNo, stat, &res );
+        cmdResultRelease( &res );
+        if ( !RDKSSA_SUCCESS( stat ) && RDKSSA_SUCCESS( firstErr ) ) {
+            firstErr = stat;
+        }
+    }
+    if ( ferror( in ) ) {
+        RDKSSA_LOG_ERROR( "error reading batch after line %u\n", lineNo );
+        if ( RDKSSA_SUCCESS( firstErr ) ) {
+            firstErr = rdkssaFileError;
+        }
+    }
+    return firstErr;
+}
+
+/**
+ * cliBatch         -       ssacli --batch [file]
+ */
+static rdkssaStatus_t cliBatch( const char *fileName )
+{
+    rdkssaStatus_t stat;
+    FILE *in = stdin;
+
+    if ( fileName != NULL && ( in = fopen( fileName, "re" ) ) == NULL ) {
+        RDKSSA_LOG_ERROR( "can't open batch file %s\n", fileName );
+        return handleError( rdkssaFileError, DONT_EXIT );
+    }
+    stat = processBatch( in, stdout, in == stdin );
+    if ( in != stdin ) {
+        fclose( in );
+    }
+    return stat;
+}
+
+/**
+ * daemon mode: the main thread accepts connections and queues them for the workers
+ * a worker takes a connection and runs processBatch on it until the client is done
+ */
+#define DAEMON_QUEUE    (16)
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    pthread_cond_t space;
+    int fd[DAEMON_QUEUE];       /* -1: stop */
+    unsigned head;
+    unsigned count;
+} daemonQueue = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, {0}, 0, 0 };
+
+static void daemonQueuePut( int fd )
+{
+    pthread_mutex_lock( &daemonQueue.lock );
+    while ( daemonQueue.count == DAEMON_QUEUE ) {
+        pthread_cond_wait( &daemonQueue.space, &daemonQueue.lock );
+    }
+    daemonQueue.fd[( daemonQueue.head + daemonQueue.count++ ) % DAEMON_QUEUE] = fd;
+    pthread_cond_signal( &daemonQueue.ready );
+    pthread_mutex_unlock( &daemonQueue.lock );
+}
+
+static int daemonQueueGet( void )
+{
+    int fd;
+
+    pthread_mutex_lock( &daemonQueue.lock );
+    while ( daemonQueue.count == 0 ) {
+        pthread_cond_wait( &daemonQueue.ready, &daemonQueue.lock );
+    }
+    fd = daemonQueue.fd[daemonQueue.head];
+    daemonQueue.head = ( daemonQueue.head + 1 ) % DAEMON_QUEUE;
+    daemonQueue.count--;
+    pthread_cond_signal( &daemonQueue.space );
+    pthread_mutex_unlock( &daemonQueue.lock );
+    return fd;
+}
+
+// only root and the daemon's own user may use it
+static int daemonPeerAllowed( int fd )
+{
+    struct ucred cred;
+    socklen_t len = sizeof( cred );
+
+    if ( getsockopt( fd, SOL_SOCKET, SO_PEERCRED, &cred, &len ) != 0 ) {
+        RDKSSA_LOG_ERROR( "SO_PEERCRED failed (%d)\n", errno );
+        return 0;
+    }
+    if ( cred.uid != 0 && cred.uid != geteuid() ) {
+        RDKSSA_LOG_ERROR( "connection from uid %u refused\n", (unsigned)cred.uid );
+        return 0;
+    }
+    return 1;
+}
+
+// serve one connection, then close it
+static void daemonServe( int fd )
+{
+    struct timeval idle = { SSACLI_DAEMON_IDLE_S, 0 };
+    FILE *in = NULL, *out = NULL;
+    int outFd;
+
+    (void)setsockopt( fd, SOL_SOCKET, SO_RCVTIMEO, &idle, sizeof( idle ) );
+    if ( ( outFd = fcntl( fd, F_DUPFD_CLOEXEC, 0 ) ) < 0 || ( out = fdopen( outFd, "w" ) ) == NULL ||
+         ( in = fdopen( fd, "r" ) ) == NULL ) {
+        RDKSSA_LOG_ERROR( "can't serve connection (%d)\n", errno );
+        if ( out != NULL ) fclose( out ); else if ( outFd >= 0 ) close( outFd );
+        close( fd );
+        return;
+    }
+    (void)processBatch( in, out, 1 );
+    fclose( out );
+    fclose( in );
+}
+
+static void *daemonWorker( void *arg )
+{
+    int fd;
+
+    while ( ( fd = daemonQueueGet() ) >= 0 ) {
+        daemonServe( fd );
+    }
+    return NULL;
+}
+
+/**
+ * daemonListen     -       Listen on a Unix socket at path, replacing a stale socket there; fd or -1
+ *
+ * A socket there is stale only if connecting to it is refused; anything else (another daemon
+ * answering, no permission) keeps this one from starting.
+ */
+static int daemonListen( const char *path )
+{
+    struct sockaddr_un addr;
+    struct stat st;
+    mode_t oldMask;
+    int fd, rc, err;
+
+    memset( &addr, 0, sizeof( addr ) );
+    addr.sun_family = AF_UNIX;
+    if ( strlen( path ) >= sizeof( addr.sun_path ) ) {
+        RDKSSA_LOG_ERROR( "socket path too long: %s\n", path );
+        return -1;
+    }
+    strcpy( addr.sun_path, path );      /* length checked */
+    if ( lstat( path, &st ) == 0 && S_ISSOCK( st.st_mode ) ) {
+        if ( ( fd = socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 ) ) < 0 ) {
+            RDKSSA_LOG_ERROR( "socket failed (%d)\n", errno );
+            return -1;
+        }
+        err = connect( fd, (struct sockaddr *)&addr, sizeof( addr ) ) == 0 ? 0 : errno;
+        close( fd );
+        if ( err == 0 ) {
+            RDKSSA_LOG_ERROR( "another daemon is listening on %s\n", path );
+            return -1;
+        }
+        if ( err != ECONNREFUSED ) {
+            RDKSSA_LOG_ERROR( "can't tell if %s is stale (%d)\n", path, err );
+            return -1;
+        }
+        unlink( path );
+    }
+    if ( ( fd = socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 ) ) < 0 ) {
+        RDKSSA_LOG_ERROR( "socket failed (%d)\n", errno );
+        return -1;
+    }
+    oldMask = umask( 0077 );            /* the socket is created 0600 */
+    rc = bind( fd, (struct sockaddr *)&addr, sizeof( addr ) );
+    umask( oldMask );
+    if ( rc != 0 || listen( fd, SOMAXCONN ) != 0 ) {
+        RDKSSA_LOG_ERROR( "can't listen on %s (%d)\n", path, errno );
+        close( fd );
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * daemonRun        -       Accept connections on listenFd for a pool of workers, until listenFd is shut down
+ */
+static rdkssaStatus_t daemonRun( int listenFd, int workers )
+{
+    pthread_t worker[SSACLI_DAEMON_MAX_WORKERS];
+    int i, started, fd;
+
+    for ( started = 0; started < workers; started++ ) {
+        if ( pthread_create( &worker[started], NULL, daemonWorker, NULL ) != 0 ) {
+            RDKSSA_LOG_ERROR( "can't start worker %d\n", started );
+            break;
+        }
+    }
+    while ( started > 0 ) {
+        fd = accept4( listenFd, NULL, NULL, SOCK_CLOEXEC );
+        if ( fd < 0 ) {
+            if ( errno == EINTR || errno == ECONNABORTED || errno == EMFILE || errno == ENFILE ) {
+                if ( errno == EMFILE || errno == ENFILE ) sleep( 1 );
+                continue;
+            }
+            break;                      /* shut down */
+        }
+        if ( !daemonPeerAllowed( fd ) ) {
+            close( fd );
+            continue;
+        }
+        daemonQueuePut( fd );
+    }
+    for ( i = 0; i < started; i++ ) {
+        daemonQueuePut( -1 );
+    }
+    for ( i = 0; i < started; i++ ) {
+        pthread_join( worker[i], NULL );
+    }
+    return started > 0 ? rdkssaOK : rdkssaGeneralFailure;
+}
+
+/**
+ * cliDaemon        -       ssacli --daemon <socket> [workers]
+ */
+static rdkssaStatus_t cliDaemon( const char *path, const char *workersStr )
+{
+    int workers = SSACLI_DAEMON_WORKERS, listenFd;
+    rdkssaStatus_t stat;
+    char *end;
+
+    if ( workersStr != NULL ) {
+        workers = (int)strtol( workersStr, &end, 10 );
+        if ( *end != '\0' || workers < 1 || workers > SSACLI_DAEMON_MAX_WORKERS ) {
+            RDKSSA_LOG_ERROR( "workers must be 1..%d\n", SSACLI_DAEMON_MAX_WORKERS );
+            return handleError( rdkssaSyntaxError, DONT_EXIT );
+        }
+    }
+    if ( ( listenFd = daemonListen( path ) ) < 0 ) {
+        return handleError( rdkssaFileError, DONT_EXIT );
+    }
+    signal( SIGPIPE, SIG_IGN );         /* a client that goes away must not take the daemon with it */
+    stat = daemonRun( listenFd, workers );
+    close( listenFd );
+    return handleError( stat, DONT_EXIT );
+}
+
 // main operational
 int climain( int argc, char *argv[] )
 {
     RDKSSA_LOG_DEBUG( "climain\n" );
+    // started by rdkssaHelperStart as the helper process worker
+    if ( argc == 2 && strcmp( argv[1], RDKSSA_HELPER_ARG ) == 0 ) {
+        return rdkssaHelperServe( RDKSSA_HELPER_FD );
+    }
+    if ( argc > 1 && strcmp( argv[1], JSON_ARG ) == 0 ) {
+        jsonRecords = 1;
+        argv[1] = argv[0];
+        argc--; argv++;
+    }
     cliCheck( argc, argv );
+    if ( strcmp( argv[1], BATCH_ARG ) == 0 ) {
+        return cliBatch( argc == 3 ? argv[2] : NULL );
+    }
+    if ( strcmp( argv[1], DAEMON_ARG ) == 0 ) {
+        return cliDaemon( argv[2], argc == 4 ? argv[3] : NULL );
+    }
     // for each argument, pass it to parseCmd
     int num;
     rdkssaStatus_t stat = rdkssaOK;
+    cmdResult_t res;
     for ( num=1; num<argc; num++ ) {
-        stat = processCmd( argv[num] );
-        if ( stat != rdkssaOK ) {
+        stat = processCmd( argv[num], &res );
+        if ( jsonRecords ) {
+            writeRecord( stdout, num, stat, &res );
+        } else if ( res.data != NULL ) {
+            writeData( stdout, res.data );
+        }
+        cmdResultRelease( &res );
+        if ( !RDKSSA_SUCCESS( stat ) ) {
             return handleError( stat, DO_EXIT );
             // does not return
         }
     }
-    return stat;
+    return rdkssaOK;    // already mounted is success for the shell too
 }
 
 
 // Put this here to avoid using Unit Test Features in operational code
 #if defined(UNIT_TESTS)
+#include <sys/wait.h>
 #include "unit_tests.h"
 #endif
 
@@ -412,6 +997,16 @@ rdkssaStatus_t rdkssaStorageAccess ( rdkssa_blobptr_t apiBlobPtr, const char * c
 rdkssaStatus_t rdkssaMount ( rdkssa_blobptr_t apiBlobPtr, const char * const apiAttributes[]) {
     return rdkssaOK;
 }
+rdkssaStatus_t rdkssaUnmount ( rdkssa_blobptr_t apiBlobPtr, const char * const apiAttributes[]) {
+    return rdkssaOK;
+}
+// the second volume fails
+rdkssaStatus_t rdkssaMountBatch ( rdkssa_blobptr_t apiBlobPtr, const char * const apiAttributes[]) {
+    rdkssaStatus_t *status = (rdkssaStatus_t *)apiBlobPtr;
+    status[0] = rdkssaAlreadyMounted;
+    status[1] = rdkssaFileError;
+    return rdkssaFileError;
+}
 rdkssaStatus_t rdkssaCACreatePKCS12 ( rdkssa_blobptr_t apiBlobPtr, const char * const apiAttributes[]) {
     return rdkssaOK;
 }
@@ -421,25 +1016,30 @@ rdkssaStatus_t rdkssaCACheckValidity ( rdkssa_blobptr_t apiBlobPtr, const char *
 rdkssaStatus_t rdkssaCAUpdatePKCS12 ( rdkssa_blobptr_t apiBlobPtr, const char * const apiAttributes[]) {
     return rdkssaOK;
 }
+// BASEMACADDRESS, or BIG: more than ssacli asks for at first
 rdkssaStatus_t rdkssaGetIdentityAttribute ( rdkssa_blobptr_t apiBlobPtr, const char * const apiAttributes[]) {
-    apiBlobPtr = calloc( 1, 1 );
+    rdkssaDataBufPtr_t out = apiBlobPtr;
+    size_t len = sizeof( "00:11:22:33:44:55" );
+    if ( strcmp( apiAttributes[0], "BIG" ) == 0 ) len = CLI_DATA_SIZE * 3;
+    else if ( strcmp( apiAttributes[0], "BASEMACADDRESS" ) != 0 ) return rdkssaAttributeNotFound;
+    if ( out->sizeOfData < len ) { out->sizeOfData = len; return rdkssaBadLength; }
+    memset( out->dataBuffer, 'x', len );
+    memcpy( out->dataBuffer, "00:11:22:33:44:55", sizeof( "00:11:22:33:44:55" ) );
+    out->sizeOfData = len;
     return rdkssaOK;
 }
-// ut stub -- copy of real for memory cleanup
-void rdkssaCleanupVector( char ***v ) {
-    if ( *v == NULL ) return; // nothing to do
-    char ***vctr = (char ***)v;
-    int i;
-    for( i=0; i<MAX_SUPPORTED_ATTRIBUTES; i++ ) {
-        if ( (*vctr)[i] !=NULL ) { free( (*vctr)[i] ); (*vctr)[i] = NULL;}
-    }
-    free( *vctr );
-    *vctr = NULL;
-}
 
 
+rdkssaDataBufPtr_t rdkssaDataBufAlloc( size_t sizeOfData ) {
+    rdkssaDataBufPtr_t buf = calloc( 1, sizeof( rdkssaDataBuf_t ) + sizeOfData );
+    if ( buf != NULL ) buf->sizeOfData = sizeOfData;
+    return buf;
+}
+void rdkssaDataBufRelease( rdkssaDataBufPtr_t buf ) { free( buf ); }
 void rdkssa_memwipe( volatile void *mem, size_t sz ) { memset( (void *)mem, 0, sz ); }
 void rdkssa_memfree(void **mem, size_t sz) { if(*mem) { free((void *)*mem); } }
+int rdkssaLogLevel = RDKSSA_LOG_LEVEL_DEFAULT;
+int rdkssaHelperServe( int sock ) { return 0; }
 
 // function unit tests
 void ut_cliCheck( void );
@@ -447,6 +1047,10 @@ void ut_parseProvCmdsCleanup( void );
 void ut_callProvider( void );
 void ut_processCmd( void );
 void ut_handleError( void );
+void ut_processBatch( void );
+void ut_daemon( void );
+void ut_writeRecord( void );
+void ut_benchParse( void );
 void ut_climain( void );
 
 // main Unit Test
@@ -459,6 +1063,10 @@ int utmain_cli( int argc, char *argv[] )
     ut_callProvider( );
     ut_processCmd( );
     ut_handleError( );
+    ut_processBatch( );
+    ut_daemon( );
+    ut_writeRecord( );
+    ut_benchParse( );
 
     RDKSSA_LOG_UT("=== Unit tests CLI SUCCESS ===\n");
     return UT_OK;
@@ -498,27 +1106,164 @@ void ut_parseProvCmdsCleanup( void ) {
     UTST0( cmdvctr1[2] );
     cleanupVector( &cmdvctr1 ); // free memory
     // error cases
-    RDKSSA_LOG_UT("    expect 5 error messages\n");
+    RDKSSA_LOG_UT("    expect 6 error messages\n");
 
     UTST0( parseProvCmds( NULL ) );
     UTST0( parseProvCmds( "error" ) );
     UTST0( parseProvCmds( "{MISSINGEND" ) );
     UTST0( parseProvCmds( "{MISSINGEND1,MISSINGEND2" ) );
     UTST0( parseProvCmds( "{MISSINGVALUE=}" ) );
+    // vector sized from the input: the attribute limit still applies
+    char many[MAX_SUPPORTED_ATTRIBUTES*4];
+    size_t len = 0;
+    int i;
+    for ( i = 0; i < MAX_SUPPORTED_ATTRIBUTES-1; i++ ) {
+        len += snprintf( many+len, sizeof( many )-len, "%sA%d", i ? "," : "{", i );
+    }
+    snprintf( many+len, sizeof( many )-len, "}" );
+    UTST( cmdvctr1 = parseProvCmds( many ) );
+    UTST0( strcmp( cmdvctr1[MAX_SUPPORTED_ATTRIBUTES-2], "A30" ) );
+    UTST0( cmdvctr1[MAX_SUPPORTED_ATTRIBUTES-1] );
+    cleanupVector( &cmdvctr1 );
+    snprintf( many+len, sizeof( many )-len, ",A31}" );
+    UTST0( parseProvCmds( many ) );
+    cmdvctr1 = parseProvCmds( "{A},B}" ); // ',' past the tail still splits, as it always has
+    UTST( cmdvctr1 );
+    UTST0( strcmp( cmdvctr1[0], "{A}" ) );
+    UTST0( strcmp( cmdvctr1[1], "B" ) );
+    UTST0( cmdvctr1[2] );
+    cleanupVector( &cmdvctr1 );
     RDKSSA_LOG_UT("parseProvCmds/cleanup SUCCESS\n");
 }
 
+// the record of a command as text and as JSON, data in base64
+static char *utRecord( unsigned n, rdkssaStatus_t stat, const cmdResult_t *res ) {
+    char *record;
+    size_t len;
+    FILE *out;
+    UTST( ( out = open_memstream( &record, &len ) ) != NULL );
+    writeRecord( out, n, stat, res );
+    fclose( out );
+    return record;
+}
+
+void ut_writeRecord( void ) {
+    RDKSSA_LOG_UT("writeRecord\n");
+    static const struct { const char *in, *b64; } rfc4648[] = {
+        { "", "" }, { "f", "Zg==" }, { "fo", "Zm8=" }, { "foo", "Zm9v" },
+        { "foob", "Zm9vYg==" }, { "fooba", "Zm9vYmE=" }, { "foobar", "Zm9vYmFy" } };
+    static char batch[] = "{MOUNT=UNMOUNT,MOUNTPOINT=/tmp/utmnt}\n{NO\"PROV}\n";
+    cmdResult_t res = { "IDENT", "BASEMACADDRESS", NULL };
+    char *record;
+    size_t len;
+    FILE *in, *out;
+    int i;
+
+    for ( i = 0; i < sizeof( rfc4648 ) / sizeof( rfc4648[0] ); i++ ) {
+        UTST( ( out = open_memstream( &record, &len ) ) != NULL );
+        base64Write( out, (const uint8_t *)rfc4648[i].in, strlen( rfc4648[i].in ) );
+        fclose( out );
+        UTST0( strcmp( record, rfc4648[i].b64 ) );
+        free( record );
+    }
+
+    UTST( ( res.data = rdkssaDataBufAlloc( sizeof( "00:11:22:33:44:55" ) ) ) != NULL );
+    memcpy( res.data->dataBuffer, "00:11:22:33:44:55", sizeof( "00:11:22:33:44:55" ) );
+    record = utRecord( 3, rdkssaOK, &res );
+    UTST0( strcmp( record, "3 0 ok\n" ) );
+    free( record );
+    jsonRecords = 1;
+    record = utRecord( 3, rdkssaOK, &res );
+    UTST0( strcmp( record, "{\"cmd\":3,\"status\":0,\"message\":\"ok\",\"provider\":\"IDENT\","
+                           "\"api\":\"BASEMACADDRESS\",\"data\":\"MDA6MTE6MjI6MzM6NDQ6NTUA\"}\n" ) );
+    free( record );
+    cmdResultRelease( &res );
+    UTST0( res.data );
+    strcpy( res.api, "A\"B\\C\tD" );
+    record = utRecord( 4, rdkssaNYIError, &res );
+    UTST0( strcmp( record, "{\"cmd\":4,\"status\":-100,\"message\":\"NYI\",\"provider\":\"IDENT\","
+                           "\"api\":\"A\\\"B\\\\C\\u0009D\",\"data\":null}\n" ) );
+    free( record );
+
+    // batch records in JSON
+    RDKSSA_LOG_UT("    expect 1 error message\n");
+    UTST( ( in = fmemopen( batch, strlen( batch ), "r" ) ) != NULL );
+    UTST( ( out = open_memstream( &record, &len ) ) != NULL );
+    UTST( processBatch( in, out, 1 ) == rdkssaProviderNotFound );
+    fclose( in );
+    fclose( out );
+    UTST0( strcmp( record,
+        "{\"cmd\":1,\"status\":0,\"message\":\"ok\",\"provider\":\"MOUNT\",\"api\":\"UNMOUNT\",\"data\":null}\n"
+        "{\"cmd\":2,\"status\":-12,\"message\":\"provider not found\",\"provider\":\"NO\\\"PROV}\",\"api\":\"\",\"data\":null}\n" ) );
+    free( record );
+    jsonRecords = 0;
+    RDKSSA_LOG_UT("writeRecord SUCCESS\n");
+}
+
+// parse throughput for commands of 1, 10 and the maximum number of attributes
+void ut_benchParse( void ) {
+    RDKSSA_LOG_UT("bench parseProvCmds\n");
+    static const int count[] = { 1, 10, MAX_SUPPORTED_ATTRIBUTES-1 };
+    const int iter = 100000;
+    char cmd[MAX_SUPPORTED_ATTRIBUTES*32];
+    const char **v;
+    uint64_t t0, t;
+    size_t c, len;
+    int i, a;
+
+    for ( c = 0; c < sizeof( count ) / sizeof( count[0] ); c++ ) {
+        len = snprintf( cmd, sizeof( cmd ), "{MOUNT=BATCH" );
+        for ( a = 1; a < count[c]; a++ ) {
+            len += snprintf( cmd+len, sizeof( cmd )-len, ",MOUNTPOINT=/tmp/vol%02d", a );
+        }
+        snprintf( cmd+len, sizeof( cmd )-len, "}" );
+        t0 = utNowNs();
+        for ( i = 0; i < iter; i++ ) {
+            UTST( v = parseProvCmds( cmd ) );
+            cleanupVector( &v );
+        }
+        t = utNowNs() - t0;
+        RDKSSA_LOG_UT("    %2d attributes: %llu ns/parse, %llu parses/s\n", count[c],
+                      (unsigned long long)( t / iter ), (unsigned long long)( iter * 1000000000ull / t ) );
+    }
+    RDKSSA_LOG_UT("bench parseProvCmds SUCCESS\n");
+}
+
 void ut_callProvider( void ) {
     RDKSSA_LOG_UT("callStorProvider,callCAProvider,callIdenProvider\n");
+    rdkssaDataBufPtr_t out = NULL;
+    const char *mountVector[] = { "MOUNTPOINT=/tmp/utmnt", NULL };
+    UTST( callMountProvider( "UNMOUNT", mountVector, &out ) == rdkssaOK );
+    UTST( callMountProvider( "REMOUNT", mountVector, &out ) == rdkssaNYIError );
+    const char *batchVector[] = { "WORKERS=2", "MOUNTPOINT=/tmp/utmnt1", "PATH=/tmp/utp1", "MOUNTPOINT=/tmp/utmnt2",
+                                  "PATH=/tmp/utp2", NULL };
+    RDKSSA_LOG_UT("    expect 1 error message\n");
+    UTST( callMountProvider( "BATCH", batchVector, &out ) == rdkssaFileError );
+    UTST0( out );
+    const char *noVector[] = { NULL };
+    UTST( callIdentProvider( "BASEMACADDRESS", noVector, &out ) == rdkssaOK );
+    UTST( out != NULL && out->sizeOfData == 18 && strcmp( (char *)out->dataBuffer, "00:11:22:33:44:55" ) == 0 );
+    rdkssaDataBufRelease( out );
+    UTST( callIdentProvider( "BIG", noVector, &out ) == rdkssaOK );
+    UTST( out != NULL && out->sizeOfData == CLI_DATA_SIZE * 3 );
+    rdkssaDataBufRelease( out );
+    RDKSSA_LOG_UT("    expect 1 error message\n");
+    UTST( callIdentProvider( "BASEMACADDRESS", mountVector, &out ) == rdkssaSyntaxError );
+    UTST( callIdentProvider( "MODELNAME", noVector, &out ) == rdkssaAttributeNotFound );
+    UTST0( out );
     RDKSSA_LOG_UT("callStorProvider,callCAProvider,callIdenProvider SUCCESS\n");
 }
 
 void ut_processCmd( void ) {
 
     RDKSSA_LOG_UT("processCmd\n");
+    cmdResult_t res;
     RDKSSA_LOG_UT("    expect 2 error messages\n");
-    UTST( processCmd( NULL ) == rdkssaBadPointer );
-    UTST( processCmd( "error" ) == rdkssaSyntaxError );
+    UTST( processCmd( NULL, &res ) == rdkssaBadPointer );
+    UTST( processCmd( "error", &res ) == rdkssaSyntaxError );
+    UTST( processCmd( "{MOUNT=UNMOUNT,MOUNTPOINT=/tmp/utmnt}", &res ) == rdkssaOK );
+    UTST0( strcmp( res.provider, "MOUNT" ) || strcmp( res.api, "UNMOUNT" ) );
+    UTST0( res.data );
     RDKSSA_LOG_UT("processCmd SUCCESS\n");
 
 }
@@ -527,6 +1272,7 @@ void ut_handleError( void ) {
     RDKSSA_LOG_UT("handleError\n");
     //UTST( handleError( rdkssaGeneralFailure, DO_EXIT ) != 0 ); // uncomment to test exit case
     UTST( handleError( rdkssaOK, DO_EXIT ) == rdkssaOK );
+    UTST( handleError( rdkssaAlreadyMounted, DO_EXIT ) == rdkssaAlreadyMounted );
     RDKSSA_LOG_UT("    expect 2 error messages\n");
     UTST( handleError( rdkssaGeneralFailure, DONT_EXIT ) == rdkssaGeneralFailure );
     UTST( handleError( rdkssaNYIError, DONT_EXIT ) == rdkssaNYIError );
@@ -534,4 +1280,154 @@ void ut_handleError( void ) {
 
 }
 
+void ut_processBatch( void ) {
+    RDKSSA_LOG_UT("processBatch\n");
+    static char batch[] =
+        "{MOUNT=UNMOUNT,MOUNTPOINT=/tmp/utmnt}\n"
+        "\n"
+        "# comment\n"
+        "error\n"
+        "{NOPROV=X}\n"
+        "{MOUNT=MOUNT,MOUNTPOINT=/tmp/utmnt,KEY=STDIN}\r\n"
+        "{MOUNT=MOUNT,MOUNTPOINT=/tmp/utmnt}";
+    char *records, *overlong;
+    size_t recordsLen, len;
+    FILE *in, *out;
+
+    UTST( hasKeyFromStdin( "{MOUNT=MOUNT,KEY=STDIN}" ) && hasKeyFromStdin( "{MOUNT=MOUNT,KEY=STDIN,PATH=/p}" ) );
+    UTST0( hasKeyFromStdin( "{MOUNT=MOUNT,KEY=STDINX}" ) || hasKeyFromStdin( "{MOUNT=MOUNT,MYKEY=STDIN}" ) );
+
+    // read from stdin: the KEY=STDIN command is refused, the others run
+    RDKSSA_LOG_UT("    expect 5 error messages\n");
+    UTST( ( in = fmemopen( batch, strlen( batch ), "r" ) ) != NULL );
+    UTST( ( out = open_memstream( &records, &recordsLen ) ) != NULL );
+    UTST( processBatch( in, out, 1 ) == rdkssaSyntaxError );
+    fclose( in );
+    fclose( out );
+    UTST0( strcmp( records, "1 0 ok\n4 -4 syntax error\n5 -12 provider not found\n6 -4 syntax error\n7 0 ok\n" ) );
+    free( records );
+
+    // read from a file: stdin is free for the key
+    RDKSSA_LOG_UT("    expect 3 error messages\n");
+    UTST( ( in = fmemopen( batch, strlen( batch ), "r" ) ) != NULL );
+    UTST( ( out = open_memstream( &records, &recordsLen ) ) != NULL );
+    UTST( processBatch( in, out, 0 ) == rdkssaSyntaxError );
+    fclose( in );
+    fclose( out );
+    UTST0( strcmp( records, "1 0 ok\n4 -4 syntax error\n5 -12 provider not found\n6 0 ok\n7 0 ok\n" ) );
+    free( records );
+
+    // a line longer than any command is refused and skipped whole; the longest is still read
+    RDKSSA_LOG_UT("    expect 2 error messages\n");
+    UTST( ( in = open_memstream( &records, &recordsLen ) ) != NULL );
+    fprintf( in, "{MOUNT=UNMOUNT,MOUNTPOINT=/tmp/utmnt}\n{MOUNT=UNMOUNT,MOUNTPOINT=/%0*d}\n", BATCH_LINE_MAX, 0 );
+    fprintf( in, "{MOUNT=UNMOUNT,MOUNTPOINT=/tmp/utmnt}\n{MOUNT=UNMOUNT,MOUNTPOINT=/%0*d}\r\n",
+             BATCH_LINE_MAX - (int)strlen( "{MOUNT=UNMOUNT,MOUNTPOINT=/}" ), 0 );
+    fclose( in );
+    UTST( strlen( strrchr( records, '{' ) ) == BATCH_LINE_MAX + 2 );
+    UTST( ( in = fmemopen( records, recordsLen, "r" ) ) != NULL );
+    UTST( ( out = open_memstream( &overlong, &len ) ) != NULL );
+    UTST( processBatch( in, out, 1 ) == rdkssaSyntaxError );
+    fclose( in );
+    fclose( out );
+    UTST0( strcmp( overlong, "1 0 ok\n2 -4 syntax error\n3 0 ok\n4 0 ok\n" ) );
+    free( overlong );
+    free( records );
+
+    RDKSSA_LOG_UT("    expect 2 error messages\n");
+    UTST( cliBatch( "/tmp/ut_ssacli_no_such_batch" ) == rdkssaFileError );
+    RDKSSA_LOG_UT("processBatch SUCCESS\n");
+}
+
+#define UT_SOCKET   "/tmp/ut_ssacli.sock"
+
+static int utConnect( void ) {
+    struct sockaddr_un addr = { AF_UNIX, UT_SOCKET };
+    int fd = socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+    UTST( fd >= 0 && connect( fd, (struct sockaddr *)&addr, sizeof( addr ) ) == 0 );
+    return fd;
+}
+
+// everything the daemon answers until it closes the connection or n bytes came
+static char *utReadReply( int fd, char *buf, size_t size, size_t n ) {
+    size_t len = 0;
+    ssize_t r;
+    while ( len < n && len < size - 1 && ( r = read( fd, buf + len, size - 1 - len ) ) > 0 ) {
+        len += (size_t)r;
+    }
+    buf[len] = '\0';
+    return buf;
+}
+
+static int utListenFd;
+static rdkssaStatus_t utDaemonStatus;
+static void *utDaemonThread( void *arg ) {
+    utDaemonStatus = daemonRun( utListenFd, 2 );
+    return NULL;
+}
+
+void ut_daemon( void ) {
+    RDKSSA_LOG_UT("daemon\n");
+    static const char cmds[] = "{MOUNT=UNMOUNT,MOUNTPOINT=/tmp/a}\n{BAD}\n{MOUNT=MOUNT,KEY=STDIN,MOUNTPOINT=/x}\n";
+    static const char one[] = "{MOUNT=UNMOUNT,MOUNTPOINT=/tmp/b}\n";
+    char reply[256];
+    struct stat st;
+    pthread_t t;
+    pid_t pid;
+    int a, b, status;
+
+    UTST( ( utListenFd = daemonListen( UT_SOCKET ) ) >= 0 );
+    UTST( stat( UT_SOCKET, &st ) == 0 && S_ISSOCK( st.st_mode ) && ( st.st_mode & 0077 ) == 0 );
+    UTST( pthread_create( &t, NULL, utDaemonThread, NULL ) == 0 );
+
+    // a second daemon must not take the socket of one that answers
+    RDKSSA_LOG_UT("    expect 1 error message\n");
+    UTST( daemonListen( UT_SOCKET ) < 0 );
+
+    // pipelined: all commands written before any answer is read, answered in order
+    RDKSSA_LOG_UT("    expect 3 error messages\n");
+    a = utConnect( );
+    UTST( write( a, cmds, strlen( cmds ) ) == (ssize_t)strlen( cmds ) );
+    UTST( shutdown( a, SHUT_WR ) == 0 );
+    UTST0( strcmp( utReadReply( a, reply, sizeof( reply ), sizeof( reply ) ),
+                   "1 0 ok\n2 -12 provider not found\n3 -4 syntax error\n" ) );
+    close( a );
+
+    // two connections at once, each on its own worker: b is answered while a is still open
+    a = utConnect( );
+    b = utConnect( );
+    UTST( write( b, one, strlen( one ) ) == (ssize_t)strlen( one ) );
+    UTST0( strcmp( utReadReply( b, reply, sizeof( reply ), strlen( "1 0 ok\n" ) ), "1 0 ok\n" ) );
+    UTST( write( a, one, strlen( one ) ) == (ssize_t)strlen( one ) );
+    UTST0( strcmp( utReadReply( a, reply, sizeof( reply ), strlen( "1 0 ok\n" ) ), "1 0 ok\n" ) );
+    // and the connection stays open for more
+    UTST( write( b, one, strlen( one ) ) == (ssize_t)strlen( one ) );
+    UTST0( strcmp( utReadReply( b, reply, sizeof( reply ), strlen( "2 0 ok\n" ) ), "2 0 ok\n" ) );
+    close( a );
+    close( b );
+
+    // another user is turned away without an answer
+    if ( geteuid() == 0 ) {
+        RDKSSA_LOG_UT("    expect 1 error message\n");
+        UTST( chmod( UT_SOCKET, 0666 ) == 0 );
+        UTST( ( pid = fork() ) >= 0 );
+        if ( pid == 0 ) {
+            if ( setuid( 65534 ) != 0 ) _exit( 2 );
+            a = utConnect( );
+            _exit( read( a, reply, sizeof( reply ) ) > 0 ? 1 : 0 );
+        }
+        UTST( waitpid( pid, &status, 0 ) == pid && WIFEXITED( status ) && WEXITSTATUS( status ) == 0 );
+    }
+
+    UTST( shutdown( utListenFd, SHUT_RDWR ) == 0 );
+    UTST( pthread_join( t, NULL ) == 0 && utDaemonStatus == rdkssaOK );
+    close( utListenFd );
+    // nobody answers on the socket left behind: it is stale and replaced
+    UTST( lstat( UT_SOCKET, &st ) == 0 && S_ISSOCK( st.st_mode ) );
+    UTST( ( utListenFd = daemonListen( UT_SOCKET ) ) >= 0 );
+    close( utListenFd );
+    unlink( UT_SOCKET );
+    RDKSSA_LOG_UT("daemon SUCCESS\n");
+}
+
 #endif // unit tests
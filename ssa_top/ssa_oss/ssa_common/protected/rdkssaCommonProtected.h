@@ -21,25 +21,94 @@
 #ifndef __rdkssa_common_protected_inc__
 #define __rdkssa_common_protected_inc__
 
+#include <string.h>
 #include "rdkssa.h"
 
 
 /*Function pointer the attribute functions*/
 typedef rdkssaStatus_t (*AttributeHandlerFuncPtr)(rdkssa_blobptr_t ,const char *);
 
+/**
+ * View of one "NAME=value" attribute, pointing into the caller's attribute string; nothing is copied.
+ * name is NOT 0-terminated (use nameLen).  value is the tail of the caller's string, so it is 0-terminated.
+ * For an attribute without "=", value is NULL and valueLen is 0.
+ */
+typedef struct rdkssaAttrView_s
+{
+    const char *name;
+    size_t      nameLen;
+    const char *value;
+    size_t      valueLen;
+    unsigned    flags;
+} rdkssaAttrView_t;
+
+#define RDKSSA_ATTRVIEW_CHECKED                    (0x1)   /* value already passed rdkssaAttrViewCheck */
+
+/*Function pointer for attribute functions taking the parsed view*/
+typedef rdkssaStatus_t (*AttributeViewHandlerFuncPtr)(rdkssa_blobptr_t ,const rdkssaAttrView_t *);
+
 //structure of fuction pointer
+//set attributeOperation or attributeViewOperation; if both are set the view handler is called
 typedef struct AttributeHandlerStruct 
 {
     const char *attributeNameStr;
     AttributeHandlerFuncPtr attributeOperation; 
+    AttributeViewHandlerFuncPtr attributeViewOperation;
 } AttributeHandlerStruct, *AttributeHandlerStructPtr;
 
+/**
+ * split an attribute into a view, and check a view's value (same rules as rdkssaAttrCheck)
+ */
+rdkssaStatus_t rdkssaAttrViewParse( const char *attributeName, rdkssaAttrView_t *view );
+const char *rdkssaAttrViewCheck( const rdkssaAttrView_t *view );
+// rdkssaAttrCheck without the single pass scanner, reference for testing
+const char *rdkssaAttrCheckScalar( const char *valueStr );
+
 /**
  * helper function to look up an attribute name and call the matching function
  */
 rdkssaStatus_t attributeHandlerHelper(rdkssa_blobptr_t apiBlobPtr, const char *attributeName, const AttributeHandlerStruct attributeTable[]);
 rdkssaStatus_t rdkssaHandleAPIHelper(rdkssa_blobptr_t  apiBlobPtr, const char * const attributes[], const AttributeHandlerStruct attributeTable[]);
 
+/**
+ * Hashed dispatch for a handler table
+ *
+ * An AttributeHandlerIndex wraps an unmodified AttributeHandlerStruct table. On first use a
+ * collision-free (perfect) hash of the table's attribute names is built, so looking up an
+ * attribute costs one pass over its name, one slot probe and one compare, instead of a
+ * strncmp against every table entry.  If no perfect hash is found the linear scan is used.
+ *
+ * Declare one index per table, next to the table:
+ *     static const AttributeHandlerStruct myHandlers[] = { ... };
+ *     static AttributeHandlerIndex myHandlerIndex = RDKSSA_HANDLER_INDEX( myHandlers );
+ */
+#define RDKSSA_HANDLER_INDEX_SLOTS                 (4*MAX_SUPPORTED_ATTRIBUTES)
+
+typedef struct AttributeHandlerIndex
+{
+    const AttributeHandlerStruct *attributeTable;
+    int      state;         /* 0 not built, 1 hashed, -1 linear fallback (set once, under lock) */
+    uint32_t seed;
+    uint32_t mask;
+    uint8_t  slot[RDKSSA_HANDLER_INDEX_SLOTS];  /* table index + 1, 0 when empty */
+} AttributeHandlerIndex;
+
+#define RDKSSA_HANDLER_INDEX( table )              { (table), 0, 0, 0, {0} }
+
+rdkssaStatus_t attributeIndexedHandlerHelper(rdkssa_blobptr_t apiBlobPtr, const char *attributeName, AttributeHandlerIndex *attributeIndex);
+rdkssaStatus_t rdkssaHandleAPIIndexedHelper(rdkssa_blobptr_t apiBlobPtr, const char * const attributes[], AttributeHandlerIndex *attributeIndex);
+
+/**
+ * Prepared calls (see RDKSSA_PREPARE_API in rdkssa.h)
+ *
+ * rdkssaPrepareAPIHelper copies the attribute vector into a single allocation, parses and looks up every
+ * attribute, and checks the values of view-handled attributes once.  The handle it returns is bound to the
+ * handler table.  rdkssaExecutePreparedHelper only calls the handlers, in vector order, with the new blob.
+ * Free the handle with rdkssaReleasePrepared.
+ */
+rdkssaStatus_t rdkssaPrepareAPIHelper(const char * const attributes[], AttributeHandlerIndex *attributeIndex, rdkssa_handle_t *preparedCall);
+rdkssaStatus_t rdkssaExecutePreparedHelper(rdkssa_blobptr_t apiBlobPtr, rdkssa_handle_t preparedCall, AttributeHandlerIndex *attributeIndex);
+
 /**
  * Safe exec, instead of system()
  */
@@ -55,9 +124,146 @@ int rdkssaExecv( char *exargv[] );
  *
  */
 typedef rdkssaStatus_t (*rdkssaIOCallback)(int fd, rdkssa_blobptr_t callerBlob );
-// safe exec with IO redirection (this may need synchronization!)
+// safe exec with IO redirection, waits up to RDKSSA_EXEC_TIMEOUT_MS
 rdkssaStatus_t rdkssaExecvPipeOutput( const char *exargv[], rdkssa_blobptr_t callerBlob, rdkssaIOCallback callback );
 
+/**
+ * bounded and non-blocking helper completion
+ *
+ * the result of a helper run is its exit status (>= 0), or a negative rdkssaStatus_t:
+ * rdkssaTimeout if it was killed because it did not finish in time.
+ *
+ * rdkssaExecvPipeOutputAsync starts the helper and runs the callback, but does not wait: *exec is a
+ * completion handle whose rdkssaExecFd becomes readable (poll/epoll POLLIN) when the helper exits.
+ * Without a handle the return value is the result the synchronous call would have given.
+ * rdkssaExecWait waits up to timeoutMs (< 0: forever, 0: just check), kills the helper if it is not done,
+ * and releases the handle; call it exactly once per handle.  Async helpers never go to the helper process.
+ */
+#ifndef RDKSSA_EXEC_TIMEOUT_MS
+#define RDKSSA_EXEC_TIMEOUT_MS  (120000)
+#endif
+typedef struct rdkssaExec rdkssaExec_t;
+rdkssaStatus_t rdkssaExecvPipeOutputAsync( const char *exargv[], rdkssa_blobptr_t callerBlob, rdkssaIOCallback callback, rdkssaExec_t **exec );
+int rdkssaExecvPipeOutputTimeout( const char *exargv[], rdkssa_blobptr_t callerBlob, rdkssaIOCallback callback, int timeoutMs );
+int rdkssaExecFd( const rdkssaExec_t *exec );
+int rdkssaExecWait( rdkssaExec_t *exec, int timeoutMs );
+
+// write all of buf (EINTR and short writes retried, EPIPE instead of SIGPIPE), 0 or -1 with errno
+int rdkssaWriteAll( int fd, const void *buf, size_t len );
+
+/**
+ * copy inFd to outFd until EOF as rdkssaWriteAll would write it, with splice() (no copy in this process) if
+ * one of them is a pipe and the other can be spliced, else through a RDKSSA_COPY_CHUNK buffer that is wiped.
+ * A regular file is copied up to its length from fstat, with no read for EOF after it (nothing is copied if
+ * it is over the limit); a reader that closes the pipe once the source is at EOF is not an error.
+ * 0 or -1 with errno, EFBIG if inFd has more than limit bytes; *copied (may be NULL): bytes written
+ */
+#define RDKSSA_COPY_CHUNK       (512)
+int rdkssaCopyFd( int outFd, int inFd, size_t limit, size_t *copied );
+
+/**
+ * locked memory for key material (ssaSecMem.c)
+ *
+ * rdkssaSecAlloc hands out a zeroed RDKSSA_SECMEM_SLOT_SIZE slot of one region that is mlock'd (not swapped)
+ * and left out of core dumps; a larger size, or one asked for while every slot is in use, gets zeroed
+ * malloc'd memory instead.  NULL if there is no memory.  rdkssaSecFree wipes the memory and returns it;
+ * NULL is ignored, and a slot that is not in use (freed twice) is logged and left alone.  rdkssaSecDataBuf
+ * allocates a rdkssaDataBuf_t with sizeOfData set, freed by rdkssaSecFree.
+ * RDKSSA_WIPE is a wipe the compiler cannot drop because the memory is not read again.
+ */
+#ifndef RDKSSA_SECMEM_SLOT_SIZE
+#define RDKSSA_SECMEM_SLOT_SIZE (512)
+#endif
+#ifndef RDKSSA_SECMEM_SLOTS
+#define RDKSSA_SECMEM_SLOTS     (64)
+#endif
+#if defined(__GLIBC__) && ( __GLIBC__ > 2 || ( __GLIBC__ == 2 && __GLIBC_MINOR__ >= 25 ) )
+#define RDKSSA_WIPE( mem, sz )  explicit_bzero( (void *)(mem), (sz) )
+#else
+#define RDKSSA_WIPE( mem, sz )  do { memset( (void *)(mem), 0, (sz) ); __asm__ __volatile__( "" : : "r"(mem) : "memory" ); } while ( 0 )
+#endif
+void *rdkssaSecAlloc( size_t size );
+void rdkssaSecFree( void *mem );
+rdkssaDataBufPtr_t rdkssaSecDataBuf( size_t sizeOfData );
+
+/**
+ * pending results (ssaDataBuf.c), for an API that answers a too small buffer with rdkssaBadLength and the size
+ * it needs, so the caller's retry does not compute the result again
+ *
+ * rdkssaPendingOffer gives out a result the provider computed: copied if it fits, else kept in this thread's
+ * pending slot (out->sizeOfData set to its length, rdkssaBadLength returned).  The slot is keyed by api, the
+ * attribute vector and version: anything else the result depends on, e.g. a counter of changes to the data it
+ * comes from, or 0.  rdkssaPendingTake at the start of the call returns 1 if the kept result answers it:
+ * *status is rdkssaOK and the result is in out, or rdkssaBadLength if out is still too small.  It returns 0
+ * if the provider has to do the work.  A result is taken once, kept RDKSSA_PENDING_TTL_MS at most, in memory
+ * from rdkssaSecDataBuf, and wiped.  Calls whose api and attributes take more than RDKSSA_PENDING_KEY_MAX bytes
+ * are not kept.  It is for results that cost something to make (derived or unwrapped keys); a provider that
+ * answers from its own cache, as Identity does, just answers the retry again.
+ */
+#ifndef RDKSSA_PENDING_TTL_MS
+#define RDKSSA_PENDING_TTL_MS   (1000)
+#endif
+#ifndef RDKSSA_PENDING_KEY_MAX
+#define RDKSSA_PENDING_KEY_MAX  (1024)
+#endif
+rdkssaStatus_t rdkssaPendingOffer( const char *api, const char * const attributes[], uint64_t version,
+                                   const void *result, size_t len, rdkssaDataBufPtr_t out );
+int rdkssaPendingTake( const char *api, const char * const attributes[], uint64_t version,
+                       rdkssaDataBufPtr_t out, rdkssaStatus_t *status );
+
+// environment for helpers, taken when the library was loaded
+char * const *rdkssaHelperEnv( void );
+
+// run a helper in this process and wait for it up to timeoutMs, result as above (ssaCommon.c)
+int rdkssaExecvLocal( const char * const exargv[], int stdinFd, int timeoutMs );
+
+/**
+ * helper process client (ssaHelper.c)
+ * rdkssaHelperExec and rdkssaHelperUmount return 0 if the worker handled the request, -1 if it was not
+ * taken (no worker, it could not be restarted, or it hung) and the caller should do the work itself.
+ * Calls don't wait for each other; a worker that took a request but hasn't answered by the timeout (plus
+ * a grace period) is stopped and the helper reported as timed out.
+ */
+int rdkssaHelperActive( void );
+int rdkssaHelperExec( const char * const exargv[], int stdinFd, int timeoutMs, int *status );
+int rdkssaHelperUmount( const char *target, int flags, int *err );
+unsigned rdkssaHelperRestarts( void );
+
+
+/**
+ * /proc/self/mountinfo snapshot (ssaMountInfo.c)
+ *
+ * rdkssaMountInfoLoad reads the current mount table; entries are in mount order and their strings point
+ * into the snapshot, valid until rdkssaMountInfoRelease.  rdkssaMountInfoParse parses text the caller
+ * allocated with malloc, and takes it over.
+ * rdkssaMountInfoFind/FindSource return the topmost mount on / of the path, or NULL if it is not mounted.
+ * rdkssaMountInfoIsMounted answers from a process-wide cache that is parsed again only after the mount
+ * table changed; *mounted is set if the topmost mount on mountPoint is of source (any source if NULL).
+ */
+#ifndef RDKSSA_MOUNTINFO_FILE
+#define RDKSSA_MOUNTINFO_FILE   "/proc/self/mountinfo"
+#endif
+typedef struct {
+    int id;
+    int parentId;
+    const char *mountPoint;
+    const char *fsType;
+    const char *source;
+} rdkssaMountEntry_t;
+
+typedef struct {
+    int count;
+    rdkssaMountEntry_t *entry;
+    char *text;
+} rdkssaMountInfo_t;
+
+rdkssaStatus_t rdkssaMountInfoLoad( rdkssaMountInfo_t *info );
+rdkssaStatus_t rdkssaMountInfoLoadFile( rdkssaMountInfo_t *info, const char *path );
+rdkssaStatus_t rdkssaMountInfoParse( rdkssaMountInfo_t *info, char *text );
+void rdkssaMountInfoRelease( rdkssaMountInfo_t *info );
+const rdkssaMountEntry_t *rdkssaMountInfoFind( const rdkssaMountInfo_t *info, const char *mountPoint );
+const rdkssaMountEntry_t *rdkssaMountInfoFindSource( const rdkssaMountInfo_t *info, const char *source );
+rdkssaStatus_t rdkssaMountInfoIsMounted( const char *mountPoint, const char *source, int *mounted );
 
  
 #endif //__rdkssa_common_protected_inc__
@@ -0,0 +1,637 @@
+/*
+ * Copyright 2020 Comcast Cable Communications Management, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+*/
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "rdkssa.h"
+#include "rdkssaCommonProtected.h"
+#include "rdkssaProviderProtected.h"
+#include "rdkssaIdentityProvider.h"
+
+/**
+ * Identity attributes, read from the platform once per boot
+ *
+ * The first lookup after boot reads every attribute from its platform sources and, once all of them are
+ * found, saves them in RDKSSA_IDENTITY_CACHE: a read-only file on a tmpfs, tagged with the kernel's boot
+ * id.  Processes that come later map that file on their first lookup, and from then on a lookup is a
+ * memory read.  The cache directory is locked while the file is built, so concurrent first lookups read
+ * the platform once.  An attribute that isn't there yet (e.g. its driver isn't loaded) is not saved as
+ * missing: the process keeps its own copy and asks the platform again on each lookup of it, until it is
+ * found.  A cache file that isn't trusted (not owned by root or us, or writable by others), has another
+ * layout, is incomplete or is from another boot is ignored and replaced.  If it can't be saved (e.g. no
+ * permission), or there is no boot id to tag it with, the process keeps its own copy.
+ */
+#define IDENTITY_CACHE_MAGIC		(0x44495352)	/* "RSID" */
+#define IDENTITY_BOOT_ID_LEN		(36)
+
+typedef enum { identityMac, identitySerial, identityAttrs } identity_attr_t;
+
+typedef struct {
+	int32_t status;							/* rdkssaOK, or why the platform had no value; rdkssaOK is final */
+	uint32_t len;							/* of value, with its terminating 0 */
+	char value[RDKSSA_IDENTITY_VALUE_MAX];
+} identity_value_t;
+
+typedef struct {
+	uint32_t magic;
+	uint32_t size;							/* sizeof( identity_cache_t ): another layout is not used */
+	char bootId[IDENTITY_BOOT_ID_LEN + 1];
+	identity_value_t value[identityAttrs];
+} identity_cache_t;
+
+static int identityMacValid( const char *value );
+static int identitySerialValid( const char *value );
+
+static const char *macSources[] = { RDKSSA_IDENTITY_MAC_SOURCES, NULL };
+static const char *serialSources[] = { RDKSSA_IDENTITY_SERIAL_SOURCES, NULL };
+
+/* the platform backend of each attribute, in identity_attr_t order */
+static struct {
+	const char **sources;
+	int (*valid)( const char *value );
+} identityBackend[identityAttrs] = {
+	{ macSources, identityMacValid },
+	{ serialSources, identitySerialValid },
+};
+
+static const char *identityCacheDir = RDKSSA_IDENTITY_CACHE_DIR;
+static const char *identityCachePath = RDKSSA_IDENTITY_CACHE;
+static const char *identityBootIdPath = "/proc/sys/kernel/random/boot_id";
+
+static pthread_mutex_t identityLock = PTHREAD_MUTEX_INITIALIZER;
+static const identity_cache_t *identityCache;		/* set once, under the lock; a missing value of our own copy is
+													   filled in under the lock, status last */
+static int identityCacheMapped;						/* identityCache is the file, not our own copy */
+static int identityShared;							/* the boot id is known, so the file can be used */
+
+// colon-separated ASCII hex, xx:xx:xx:xx:xx:xx
+static int identityMacValid( const char *value ) {
+	int i;
+
+	for ( i = 0; i < 17; i++ ) {
+		if ( i % 3 == 2 ? value[i] != ':' : !isxdigit( (unsigned char)value[i] ) ) {
+			return 0;
+		}
+	}
+	return value[i] == '\0';
+}
+
+static int identitySerialValid( const char *value ) {
+	const char *p;
+
+	for ( p = value; *p != '\0'; p++ ) {
+		if ( !isprint( (unsigned char)*p ) ) {
+			return 0;
+		}
+	}
+	return p != value;
+}
+
+// read a source, less the trailing newline, blanks and 0s that sysfs and the device tree leave; 0 if none
+static size_t identityRead( const char *path, char *value, size_t size ) {
+	ssize_t len;
+	int fd;
+
+	value[0] = '\0';
+	if ( ( fd = open( path, O_RDONLY | O_CLOEXEC ) ) < 0 ) {
+		return 0;
+	}
+	len = read( fd, value, size );
+	close( fd );
+	if ( len <= 0 || (size_t)len == size ) {		/* nothing, or too long */
+		value[0] = '\0';
+		return 0;
+	}
+	while ( len > 0 && ( value[len-1] == '\0' || isspace( (unsigned char)value[len-1] ) ) ) {
+		len--;
+	}
+	value[len] = '\0';
+	return (size_t)len;
+}
+
+// ask the platform for one attribute
+static void identityQuery( identity_attr_t attr, identity_value_t *v ) {
+	const char **source;
+	size_t len;
+
+	for ( source = identityBackend[attr].sources; *source != NULL; source++ ) {
+		len = identityRead( *source, v->value, sizeof( v->value ) );
+		if ( len > 0 && identityBackend[attr].valid( v->value ) ) {
+			RDKSSA_LOG_INFO( "identity attribute %d from %s\n", attr, *source );
+			v->status = rdkssaOK;
+			v->len = (uint32_t)len + 1;
+			return;
+		}
+	}
+	RDKSSA_LOG_INFO( "identity attribute %d: no platform source\n", attr );
+	memset( v, 0, sizeof( *v ) );
+	v->status = rdkssaMissingSource;
+}
+
+// every attribute is found: the cache is final and may be saved
+static int identityComplete( const identity_cache_t *cache ) {
+	int attr;
+
+	for ( attr = 0; attr < identityAttrs; attr++ ) {
+		if ( cache->value[attr].status != rdkssaOK ) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+// the cache file, if it is trusted, complete and from this boot; NULL if not
+static const identity_cache_t *identityMap( const char *bootId ) {
+	const identity_cache_t *cache;
+	struct stat st;
+	int fd;
+
+	if ( ( fd = open( identityCachePath, O_RDONLY | O_CLOEXEC | O_NOFOLLOW ) ) < 0 ) {
+		return NULL;
+	}
+	if ( fstat( fd, &st ) != 0 || !S_ISREG( st.st_mode ) || st.st_size != sizeof( identity_cache_t ) ||
+		 ( st.st_uid != 0 && st.st_uid != geteuid() ) || ( st.st_mode & ( S_IWGRP | S_IWOTH ) ) != 0 ) {
+		RDKSSA_LOG_INFO( "identity cache %s not trusted\n", identityCachePath );
+		close( fd );
+		return NULL;
+	}
+	cache = mmap( NULL, sizeof( identity_cache_t ), PROT_READ, MAP_SHARED, fd, 0 );
+	close( fd );
+	if ( cache == MAP_FAILED ) {
+		return NULL;
+	}
+	if ( cache->magic != IDENTITY_CACHE_MAGIC || cache->size != sizeof( identity_cache_t ) ||
+		 strncmp( cache->bootId, bootId, sizeof( cache->bootId ) ) != 0 || !identityComplete( cache ) ) {
+		munmap( (void *)cache, sizeof( identity_cache_t ) );
+		return NULL;
+	}
+	return cache;
+}
+
+// save the cache for the other processes: write a new file, then rename it over the old one
+static void identitySave( const identity_cache_t *cache ) {
+	char tmp[PATH_MAX];
+	int fd, ok;
+
+	snprintf( tmp, sizeof( tmp ), "%s.%d", identityCachePath, (int)getpid() );
+	unlink( tmp );									/* left by a process that had our pid */
+	if ( ( fd = open( tmp, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC | O_NOFOLLOW, 0444 ) ) < 0 ) {
+		RDKSSA_LOG_INFO( "identity cache not saved (%d)\n", errno );
+		return;
+	}
+	ok = write( fd, cache, sizeof( *cache ) ) == sizeof( *cache );
+	ok = close( fd ) == 0 && ok;
+	if ( !ok || rename( tmp, identityCachePath ) != 0 ) {
+		RDKSSA_LOG_INFO( "identity cache not saved (%d)\n", errno );
+		unlink( tmp );
+	}
+}
+
+// read every attribute from the platform; the cache directory is locked, if there is one
+static const identity_cache_t *identityBuild( const char *bootId, int save ) {
+	identity_cache_t *cache;
+	int attr;
+
+	if ( ( cache = calloc( 1, sizeof( *cache ) ) ) == NULL ) {
+		return NULL;
+	}
+	cache->magic = IDENTITY_CACHE_MAGIC;
+	cache->size = sizeof( *cache );
+	memcpy( cache->bootId, bootId, sizeof( cache->bootId ) );
+	for ( attr = 0; attr < identityAttrs; attr++ ) {
+		identityQuery( attr, &cache->value[attr] );
+	}
+	if ( save && identityComplete( cache ) ) {
+		identitySave( cache );
+	}
+	return cache;
+}
+
+// ask the platform again for an attribute our own copy is missing; saved once the copy is complete
+static void identityRefresh( identity_attr_t attr ) {
+	identity_cache_t *cache;
+	identity_value_t fresh;
+	int dirFd;
+
+	pthread_mutex_lock( &identityLock );
+	cache = (identity_cache_t *)identityCache;
+	if ( !identityCacheMapped && cache->value[attr].status != rdkssaOK ) {
+		identityQuery( attr, &fresh );
+		if ( fresh.status == rdkssaOK ) {
+			memcpy( cache->value[attr].value, fresh.value, sizeof( fresh.value ) );
+			cache->value[attr].len = fresh.len;
+			__atomic_store_n( &cache->value[attr].status, rdkssaOK, __ATOMIC_RELEASE );
+			if ( identityShared && identityComplete( cache ) &&
+				 ( dirFd = open( identityCacheDir, O_RDONLY | O_DIRECTORY | O_CLOEXEC ) ) >= 0 ) {
+				(void)flock( dirFd, LOCK_EX );
+				identitySave( cache );
+				close( dirFd );
+			}
+		}
+	}
+	pthread_mutex_unlock( &identityLock );
+}
+
+// this process's view of the cache, loaded on first use; NULL if out of memory
+static const identity_cache_t *identityGetCache( void ) {
+	const identity_cache_t *cache = __atomic_load_n( &identityCache, __ATOMIC_ACQUIRE );
+	char bootId[RDKSSA_IDENTITY_VALUE_MAX] = { 0 };
+	int dirFd, mapped = 1;
+
+	if ( cache != NULL ) {
+		return cache;
+	}
+	pthread_mutex_lock( &identityLock );
+	if ( ( cache = identityCache ) == NULL ) {
+		identityShared = identityRead( identityBootIdPath, bootId, sizeof( bootId ) ) == IDENTITY_BOOT_ID_LEN;
+		if ( !identityShared ) {
+			/* a file tagged with no boot id would be taken as this boot's by every later one */
+			RDKSSA_LOG_INFO( "identity cache not shared: no boot id in %s\n", identityBootIdPath );
+			memset( bootId, 0, sizeof( bootId ) );
+			cache = identityBuild( bootId, 0 );
+			mapped = 0;
+		} else if ( ( cache = identityMap( bootId ) ) == NULL ) {
+			/* one process reads the platform, the others wait for its file */
+			(void)mkdir( identityCacheDir, 0755 );
+			if ( ( dirFd = open( identityCacheDir, O_RDONLY | O_DIRECTORY | O_CLOEXEC ) ) >= 0 ) {
+				(void)flock( dirFd, LOCK_EX );
+			}
+			if ( ( cache = identityMap( bootId ) ) == NULL ) {
+				cache = identityBuild( bootId, dirFd >= 0 );
+				mapped = 0;
+			}
+			if ( dirFd >= 0 ) {
+				close( dirFd );						/* and the lock */
+			}
+		}
+		identityCacheMapped = mapped;
+		__atomic_store_n( &identityCache, cache, __ATOMIC_RELEASE );
+	}
+	pthread_mutex_unlock( &identityLock );
+	return cache;
+}
+
+/**
+ * Declare stack-based structure that collects the input parameters
+ */
+typedef struct {
+	int attr;								/* identity_attr_t; identityAttrs until one is given */
+} identity_param_t, *identity_param_ptr;
+
+// the attributes are bare names, one per call
+static rdkssaStatus_t identityAttr( rdkssa_blobptr_t blobPtr, identity_attr_t attr, const rdkssaAttrView_t *view ) {
+	identity_param_ptr ip = (identity_param_ptr)blobPtr;
+
+	if ( ip == NULL ) { return rdkssaBadPointer; }
+	if ( view->value != NULL ) {
+		RDKSSA_LOG_ERROR( "rdkssaGetIdentityAttribute attributes take no value\n" );
+		return rdkssaSyntaxError;
+	}
+	if ( ip->attr != identityAttrs ) {
+		RDKSSA_LOG_ERROR( "rdkssaGetIdentityAttribute takes one attribute\n" );
+		return rdkssaSyntaxError;
+	}
+	ip->attr = attr;
+	return rdkssaOK;
+}
+
+// BASEMACADDRESS
+static rdkssaStatus_t rdkssaIdentityMac(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
+    RDKSSA_LOG_DEBUG( "    rdkssaIdentityMac\n" );
+	return identityAttr( blobPtr, identityMac, view );
+}
+
+// SERIALNUMBER
+static rdkssaStatus_t rdkssaIdentitySerial(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
+    RDKSSA_LOG_DEBUG( "    rdkssaIdentitySerial\n" );
+	return identityAttr( blobPtr, identitySerial, view );
+}
+
+/**
+ * Function pointers to specific handlers as/if needed for each identified attribute, in identity_attr_t order
+ */
+static const AttributeHandlerStruct identityHandlers[]= {
+    {"BASEMACADDRESS", NULL, rdkssaIdentityMac },
+    {"SERIALNUMBER", NULL, rdkssaIdentitySerial },
+	{ NULL, NULL }
+};
+static AttributeHandlerIndex identityHandlerIndex = RDKSSA_HANDLER_INDEX( identityHandlers );
+
+/**
+ * API Entry point for Identity Provider supported API's
+ */
+RDKSSA_API( rdkssaGetIdentityAttribute )
+{
+	rdkssaDataBufPtr_t out = (rdkssaDataBufPtr_t)apiBlobPtr;
+	identity_param_t identityParameters = { identityAttrs };
+	const identity_cache_t *cache;
+	const identity_value_t *v;
+	rdkssaStatus_t iRetAtr;
+	int32_t status;
+
+	if ( out == NULL || apiAttributes == NULL ) {
+		RDKSSA_LOG_ERROR( "rdkssaGetIdentityAttribute NULL ptr\n" );
+		return rdkssaBadPointer;
+	}
+	if ( apiAttributes[0] == NULL ) {
+		RDKSSA_LOG_ERROR( "rdkssaGetIdentityAttribute missing attribute\n" );
+		return rdkssaMissingAttribute;
+	}
+	iRetAtr = rdkssaHandleAPIIndexedHelper( (void*)&identityParameters, apiAttributes, &identityHandlerIndex );
+	if ( iRetAtr != rdkssaOK ) {
+		RDKSSA_LOG_ERROR( "rdkssaGetIdentityAttribute error in handler\n" );
+		return iRetAtr;
+	}
+	if ( ( cache = identityGetCache() ) == NULL ) {
+		RDKSSA_LOG_ERROR( "rdkssaGetIdentityAttribute allocation failure\n" );
+		return rdkssaGeneralFailure;
+	}
+	v = &cache->value[identityParameters.attr];
+	if ( __atomic_load_n( &v->status, __ATOMIC_ACQUIRE ) != rdkssaOK ) {
+		identityRefresh( identityParameters.attr );
+	}
+	if ( ( status = __atomic_load_n( &v->status, __ATOMIC_ACQUIRE ) ) != rdkssaOK ) {
+		RDKSSA_LOG_ERROR( "rdkssaGetIdentityAttribute no %s on this platform\n", identityHandlers[identityParameters.attr].attributeNameStr );
+		return status;
+	}
+	if ( v->len == 0 || v->len > sizeof( v->value ) || v->value[v->len-1] != '\0' ) {
+		RDKSSA_LOG_ERROR( "rdkssaGetIdentityAttribute bad identity cache\n" );
+		return rdkssaGeneralFailure;
+	}
+	if ( out->sizeOfData < v->len ) {
+		out->sizeOfData = v->len;
+		return rdkssaBadLength;
+	}
+	memcpy( out->dataBuffer, v->value, v->len );
+	out->sizeOfData = v->len;
+	return rdkssaOK;
+}
+
+
+#ifdef UNIT_TESTS
+#include <sys/wait.h>
+#include "unit_tests.h"
+
+// STUB rdkssaHandleAPIIndexedHelper - just enough of the real one: split NAME[=value], call the view handler
+rdkssaStatus_t rdkssaHandleAPIIndexedHelper( rdkssa_blobptr_t apiBlobPtr, const char *const attributes[], AttributeHandlerIndex *attributeIndex) {
+    const AttributeHandlerStruct *h;
+    rdkssaAttrView_t view;
+    rdkssaStatus_t ret = rdkssaAttributeNotFound;
+    const char *eq;
+    int i;
+
+    for ( i = 0; attributes[i] != NULL; i++ ) {
+        eq = strchr( attributes[i], '=' );
+        view.name = attributes[i];
+        view.nameLen = eq ? (size_t)( eq - attributes[i] ) : strlen( attributes[i] );
+        view.value = eq ? eq + 1 : NULL;
+        view.valueLen = eq ? strlen( eq + 1 ) : 0;
+        view.flags = 0;
+        for ( h = attributeIndex->attributeTable; h->attributeNameStr != NULL; h++ ) {
+            if ( strlen( h->attributeNameStr ) == view.nameLen && strncmp( h->attributeNameStr, view.name, view.nameLen ) == 0 ) break;
+        }
+        if ( h->attributeNameStr == NULL ) return rdkssaAttributeNotFound;
+        if ( ( ret = h->attributeViewOperation( apiBlobPtr, &view ) ) != rdkssaOK ) return ret;
+    }
+    return ret;
+}
+// ut stubs -- these are shortened versions of real functions from helpers
+int rdkssaLogLevel = RDKSSA_LOG_LEVEL_DEFAULT;
+
+#define UT_DIR      "/tmp/ut_ssaidentity"
+
+static const char *utMacSources[] = { UT_DIR "/no_such_source", UT_DIR "/mac", NULL };
+static const char *utSerialSources[] = { UT_DIR "/serial", NULL };
+
+// forget this process's cache, as a new process would
+static void utForget( void ) {
+    if ( identityCache != NULL ) {
+        if ( identityCacheMapped ) munmap( (void *)identityCache, sizeof( identity_cache_t ) );
+        else free( (void *)identityCache );
+    }
+    identityCache = NULL;
+}
+
+static void utWrite( const char *path, const char *data, size_t len ) {
+    FILE *f;
+    UTST( ( f = fopen( path, "w" ) ) != NULL );
+    UTST( fwrite( data, 1, len, f ) == len );
+    fclose( f );
+}
+
+static rdkssaStatus_t utGet( const char *attribute, char *value, size_t size ) {
+    const char * const attributes[] = { attribute, NULL };
+    rdkssaDataBufPtr_t buf = calloc( 1, sizeof( rdkssaDataBuf_t ) + size );
+    rdkssaStatus_t status;
+    UTST( buf != NULL );
+    buf->sizeOfData = size;
+    status = rdkssaGetIdentityAttribute( buf, attributes );
+    if ( status == rdkssaOK ) {
+        UTST( buf->sizeOfData == strlen( (char *)buf->dataBuffer ) + 1 );
+        memcpy( value, buf->dataBuffer, buf->sizeOfData );
+    } else if ( status == rdkssaBadLength ) {
+        snprintf( value, size, "%u", (unsigned)buf->sizeOfData );
+    }
+    free( buf );
+    return status;
+}
+
+static void ut_identityGet( void );
+static void ut_identityErrors( void );
+static void ut_benchIdentity( void );
+
+int utmain_identity( int argc, char *argv[] ) {
+    RDKSSA_LOG_UT("=== Unit tests IDENTITY begin ===\n");
+
+    UTST( system( "rm -rf " UT_DIR " && mkdir -p " UT_DIR ) == 0 );
+    identityBackend[identityMac].sources = utMacSources;
+    identityBackend[identitySerial].sources = utSerialSources;
+    identityCacheDir = UT_DIR "/run";
+    identityCachePath = UT_DIR "/run/identity";
+
+    ut_identityGet( );
+    ut_identityErrors( );
+    ut_benchIdentity( );
+
+    UTST( system( "rm -rf " UT_DIR ) == 0 );
+    RDKSSA_LOG_UT("=== Unit tests IDENTITY SUCCESS ===\n");
+    return 0;
+}
+
+int main( int argc, char *argv[] ) {
+    return utmain_identity( argc, argv );
+}
+
+static void ut_identityGet( void ) {
+    RDKSSA_LOG_UT("  identity get\n");
+    char value[RDKSSA_IDENTITY_VALUE_MAX];
+    struct stat st;
+    ino_t ino;
+    int status;
+    pid_t pid;
+
+    utWrite( UT_DIR "/mac", "00:11:22:aa:bb:cc\n", 18 );
+    utWrite( UT_DIR "/serial", "SN-0042\0", 8 );      /* device tree style */
+    UTST( utGet( "BASEMACADDRESS", value, sizeof( value ) ) == rdkssaOK );
+    UTST0( strcmp( value, "00:11:22:aa:bb:cc" ) );
+    UTST( utGet( "SERIALNUMBER", value, sizeof( value ) ) == rdkssaOK );
+    UTST0( strcmp( value, "SN-0042" ) );
+    UTST0( identityCacheMapped );
+    UTST( stat( UT_DIR "/run/identity", &st ) == 0 && ( st.st_mode & 0777 ) == 0444 );
+
+    // read once per boot: later changes to the platform are not seen by this process ...
+    utWrite( UT_DIR "/mac", "00:11:22:dd:ee:ff\n", 18 );
+    UTST( utGet( "BASEMACADDRESS", value, sizeof( value ) ) == rdkssaOK );
+    UTST0( strcmp( value, "00:11:22:aa:bb:cc" ) );
+    // ... nor by another, which maps the file
+    UTST( ( pid = fork() ) >= 0 );
+    if ( pid == 0 ) {
+        utForget( );
+        _exit( utGet( "BASEMACADDRESS", value, sizeof( value ) ) != rdkssaOK || strcmp( value, "00:11:22:aa:bb:cc" ) != 0 ||
+               !identityCacheMapped );
+    }
+    UTST( waitpid( pid, &status, 0 ) == pid && WIFEXITED( status ) && WEXITSTATUS( status ) == 0 );
+    utForget( );
+    UTST( utGet( "SERIALNUMBER", value, sizeof( value ) ) == rdkssaOK );
+    UTST0( strcmp( value, "SN-0042" ) );
+    UTST( identityCacheMapped );
+
+    // another boot reads the platform again
+    identityBootIdPath = UT_DIR "/boot_id";
+    utWrite( UT_DIR "/boot_id", "00000000-0000-0000-0000-000000000001\n", 37 );
+    utForget( );
+    UTST( utGet( "BASEMACADDRESS", value, sizeof( value ) ) == rdkssaOK );
+    UTST0( strcmp( value, "00:11:22:dd:ee:ff" ) );
+    UTST0( identityCacheMapped );
+    // no boot id: the file is neither used nor replaced
+    UTST( stat( UT_DIR "/run/identity", &st ) == 0 );
+    ino = st.st_ino;
+    identityBootIdPath = UT_DIR "/no_boot_id";
+    utForget( );
+    UTST( utGet( "BASEMACADDRESS", value, sizeof( value ) ) == rdkssaOK );
+    UTST0( strcmp( value, "00:11:22:dd:ee:ff" ) );
+    UTST0( identityCacheMapped );
+    UTST0( identityShared );
+    UTST( stat( UT_DIR "/run/identity", &st ) == 0 && st.st_ino == ino );
+    identityBootIdPath = "/proc/sys/kernel/random/boot_id";
+    utForget( );
+    UTST( utGet( "BASEMACADDRESS", value, sizeof( value ) ) == rdkssaOK );
+    UTST0( strcmp( value, "00:11:22:dd:ee:ff" ) );
+    RDKSSA_LOG_UT("  identity get SUCCESS\n");
+}
+
+static void ut_identityErrors( void ) {
+    RDKSSA_LOG_UT("  identity errors\n");
+    const char * const none[] = { NULL };
+    const char * const two[] = { "BASEMACADDRESS", "SERIALNUMBER", NULL };
+    char value[RDKSSA_IDENTITY_VALUE_MAX];
+
+    // too small a buffer tells the size
+    UTST( utGet( "BASEMACADDRESS", value, 17 ) == rdkssaBadLength );
+    UTST0( strcmp( value, "18" ) );
+
+    RDKSSA_LOG_UT("  identity errors expect 9 errors\n");
+    UTST( rdkssaGetIdentityAttribute( NULL, two ) == rdkssaBadPointer );
+    UTST( rdkssaGetIdentityAttribute( value, none ) == rdkssaMissingAttribute );
+    UTST( rdkssaGetIdentityAttribute( value, two ) == rdkssaSyntaxError );
+    UTST( utGet( "BASEMACADDRESS=X", value, sizeof( value ) ) == rdkssaSyntaxError );
+    UTST( utGet( "MODELNAME", value, sizeof( value ) ) == rdkssaAttributeNotFound );
+
+    // nothing valid on the platform yet: not saved, and asked for again until it is there
+    utWrite( UT_DIR "/mac", "00-11-22-aa-bb-cc\n", 18 );
+    UTST( unlink( UT_DIR "/serial" ) == 0 );
+    UTST( unlink( UT_DIR "/run/identity" ) == 0 );
+    utForget( );
+    UTST( utGet( "BASEMACADDRESS", value, sizeof( value ) ) == rdkssaMissingSource );
+    UTST( utGet( "SERIALNUMBER", value, sizeof( value ) ) == rdkssaMissingSource );
+    UTST( access( UT_DIR "/run/identity", F_OK ) != 0 );
+    utWrite( UT_DIR "/serial", "SN-0043\n", 8 );
+    UTST( utGet( "SERIALNUMBER", value, sizeof( value ) ) == rdkssaOK );
+    UTST0( strcmp( value, "SN-0043" ) );
+    UTST( access( UT_DIR "/run/identity", F_OK ) != 0 );
+    utWrite( UT_DIR "/mac", "00:11:22:aa:bb:cc\n", 18 );
+    UTST( utGet( "BASEMACADDRESS", value, sizeof( value ) ) == rdkssaOK );
+    UTST0( strcmp( value, "00:11:22:aa:bb:cc" ) );
+    UTST0( identityCacheMapped );
+    // complete now: saved for the others
+    utForget( );
+    UTST( utGet( "SERIALNUMBER", value, sizeof( value ) ) == rdkssaOK );
+    UTST( identityCacheMapped );
+
+    // a cache file others can write is not trusted, and replaced
+    UTST( chmod( UT_DIR "/run/identity", 0666 ) == 0 );
+    utForget( );
+    UTST( utGet( "SERIALNUMBER", value, sizeof( value ) ) == rdkssaOK );
+    UTST0( strcmp( value, "SN-0043" ) );
+    UTST0( identityCacheMapped );
+    utForget( );
+    UTST( utGet( "SERIALNUMBER", value, sizeof( value ) ) == rdkssaOK );
+    UTST( identityCacheMapped );
+    RDKSSA_LOG_UT("  identity errors SUCCESS\n");
+}
+
+// a lookup against the platform read it replaces, and the first lookup of a process
+static void ut_benchIdentity( void ) {
+    RDKSSA_LOG_UT("  bench identity\n");
+    const int iter = 100000, firstIter = 2000;
+    char value[RDKSSA_IDENTITY_VALUE_MAX];
+    const char * const attributes[] = { "BASEMACADDRESS", NULL };
+    rdkssaDataBufPtr_t buf = calloc( 1, sizeof( rdkssaDataBuf_t ) + RDKSSA_IDENTITY_VALUE_MAX );
+    identity_value_t v;
+    uint64_t t0, tGet, tFirst, tPlatform;
+    int i;
+
+    UTST( buf != NULL );
+    utWrite( UT_DIR "/mac", "00:11:22:aa:bb:cc\n", 18 );
+    UTST( unlink( UT_DIR "/run/identity" ) == 0 );
+    utForget( );
+    UTST( utGet( "BASEMACADDRESS", value, sizeof( value ) ) == rdkssaOK );
+    t0 = utNowNs();
+    for ( i = 0; i < iter; i++ ) {
+        buf->sizeOfData = RDKSSA_IDENTITY_VALUE_MAX;
+        UTST( rdkssaGetIdentityAttribute( buf, attributes ) == rdkssaOK );
+    }
+    tGet = ( utNowNs() - t0 ) / iter;
+    t0 = utNowNs();
+    for ( i = 0; i < firstIter; i++ ) {
+        utForget( );
+        buf->sizeOfData = RDKSSA_IDENTITY_VALUE_MAX;
+        UTST( rdkssaGetIdentityAttribute( buf, attributes ) == rdkssaOK );
+    }
+    tFirst = ( utNowNs() - t0 ) / firstIter;
+    UTST( identityCacheMapped );
+    t0 = utNowNs();
+    for ( i = 0; i < firstIter; i++ ) {
+        identityQuery( identityMac, &v );
+        UTST( v.status == rdkssaOK );
+    }
+    tPlatform = ( utNowNs() - t0 ) / firstIter;
+    RDKSSA_LOG_UT("    lookup %llu ns, first lookup in a process %llu ns, platform read %llu ns\n",
+                  (unsigned long long)tGet, (unsigned long long)tFirst, (unsigned long long)tPlatform );
+    free( buf );
+    RDKSSA_LOG_UT("  bench identity SUCCESS\n");
+}
+#endif
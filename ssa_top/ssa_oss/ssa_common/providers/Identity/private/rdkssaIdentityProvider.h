@@ -0,0 +1,41 @@
+/*
+ * Copyright 2020 Comcast Cable Communications Management, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+*/
+
+#ifndef __rdkssa_identity_provider_inc__
+#define __rdkssa_identity_provider_inc__
+
+/* Include definitions private to the identity provider implementation */
+
+/* the per-boot cache of identity attributes; keep it on a tmpfs so it goes away with the boot */
+#ifndef RDKSSA_IDENTITY_CACHE_DIR
+#define RDKSSA_IDENTITY_CACHE_DIR       "/run/rdkssa"
+#endif
+#define RDKSSA_IDENTITY_CACHE           RDKSSA_IDENTITY_CACHE_DIR "/identity"
+
+/* platform sources of each attribute, tried in order; the first that reads back a valid value is used */
+#ifndef RDKSSA_IDENTITY_MAC_SOURCES
+#define RDKSSA_IDENTITY_MAC_SOURCES     "/sys/class/net/eth0/address"
+#endif
+#ifndef RDKSSA_IDENTITY_SERIAL_SOURCES
+#define RDKSSA_IDENTITY_SERIAL_SOURCES  "/proc/device-tree/serial-number", "/sys/class/dmi/id/product_serial"
+#endif
+
+/* longest attribute value, with its terminating 0 */
+#define RDKSSA_IDENTITY_VALUE_MAX       (64)
+
+#endif
@@ -0,0 +1,472 @@
+/*
+ * Copyright 2020 Comcast Cable Communications Management, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+*/
+
+#include <pthread.h>
+
+#include "rdkssa.h"
+#include "rdkssaCommonProtected.h"
+#include "rdkssaProviderProtected.h"
+#include "rdkssaKeyringProvider.h"
+
+/**
+ * The keyring: a fixed table of named keys, guarded by one lock
+ *
+ * Each key's bytes live in a reference counted rdkssaKeyringRef; the table holds one reference, and so
+ * does every rdkssaKeyringAcquire until it is released.  Replacing or deleting a key drops the table's
+ * reference, so a mount that is using the old bytes keeps them until it is done; the last release wipes them.
+ * A handle is the slot number plus a generation that changes when the slot is freed, so a handle of a
+ * deleted key never finds the key that reuses its slot.
+ */
+struct rdkssaKeyringRef {
+	unsigned refs;
+	size_t keyLen;
+	uint8_t key[];
+};
+
+typedef struct {
+	char name[RDKSSA_KEYRING_NAME_MAX + 1];		/* "" when free */
+	uint32_t generation;
+	rdkssaKeyringRef_t *ref;
+} keyring_slot_t;
+
+static pthread_mutex_t keyringLock = PTHREAD_MUTEX_INITIALIZER;
+static keyring_slot_t keyring[RDKSSA_KEYRING_SLOTS];
+
+#define KEYRING_HANDLE( slot )		( (rdkssa_handle_t)(uintptr_t)( ( (uintptr_t)keyring[slot].generation << 8 ) | ( (slot) + 1 ) ) )
+
+// slot of a handle, or -1; lock held
+static int keyringSlotOfHandle( rdkssa_handle_t keyHandle ) {
+	uintptr_t h = (uintptr_t)keyHandle;
+	int slot = (int)( h & 0xff ) - 1;
+
+	if ( slot < 0 || slot >= RDKSSA_KEYRING_SLOTS || keyring[slot].name[0] == '\0' ||
+		 ( h >> 8 ) != (uintptr_t)keyring[slot].generation ) {
+		return -1;
+	}
+	return slot;
+}
+
+// slot of a name, or -1; lock held
+static int keyringSlotOfName( const char *name ) {
+	int slot;
+
+	for ( slot = 0; slot < RDKSSA_KEYRING_SLOTS; slot++ ) {
+		if ( keyring[slot].name[0] != '\0' && strcmp( keyring[slot].name, name ) == 0 ) {
+			return slot;
+		}
+	}
+	return -1;
+}
+
+// drop one reference; the last one wipes the key; lock held
+static void keyringUnref( rdkssaKeyringRef_t *ref ) {
+	if ( --ref->refs == 0 ) {
+		rdkssaSecFree( ref );		/* wipes it */
+	}
+}
+
+rdkssaStatus_t rdkssaKeyringAcquire( rdkssa_handle_t keyHandle, rdkssaKeyringRef_t **ref, const uint8_t **key, size_t *keyLen ) {
+	int slot;
+
+	if ( ref == NULL || key == NULL || keyLen == NULL ) {
+		RDKSSA_LOG_ERROR( "rdkssaKeyringAcquire NULL ptr\n" );
+		return rdkssaBadPointer;
+	}
+	pthread_mutex_lock( &keyringLock );
+	if ( ( slot = keyringSlotOfHandle( keyHandle ) ) < 0 ) {
+		pthread_mutex_unlock( &keyringLock );
+		RDKSSA_LOG_ERROR( "rdkssaKeyringAcquire no such key\n" );
+		return rdkssaMissingSource;
+	}
+	*ref = keyring[slot].ref;
+	(*ref)->refs++;
+	pthread_mutex_unlock( &keyringLock );
+	*key = (*ref)->key;
+	*keyLen = (*ref)->keyLen;
+	return rdkssaOK;
+}
+
+void rdkssaKeyringRelease( rdkssaKeyringRef_t *ref ) {
+	if ( ref == NULL ) return;
+	pthread_mutex_lock( &keyringLock );
+	keyringUnref( ref );
+	pthread_mutex_unlock( &keyringLock );
+}
+
+/**
+ * Declare stack-based structure that collects the input parameters
+ */
+typedef struct {
+	/* points into the caller's attribute vector, which outlives the API call */
+	const char *name;
+} keyring_param_t, *keyring_param_ptr;
+
+// NAME = name of the key. The value is used in place, not copied
+static rdkssaStatus_t rdkssaKeyringName(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
+    RDKSSA_LOG_DEBUG( "    rdkssaKeyringName\n" );
+	keyring_param_ptr kp = (keyring_param_ptr)blobPtr;
+	const char *valueStr = rdkssaAttrViewCheck( view );
+
+	if ( kp == NULL ) { return rdkssaBadPointer;}
+	if ( valueStr == NULL || view->valueLen == 0 || view->valueLen > RDKSSA_KEYRING_NAME_MAX ||
+		 strspn( valueStr, "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789_" ) != view->valueLen ) {
+		RDKSSA_LOG_ERROR( "rdkssaKeyring NAME must be 1..%d of [A-Za-z0-9_]\n", RDKSSA_KEYRING_NAME_MAX );
+		return rdkssaValidityError;
+	}
+	kp->name = valueStr;
+	return rdkssaOK;
+}
+
+// PERM = permissions, only ALL so far
+static rdkssaStatus_t rdkssaKeyringPerm(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
+    RDKSSA_LOG_DEBUG( "    rdkssaKeyringPerm\n" );
+	const char *valueStr = rdkssaAttrViewCheck( view );
+
+	if ( valueStr == NULL ) { return rdkssaValidityError; }
+	if ( strcmp( valueStr, "ALL" ) != 0 ) {
+		RDKSSA_LOG_ERROR( "rdkssaKeyring PERM=%s not implemented\n", valueStr );
+		return rdkssaNYIError;
+	}
+	return rdkssaOK;
+}
+
+/**
+ * Function pointers to specific handlers as/if needed for each identified attribute
+ */
+static const AttributeHandlerStruct putHandlers[]= {
+    {"NAME", NULL, rdkssaKeyringName },
+    {"PERM", NULL, rdkssaKeyringPerm },
+	{ NULL, NULL }
+};
+static AttributeHandlerIndex putHandlerIndex = RDKSSA_HANDLER_INDEX( putHandlers );
+
+static const AttributeHandlerStruct nameHandlers[]= {
+    {"NAME", NULL, rdkssaKeyringName },
+	{ NULL, NULL }
+};
+static AttributeHandlerIndex nameHandlerIndex = RDKSSA_HANDLER_INDEX( nameHandlers );
+
+// keyringParams - handle the attributes, NAME= is required
+static rdkssaStatus_t keyringParams( keyring_param_ptr kp, const char * const apiAttributes[], AttributeHandlerIndex *index, const char *api ) {
+	rdkssaStatus_t iRetAtr;
+
+	kp->name = NULL;
+	iRetAtr = rdkssaHandleAPIIndexedHelper( (void*)kp, apiAttributes, index );
+	if ( iRetAtr != rdkssaOK ) {
+		RDKSSA_LOG_ERROR( "%s error in handler\n", api );
+		return iRetAtr;
+	}
+	if ( kp->name == NULL ) {
+		RDKSSA_LOG_ERROR( "%s missing NAME\n", api );
+		return rdkssaMissingAttribute;
+	}
+	return rdkssaOK;
+}
+
+/**
+ * API Entry points for Keyring Provider supported API's
+ */
+RDKSSA_API( rdkssaPutKeyringKey )
+{
+	rdkssaKeyringBlob_t *bp = (rdkssaKeyringBlob_t *)apiBlobPtr;
+	keyring_param_t keyringParameters;
+	rdkssaKeyringRef_t *ref;
+	rdkssaStatus_t iRetAtr;
+	int slot;
+
+	if ( bp == NULL || bp->keyBytes == NULL ) {
+		RDKSSA_LOG_ERROR( "rdkssaPutKeyringKey NULL ptr\n" );
+		return rdkssaBadPointer;
+	}
+	if ( ( iRetAtr = keyringParams( &keyringParameters, apiAttributes, &putHandlerIndex, "rdkssaPutKeyringKey" ) ) != rdkssaOK ) {
+		return iRetAtr;
+	}
+	if ( bp->keyBytes->sizeOfData == 0 || bp->keyBytes->sizeOfData > MAX_ATTRIBUTE_VALUE_LENGTH ) {
+		RDKSSA_LOG_ERROR( "rdkssaPutKeyringKey key must be 1..%d bytes\n", MAX_ATTRIBUTE_VALUE_LENGTH );
+		return rdkssaBadLength;
+	}
+	/* copy the key, to locked memory, before taking the lock */
+	if ( ( ref = rdkssaSecAlloc( sizeof(*ref) + bp->keyBytes->sizeOfData ) ) == NULL ) {
+		RDKSSA_LOG_ERROR( "rdkssaPutKeyringKey allocation failure\n" );
+		return rdkssaGeneralFailure;
+	}
+	ref->refs = 1;
+	ref->keyLen = bp->keyBytes->sizeOfData;
+	memcpy( ref->key, bp->keyBytes->dataBuffer, ref->keyLen );
+
+	pthread_mutex_lock( &keyringLock );
+	if ( ( slot = keyringSlotOfName( keyringParameters.name ) ) >= 0 ) {
+		keyringUnref( keyring[slot].ref );		/* replaced: old bytes go when the last user is done */
+	} else {
+		for ( slot = 0; slot < RDKSSA_KEYRING_SLOTS && keyring[slot].name[0] != '\0'; slot++ ) {}
+		if ( slot == RDKSSA_KEYRING_SLOTS ) {
+			keyringUnref( ref );
+			pthread_mutex_unlock( &keyringLock );
+			RDKSSA_LOG_ERROR( "rdkssaPutKeyringKey keyring full\n" );
+			return rdkssaGeneralFailure;
+		}
+		strcpy( keyring[slot].name, keyringParameters.name );		/* length checked by rdkssaKeyringName */
+	}
+	keyring[slot].ref = ref;
+	bp->keyHandle = KEYRING_HANDLE( slot );
+	pthread_mutex_unlock( &keyringLock );
+	return rdkssaOK;
+}
+
+RDKSSA_API( rdkssaGetKeyringKey )
+{
+	rdkssaKeyringBlob_t *bp = (rdkssaKeyringBlob_t *)apiBlobPtr;
+	keyring_param_t keyringParameters;
+	rdkssaKeyringRef_t *ref;
+	rdkssaStatus_t iRetAtr;
+	int slot;
+
+	if ( bp == NULL || bp->keyBytes == NULL ) {
+		RDKSSA_LOG_ERROR( "rdkssaGetKeyringKey NULL ptr\n" );
+		return rdkssaBadPointer;
+	}
+	if ( ( iRetAtr = keyringParams( &keyringParameters, apiAttributes, &nameHandlerIndex, "rdkssaGetKeyringKey" ) ) != rdkssaOK ) {
+		return iRetAtr;
+	}
+	pthread_mutex_lock( &keyringLock );
+	slot = keyringSlotOfName( keyringParameters.name );
+	if ( slot < 0 || ( bp->keyHandle != NULL && bp->keyHandle != KEYRING_HANDLE( slot ) ) ) {
+		pthread_mutex_unlock( &keyringLock );
+		RDKSSA_LOG_ERROR( "rdkssaGetKeyringKey no key %s\n", keyringParameters.name );
+		return rdkssaMissingSource;
+	}
+	ref = keyring[slot].ref;
+	if ( bp->keyBytes->sizeOfData < ref->keyLen ) {
+		bp->keyBytes->sizeOfData = ref->keyLen;
+		pthread_mutex_unlock( &keyringLock );
+		return rdkssaBadLength;
+	}
+	memcpy( bp->keyBytes->dataBuffer, ref->key, ref->keyLen );
+	bp->keyBytes->sizeOfData = ref->keyLen;
+	pthread_mutex_unlock( &keyringLock );
+	return rdkssaOK;
+}
+
+RDKSSA_API( rdkssaDeleteKeyFromKeyring )
+{
+	rdkssa_handle_t *keyHandle = (rdkssa_handle_t *)apiBlobPtr;
+	keyring_param_t keyringParameters;
+	rdkssaStatus_t iRetAtr;
+	int slot;
+
+	if ( ( iRetAtr = keyringParams( &keyringParameters, apiAttributes, &nameHandlerIndex, "rdkssaDeleteKeyFromKeyring" ) ) != rdkssaOK ) {
+		return iRetAtr;
+	}
+	pthread_mutex_lock( &keyringLock );
+	slot = keyringSlotOfName( keyringParameters.name );
+	if ( slot < 0 || ( keyHandle != NULL && *keyHandle != NULL && *keyHandle != KEYRING_HANDLE( slot ) ) ) {
+		pthread_mutex_unlock( &keyringLock );
+		RDKSSA_LOG_ERROR( "rdkssaDeleteKeyFromKeyring no key %s\n", keyringParameters.name );
+		return rdkssaMissingSource;
+	}
+	keyringUnref( keyring[slot].ref );
+	keyring[slot].ref = NULL;
+	keyring[slot].name[0] = '\0';
+	keyring[slot].generation = ( keyring[slot].generation + 1 ) & 0xffffff;
+	pthread_mutex_unlock( &keyringLock );
+	if ( keyHandle != NULL ) {
+		*keyHandle = NULL;
+	}
+	return rdkssaOK;
+}
+
+
+#ifdef UNIT_TESTS
+#include "unit_tests.h"
+
+// STUB rdkssaHandleAPIIndexedHelper - just enough of the real one: split NAME=value, call the view handler
+rdkssaStatus_t rdkssaHandleAPIIndexedHelper( rdkssa_blobptr_t apiBlobPtr, const char *const attributes[], AttributeHandlerIndex *attributeIndex) {
+    const AttributeHandlerStruct *h;
+    rdkssaAttrView_t view;
+    rdkssaStatus_t ret;
+    const char *eq;
+    int i;
+
+    for ( i = 0; attributes[i] != NULL; i++ ) {
+        if ( ( eq = strchr( attributes[i], '=' ) ) == NULL ) return rdkssaSyntaxError;
+        view.name = attributes[i];
+        view.nameLen = (size_t)( eq - attributes[i] );
+        view.value = eq + 1;
+        view.valueLen = strlen( eq + 1 );
+        view.flags = 0;
+        for ( h = attributeIndex->attributeTable; h->attributeNameStr != NULL; h++ ) {
+            if ( strlen( h->attributeNameStr ) == view.nameLen && strncmp( h->attributeNameStr, view.name, view.nameLen ) == 0 ) break;
+        }
+        if ( h->attributeNameStr == NULL ) return rdkssaAttributeNotFound;
+        if ( ( ret = h->attributeViewOperation( apiBlobPtr, &view ) ) != rdkssaOK ) return ret;
+    }
+    return rdkssaOK;
+}
+// ut stubs -- these are shortened versions of real functions from helpers
+int rdkssaLogLevel = RDKSSA_LOG_LEVEL_DEFAULT;
+void *rdkssaSecAlloc( size_t size ) {
+    return calloc( 1, size );
+}
+void rdkssaSecFree( void *mem ) {
+    free( mem );
+}
+const char *rdkssaAttrViewCheck( const rdkssaAttrView_t *view ) {
+    if ( view == NULL || view->value == NULL ) return NULL;
+    return strpbrk( view->value, RDKSSA_BADCHARS ) != NULL ? NULL : view->value;
+}
+
+static void ut_keyringPutGet( void );
+static void ut_keyringAcquire( void );
+static void ut_keyringErrors( void );
+
+int utmain_keyring( int argc, char *argv[] ) {
+    RDKSSA_LOG_UT("=== Unit tests KEYRING begin ===\n");
+
+    ut_keyringPutGet( );
+    ut_keyringAcquire( );
+    ut_keyringErrors( );
+
+    RDKSSA_LOG_UT("=== Unit tests KEYRING SUCCESS ===\n");
+    return 0;
+}
+
+int main( int argc, char *argv[] ) {
+    return utmain_keyring( argc, argv );
+}
+
+static rdkssaDataBufPtr_t utBuf( const char *data, size_t size ) {
+    size_t len = data ? strlen( data ) : size;
+    rdkssaDataBufPtr_t buf = malloc( sizeof(rdkssaDataBuf_t) + len );
+    UTST( buf != NULL );
+    buf->sizeOfData = len;
+    if ( data ) memcpy( buf->dataBuffer, data, buf->sizeOfData );
+    return buf;
+}
+
+static void ut_keyringPutGet( void ) {
+    RDKSSA_LOG_UT("  keyring put/get/delete\n");
+    const char * const name[] = { "NAME=ut_key_1", NULL };
+    const char * const namePerm[] = { "NAME=ut_key_1", "PERM=ALL", NULL };
+    rdkssaKeyringBlob_t put = { NULL, utBuf( "first-key", 0 ) };
+    rdkssaKeyringBlob_t get = { NULL, utBuf( NULL, 64 ) };
+    rdkssa_handle_t first;
+
+    UTST( rdkssaPutKeyringKey( &put, name ) == rdkssaOK );
+    UTST( ( first = put.keyHandle ) != NULL );
+    UTST( rdkssaGetKeyringKey( &get, name ) == rdkssaOK );
+    UTST( get.keyBytes->sizeOfData == 9 && memcmp( get.keyBytes->dataBuffer, "first-key", 9 ) == 0 );
+
+    // replace: same handle, new bytes
+    free( put.keyBytes );
+    put.keyBytes = utBuf( "the-second-key", 0 );
+    UTST( rdkssaPutKeyringKey( &put, namePerm ) == rdkssaOK );
+    UTST( put.keyHandle == first );
+    get.keyHandle = first;
+    get.keyBytes->sizeOfData = 64;
+    UTST( rdkssaGetKeyringKey( &get, name ) == rdkssaOK );
+    UTST( get.keyBytes->sizeOfData == 14 && memcmp( get.keyBytes->dataBuffer, "the-second-key", 14 ) == 0 );
+    // too small a buffer tells the size
+    get.keyBytes->sizeOfData = 4;
+    UTST( rdkssaGetKeyringKey( &get, name ) == rdkssaBadLength );
+    UTST( get.keyBytes->sizeOfData == 14 );
+
+    UTST( rdkssaDeleteKeyFromKeyring( &put.keyHandle, name ) == rdkssaOK );
+    UTST( put.keyHandle == NULL );
+    RDKSSA_LOG_UT("  keyring put/get/delete expect 2 errors\n");
+    get.keyBytes->sizeOfData = 64;
+    UTST( rdkssaGetKeyringKey( &get, name ) == rdkssaMissingSource );
+    // the slot is reused, the old handle does not find the new key
+    put.keyHandle = NULL;
+    UTST( rdkssaPutKeyringKey( &put, name ) == rdkssaOK );
+    UTST( put.keyHandle != first );
+    UTST( rdkssaGetKeyringKey( &get, name ) == rdkssaMissingSource );
+    UTST( rdkssaDeleteKeyFromKeyring( NULL, name ) == rdkssaOK );
+    free( put.keyBytes );
+    free( get.keyBytes );
+    RDKSSA_LOG_UT("  keyring put/get/delete SUCCESS\n");
+}
+
+// a pinned key outlives its replacement and deletion
+static void ut_keyringAcquire( void ) {
+    RDKSSA_LOG_UT("  keyring acquire\n");
+    const char * const name[] = { "NAME=ut_pinned", NULL };
+    rdkssaKeyringBlob_t put = { NULL, utBuf( "pinned-key", 0 ) };
+    rdkssaKeyringRef_t *ref, *ref2;
+    const uint8_t *key, *key2;
+    size_t keyLen;
+
+    UTST( rdkssaPutKeyringKey( &put, name ) == rdkssaOK );
+    UTST( rdkssaKeyringAcquire( put.keyHandle, &ref, &key, &keyLen ) == rdkssaOK );
+    UTST( keyLen == 10 && memcmp( key, "pinned-key", 10 ) == 0 );
+    free( put.keyBytes );
+    put.keyBytes = utBuf( "replacement", 0 );
+    UTST( rdkssaPutKeyringKey( &put, name ) == rdkssaOK );
+    UTST( rdkssaKeyringAcquire( put.keyHandle, &ref2, &key2, &keyLen ) == rdkssaOK );
+    UTST( keyLen == 11 && memcmp( key2, "replacement", 11 ) == 0 );
+    UTST( memcmp( key, "pinned-key", 10 ) == 0 );
+    UTST( rdkssaDeleteKeyFromKeyring( NULL, name ) == rdkssaOK );
+    UTST( memcmp( key2, "replacement", 11 ) == 0 );
+    UTST( ref->refs == 1 && ref2->refs == 1 );
+    rdkssaKeyringRelease( ref );
+    rdkssaKeyringRelease( ref2 );
+    RDKSSA_LOG_UT("  keyring acquire expect 1 error\n");
+    UTST( rdkssaKeyringAcquire( put.keyHandle, &ref, &key, &keyLen ) == rdkssaMissingSource );
+    free( put.keyBytes );
+    RDKSSA_LOG_UT("  keyring acquire SUCCESS\n");
+}
+
+static void ut_keyringErrors( void ) {
+    RDKSSA_LOG_UT("  keyring errors\n");
+    rdkssaKeyringBlob_t put = { NULL, utBuf( "k", 0 ) };
+    const char * const badName[] = { "NAME=no-dashes", NULL };
+    const char * const badPerm[] = { "NAME=ok", "PERM=OWNER", NULL };
+    const char * const noName[] = { "PERM=ALL", NULL };
+    char nameBuf[32];
+    const char *name[] = { nameBuf, NULL };
+    rdkssaKeyringRef_t *ref;
+    const uint8_t *key;
+    size_t keyLen;
+    int i;
+
+    RDKSSA_LOG_UT("  keyring errors expect 11 errors\n");
+    UTST( rdkssaPutKeyringKey( NULL, noName ) == rdkssaBadPointer );
+    UTST( rdkssaPutKeyringKey( &put, badName ) == rdkssaValidityError );
+    UTST( rdkssaPutKeyringKey( &put, badPerm ) == rdkssaNYIError );
+    UTST( rdkssaPutKeyringKey( &put, noName ) == rdkssaMissingAttribute );
+    UTST( rdkssaKeyringAcquire( NULL, &ref, &key, &keyLen ) == rdkssaMissingSource );
+    UTST( rdkssaKeyringAcquire( (rdkssa_handle_t)(uintptr_t)0x7fff, &ref, &key, &keyLen ) == rdkssaMissingSource );
+    put.keyBytes->sizeOfData = 0;
+    snprintf( nameBuf, sizeof(nameBuf), "NAME=empty" );
+    UTST( rdkssaPutKeyringKey( &put, name ) == rdkssaBadLength );
+    put.keyBytes->sizeOfData = 1;
+    // fill the keyring
+    for ( i = 0; i < RDKSSA_KEYRING_SLOTS; i++ ) {
+        snprintf( nameBuf, sizeof(nameBuf), "NAME=k%d", i );
+        UTST( rdkssaPutKeyringKey( &put, name ) == rdkssaOK );
+    }
+    snprintf( nameBuf, sizeof(nameBuf), "NAME=one_too_many" );
+    UTST( rdkssaPutKeyringKey( &put, name ) == rdkssaGeneralFailure );
+    for ( i = 0; i < RDKSSA_KEYRING_SLOTS; i++ ) {
+        snprintf( nameBuf, sizeof(nameBuf), "NAME=k%d", i );
+        UTST( rdkssaDeleteKeyFromKeyring( NULL, name ) == rdkssaOK );
+    }
+    UTST( rdkssaDeleteKeyFromKeyring( NULL, name ) == rdkssaMissingSource );
+    free( put.keyBytes );
+    RDKSSA_LOG_UT("  keyring errors SUCCESS\n");
+}
+#endif // UNIT_TESTS
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2020 Comcast Cable Communications Management, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+*/
+
+#ifndef __rdkssa_keyring_provider_inc__
+#define __rdkssa_keyring_provider_inc__
+
+/* Include definitions private to the keyring provider implementation */
+
+/* keys the in-process keyring holds at once (at most 255, the slot is part of the handle) */
+#ifndef RDKSSA_KEYRING_SLOTS
+#define RDKSSA_KEYRING_SLOTS        (32)
+#endif
+
+/* longest NAME= */
+#define RDKSSA_KEYRING_NAME_MAX     (64)
+
+#endif
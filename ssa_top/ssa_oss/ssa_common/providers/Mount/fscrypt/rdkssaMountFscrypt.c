@@ -0,0 +1,339 @@
+/*
+ * Copyright 2020 Comcast Cable Communications Management, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+*/
+
+/**
+ * FSCRYPT mount backend: mounts with syscalls instead of exec'ing the mount helper
+ *
+ * PATH is a directory on a filesystem with fscrypt support (e.g. ext4 -O encrypt, f2fs, ubifs).
+ * The key is added to that filesystem's keyring, PATH gets a v2 policy for it if it is a new or
+ * empty directory, and PATH is bind mounted on MOUNTPOINT.
+ * The key stays in the filesystem's keyring after rdkssaUnmount, as it would for the mount helper.
+ * A mount that fails takes the key back out, unless PATH already had a policy for it.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mount.h>
+#include <sys/stat.h>
+#include <linux/fscrypt.h>
+
+#include "rdkssa.h"
+#include "rdkssaCommonProtected.h"
+#include "rdkssaMountProtected.h"
+
+_Static_assert( RDKSSA_MOUNT_FSCRYPT_KEY_SIZE == FSCRYPT_MAX_KEY_SIZE, "RDKSSA_MOUNT_FSCRYPT_KEY_SIZE" );
+
+// mode of PATH and MOUNTPOINT when they have to be made
+#define FSCRYPT_DIR_MODE	(0700)
+
+// make dir if it is missing, 0 or errno
+static int fscryptMkdir( const char *dir ) {
+	if ( mkdir( dir, FSCRYPT_DIR_MODE ) == 0 || errno == EEXIST ) {
+		return 0;
+	}
+	return errno;
+}
+
+// add the key to the keyring of the filesystem dirFd is on, and return its identifier; 0 or errno
+static int fscryptAddKey( int dirFd, const uint8_t *key, size_t keyLen, uint8_t identifier[FSCRYPT_KEY_IDENTIFIER_SIZE] ) {
+	/* the key is copied in after the header, in locked memory that is wiped with it */
+	struct fscrypt_add_key_arg *add = rdkssaSecAlloc( sizeof( *add ) + FSCRYPT_MAX_KEY_SIZE );
+	int err = 0;
+
+	if ( add == NULL ) {
+		return ENOMEM;
+	}
+	add->key_spec.type = FSCRYPT_KEY_SPEC_TYPE_IDENTIFIER;
+	add->raw_size = (__u32)keyLen;
+	memcpy( add->raw, key, keyLen );
+	if ( ioctl( dirFd, FS_IOC_ADD_ENCRYPTION_KEY, add ) != 0 ) {
+		err = errno;
+	} else {
+		memcpy( identifier, add->key_spec.u.identifier, FSCRYPT_KEY_IDENTIFIER_SIZE );
+	}
+	rdkssaSecFree( add );
+	return err;
+}
+
+// take a key fscryptAddKey added back out of the filesystem's keyring; a failure is only logged
+static void fscryptRemoveKey( int dirFd, const char *path, const uint8_t identifier[FSCRYPT_KEY_IDENTIFIER_SIZE] ) {
+	struct fscrypt_remove_key_arg remove;
+
+	memset( &remove, 0, sizeof( remove ) );
+	remove.key_spec.type = FSCRYPT_KEY_SPEC_TYPE_IDENTIFIER;
+	memcpy( remove.key_spec.u.identifier, identifier, FSCRYPT_KEY_IDENTIFIER_SIZE );
+	if ( ioctl( dirFd, FS_IOC_REMOVE_ENCRYPTION_KEY, &remove ) != 0 ) {
+		RDKSSA_LOG_ERROR( "rdkssaMountFscrypt remove key for %s failed (%d)\n", path, errno );
+	}
+}
+
+// encrypt dirFd with the key identifier, unless it is encrypted already; rdkssaOK if it is (now) encrypted with that key
+// *had is set when dirFd already had a policy for this key before the call
+static rdkssaStatus_t fscryptPolicy( int dirFd, const char *path, const uint8_t identifier[FSCRYPT_KEY_IDENTIFIER_SIZE], int *had ) {
+	struct fscrypt_get_policy_ex_arg get;
+	struct fscrypt_policy_v2 policy;
+
+	*had = 0;
+	get.policy_size = sizeof( get.policy );
+	if ( ioctl( dirFd, FS_IOC_GET_ENCRYPTION_POLICY_EX, &get ) == 0 ) {
+		if ( get.policy.version != FSCRYPT_POLICY_V2 ||
+			 memcmp( get.policy.v2.master_key_identifier, identifier, FSCRYPT_KEY_IDENTIFIER_SIZE ) != 0 ) {
+			RDKSSA_LOG_ERROR( "rdkssaMountFscrypt %s is encrypted with another key\n", path );
+			return rdkssaValidityError;
+		}
+		*had = 1;
+		return rdkssaOK;
+	}
+	if ( errno != ENODATA ) {
+		RDKSSA_LOG_ERROR( "rdkssaMountFscrypt %s get policy failed (%d)\n", path, errno );
+		return RDKSSA_PLATFORM_ERROR( errno );
+	}
+	/* not encrypted yet: the kernel only takes a policy on an empty directory (ENOTEMPTY) */
+	memset( &policy, 0, sizeof( policy ) );
+	policy.version = FSCRYPT_POLICY_V2;
+	policy.contents_encryption_mode = FSCRYPT_MODE_AES_256_XTS;
+	policy.filenames_encryption_mode = FSCRYPT_MODE_AES_256_CTS;
+	policy.flags = FSCRYPT_POLICY_FLAGS_PAD_32;
+	memcpy( policy.master_key_identifier, identifier, FSCRYPT_KEY_IDENTIFIER_SIZE );
+	if ( ioctl( dirFd, FS_IOC_SET_ENCRYPTION_POLICY, &policy ) != 0 ) {
+		RDKSSA_LOG_ERROR( "rdkssaMountFscrypt %s set policy failed (%d)\n", path, errno );
+		return RDKSSA_PLATFORM_ERROR( errno );
+	}
+	RDKSSA_LOG_INFO( "rdkssaMountFscrypt %s encrypted\n", path );
+	return rdkssaOK;
+}
+
+rdkssaStatus_t rdkssaMountFscrypt( const char *mountPoint, const char *path, const uint8_t *key, size_t keyLen ) {
+	uint8_t identifier[FSCRYPT_KEY_IDENTIFIER_SIZE];
+	rdkssaStatus_t iRetAtr;
+	int dirFd, err, had;
+
+	if ( mountPoint == NULL || path == NULL || key == NULL ) {
+		return rdkssaBadPointer;
+	}
+	/* AES-256-XTS takes the whole 64 bytes; anything shorter would be a weaker key than asked for */
+	if ( keyLen != FSCRYPT_MAX_KEY_SIZE ) {
+		RDKSSA_LOG_ERROR( "rdkssaMountFscrypt key must be %d bytes\n", FSCRYPT_MAX_KEY_SIZE );
+		return rdkssaBadLength;
+	}
+	if ( ( err = fscryptMkdir( path ) ) != 0 ) {
+		RDKSSA_LOG_ERROR( "rdkssaMountFscrypt mkdir %s failed (%d)\n", path, err );
+		return RDKSSA_PLATFORM_ERROR( err );
+	}
+	if ( ( dirFd = open( path, O_RDONLY | O_DIRECTORY | O_CLOEXEC ) ) < 0 ) {
+		RDKSSA_LOG_ERROR( "rdkssaMountFscrypt open %s failed (%d)\n", path, errno );
+		return RDKSSA_PLATFORM_ERROR( errno );
+	}
+	if ( ( err = fscryptAddKey( dirFd, key, keyLen, identifier ) ) != 0 ) {
+		close( dirFd );
+		RDKSSA_LOG_ERROR( "rdkssaMountFscrypt add key for %s failed (%d)\n", path, err );
+		return RDKSSA_PLATFORM_ERROR( err );
+	}
+	iRetAtr = fscryptPolicy( dirFd, path, identifier, &had );
+	if ( iRetAtr == rdkssaOK && ( err = fscryptMkdir( mountPoint ) ) != 0 ) {
+		RDKSSA_LOG_ERROR( "rdkssaMountFscrypt mkdir %s failed (%d)\n", mountPoint, err );
+		iRetAtr = RDKSSA_PLATFORM_ERROR( err );
+	} else if ( iRetAtr == rdkssaOK && mount( path, mountPoint, NULL, MS_BIND, NULL ) != 0 ) {
+		RDKSSA_LOG_ERROR( "rdkssaMountFscrypt bind %s on %s failed (%d)\n", path, mountPoint, errno );
+		iRetAtr = RDKSSA_PLATFORM_ERROR( errno );
+	}
+	/* a PATH that had the policy may be in use with the key elsewhere: leave the key to it */
+	if ( iRetAtr != rdkssaOK && !had ) {
+		fscryptRemoveKey( dirFd, path, identifier );
+	}
+	close( dirFd );
+	if ( iRetAtr == rdkssaOK ) {
+		RDKSSA_LOG_INFO( "rdkssaMountFscrypt %s mounted\n", mountPoint );
+	}
+	return iRetAtr;
+}
+
+int rdkssaMountFscryptIsMounted( const char *mountPoint, const char *path ) {
+	struct stat mpStat, pathStat;
+	int mounted;
+
+	if ( rdkssaMountInfoIsMounted( mountPoint, NULL, &mounted ) != rdkssaOK || !mounted ) {
+		return 0;
+	}
+	/* something is mounted there: it is PATH if the mountpoint now shows PATH's directory */
+	if ( stat( mountPoint, &mpStat ) != 0 || stat( path, &pathStat ) != 0 ) {
+		return 0;
+	}
+	return mpStat.st_dev == pathStat.st_dev && mpStat.st_ino == pathStat.st_ino;
+}
+
+/**
+ * UNIT TESTS
+ */
+#ifdef UNIT_TESTS
+#include "./unit_tests.h"
+#include <stdlib.h>
+
+// STUB rdkssaMountInfoIsMounted - a plain scan, no escapes, good enough for the test paths
+rdkssaStatus_t rdkssaMountInfoIsMounted( const char *mountPoint, const char *source, int *mounted ) {
+	char line[1024], mp[512];
+	FILE *f = fopen( "/proc/self/mountinfo", "re" );
+
+	*mounted = 0;
+	if ( f == NULL ) { return rdkssaFileError; }
+	while ( fgets( line, sizeof( line ), f ) != NULL ) {
+		if ( sscanf( line, "%*s %*s %*s %*s %511s", mp ) == 1 && strcmp( mp, mountPoint ) == 0 ) {
+			*mounted = 1;
+		}
+	}
+	fclose( f );
+	return rdkssaOK;
+}
+// ut stubs -- these are shortened versions of real functions from helpers
+int rdkssaLogLevel = RDKSSA_LOG_LEVEL_DEFAULT;
+void *rdkssaSecAlloc( size_t size ) {
+	return calloc( 1, size );
+}
+void rdkssaSecFree( void *mem ) {
+	free( mem );
+}
+
+#define UTFS_DIR	"/tmp/ut_rdkssa_fscrypt"
+#define UTFS_IMG	UTFS_DIR "/fs.img"
+#define UTFS_FS		UTFS_DIR "/fs"
+#define UTFS_PATH	UTFS_FS "/secure"
+#define UTFS_MNT	UTFS_DIR "/mnt"
+
+static void ut_fscryptArgs( void );
+static int ut_fscryptSetup( void );
+static void ut_fscryptMount( void );
+static void ut_fscryptKeyId( const char *path, const uint8_t *key, uint8_t identifier[FSCRYPT_KEY_IDENTIFIER_SIZE] );
+static int ut_fscryptKeyStatus( const char *path, const uint8_t identifier[FSCRYPT_KEY_IDENTIFIER_SIZE] );
+
+int utmain_fscrypt( int argc, char *argv[] ) {
+	RDKSSA_LOG_UT("=== Unit tests MOUNT FSCRYPT begin ===\n");
+
+	ut_fscryptArgs( );
+	if ( ut_fscryptSetup( ) == 0 ) {
+		ut_fscryptMount( );
+	}
+	UTST0( system( "umount " UTFS_MNT " 2>/dev/null; umount " UTFS_FS " 2>/dev/null; rm -rf " UTFS_DIR ) );
+
+	RDKSSA_LOG_UT("=== Unit tests MOUNT FSCRYPT SUCCESS ===\n");
+	return 0;
+}
+
+int main( int argc, char *argv[] ) {
+	return utmain_fscrypt( argc, argv );
+}
+
+static void ut_fscryptArgs( void ) {
+	RDKSSA_LOG_UT("  fscrypt arguments expect 2 errors\n");
+	uint8_t key[FSCRYPT_MAX_KEY_SIZE] = { 0 };
+
+	UTST( rdkssaMountFscrypt( NULL, UTFS_PATH, key, sizeof( key ) ) == rdkssaBadPointer );
+	UTST( rdkssaMountFscrypt( UTFS_MNT, UTFS_PATH, NULL, sizeof( key ) ) == rdkssaBadPointer );
+	UTST( rdkssaMountFscrypt( UTFS_MNT, UTFS_PATH, key, 32 ) == rdkssaBadLength );
+	UTST( rdkssaMountFscrypt( UTFS_MNT, "/proc/self/no/such/dir", key, sizeof( key ) ) == RDKSSA_PLATFORM_ERROR( ENOENT ) );
+	UTST( !rdkssaMountFscryptIsMounted( UTFS_MNT, UTFS_PATH ) );
+}
+
+// an ext4 filesystem with the encrypt feature on a loop device, or nonzero if this host can't have one
+static int ut_fscryptSetup( void ) {
+	UTST0( system( "umount " UTFS_MNT " " UTFS_FS " 2>/dev/null; rm -rf " UTFS_DIR "; mkdir -p " UTFS_FS ) );
+	if ( geteuid( ) != 0 ||
+		 system( "truncate -s 16M " UTFS_IMG " && mkfs.ext4 -q -O encrypt " UTFS_IMG " 2>/dev/null" ) != 0 ||
+		 system( "mount -o loop " UTFS_IMG " " UTFS_FS " 2>/dev/null" ) != 0 ) {
+		RDKSSA_LOG_UT("  fscrypt mount SKIPPED: needs root, mkfs.ext4 and loop devices\n");
+		return -1;
+	}
+	return 0;
+}
+
+// the identifier of key, which is left out of PATH's filesystem keyring
+static void ut_fscryptKeyId( const char *path, const uint8_t *key, uint8_t identifier[FSCRYPT_KEY_IDENTIFIER_SIZE] ) {
+	int dirFd;
+
+	UTST( ( dirFd = open( path, O_RDONLY | O_DIRECTORY | O_CLOEXEC ) ) >= 0 );
+	UTST0( fscryptAddKey( dirFd, key, FSCRYPT_MAX_KEY_SIZE, identifier ) );
+	fscryptRemoveKey( dirFd, path, identifier );
+	close( dirFd );
+}
+
+// FSCRYPT_KEY_STATUS_* of the key in PATH's filesystem keyring
+static int ut_fscryptKeyStatus( const char *path, const uint8_t identifier[FSCRYPT_KEY_IDENTIFIER_SIZE] ) {
+	struct fscrypt_get_key_status_arg status;
+	int dirFd;
+
+	memset( &status, 0, sizeof( status ) );
+	status.key_spec.type = FSCRYPT_KEY_SPEC_TYPE_IDENTIFIER;
+	memcpy( status.key_spec.u.identifier, identifier, FSCRYPT_KEY_IDENTIFIER_SIZE );
+	UTST( ( dirFd = open( path, O_RDONLY | O_DIRECTORY | O_CLOEXEC ) ) >= 0 );
+	UTST0( ioctl( dirFd, FS_IOC_GET_ENCRYPTION_KEY_STATUS, &status ) );
+	close( dirFd );
+	return status.status;
+}
+
+static void ut_fscryptMount( void ) {
+	RDKSSA_LOG_UT("  fscrypt mount expect 4 errors\n");
+	uint8_t key[FSCRYPT_MAX_KEY_SIZE], otherKey[FSCRYPT_MAX_KEY_SIZE], newKey[FSCRYPT_MAX_KEY_SIZE];
+	uint8_t id[FSCRYPT_KEY_IDENTIFIER_SIZE];
+	char buf[16] = { 0 };
+	FILE *f;
+	int i;
+
+	for ( i = 0; i < FSCRYPT_MAX_KEY_SIZE; i++ ) {
+		key[i] = (uint8_t)i;
+		otherKey[i] = (uint8_t)( 255 - i );
+		newKey[i] = (uint8_t)( 128 + i );
+	}
+	// first mount encrypts the new PATH
+	UTST( rdkssaMountFscrypt( UTFS_MNT, UTFS_PATH, key, sizeof( key ) ) == rdkssaOK );
+	UTST( rdkssaMountFscryptIsMounted( UTFS_MNT, UTFS_PATH ) );
+	UTST( !rdkssaMountFscryptIsMounted( UTFS_MNT, UTFS_FS ) );
+	UTST( ( f = fopen( UTFS_MNT "/file", "w" ) ) != NULL );
+	UTST( fputs( "plaintext", f ) >= 0 );
+	UTST0( fclose( f ) );
+	UTST0( umount( UTFS_MNT ) );
+	UTST( !rdkssaMountFscryptIsMounted( UTFS_MNT, UTFS_PATH ) );
+
+	// the same key again: the policy is kept and the file reads back
+	UTST( rdkssaMountFscrypt( UTFS_MNT, UTFS_PATH, key, sizeof( key ) ) == rdkssaOK );
+	UTST( ( f = fopen( UTFS_MNT "/file", "r" ) ) != NULL );
+	UTST( fgets( buf, sizeof( buf ), f ) != NULL );
+	UT_STRCMP( buf, "plaintext", 10 );
+	UTST0( fclose( f ) );
+	UTST0( umount( UTFS_MNT ) );
+
+	// another key is refused, and is not left in the keyring
+	ut_fscryptKeyId( UTFS_PATH, otherKey, id );
+	UTST( rdkssaMountFscrypt( UTFS_MNT, UTFS_PATH, otherKey, sizeof( otherKey ) ) == rdkssaValidityError );
+	UTST( ut_fscryptKeyStatus( UTFS_PATH, id ) == FSCRYPT_KEY_STATUS_ABSENT );
+
+	// a failed mount keeps the key of a PATH that had the policy, and takes back one it just set
+	ut_fscryptKeyId( UTFS_PATH, key, id );
+	UTST( rdkssaMountFscrypt( "/proc/self/no/such/dir", UTFS_PATH, key, sizeof( key ) ) == RDKSSA_PLATFORM_ERROR( ENOENT ) );
+	UTST( ut_fscryptKeyStatus( UTFS_PATH, id ) == FSCRYPT_KEY_STATUS_PRESENT );
+	ut_fscryptKeyId( UTFS_FS, newKey, id );
+	UTST( rdkssaMountFscrypt( "/proc/self/no/such/dir", UTFS_FS "/new", newKey, sizeof( newKey ) ) == RDKSSA_PLATFORM_ERROR( ENOENT ) );
+	UTST( ut_fscryptKeyStatus( UTFS_FS, id ) == FSCRYPT_KEY_STATUS_ABSENT );
+	UTST( rmdir( UTFS_FS "/new" ) == 0 );
+
+	// a non-empty unencrypted directory can't be encrypted
+	UTST0( system( "mkdir -p " UTFS_FS "/plain && touch " UTFS_FS "/plain/file" ) );
+	UTST( rdkssaMountFscrypt( UTFS_MNT, UTFS_FS "/plain", key, sizeof( key ) ) == RDKSSA_PLATFORM_ERROR( ENOTEMPTY ) );
+	UTST( !rdkssaMountFscryptIsMounted( UTFS_MNT, UTFS_PATH ) );
+}
+#endif
@@ -22,4 +22,27 @@
 
 /* Include definitions private to the generic mount provider implementation */
 
+#include <stddef.h>
+#include <stdint.h>
+#include "rdkssaProviderProtected.h"
+
+/**
+ * Key of one mount, opened once the volume is known to need mounting.  The helper backend streams it to
+ * the helper's stdin (mountWriteKeyCallback); it is not staged in a buffer of the provider's own.
+ */
+typedef enum {
+	mountKeyNone = 0,
+	mountKeyFile,			/* KEY=<file>: fd */
+	mountKeyStdin,			/* KEY=STDIN: the stdin stream, read with its lock held */
+	mountKeyMemory			/* KEY=HANDLE: the keyring's bytes, pinned by ref */
+} mount_key_type_t;
+
+typedef struct {
+	mount_key_type_t type;
+	int fd;
+	const uint8_t *mem;
+	size_t memLen;
+	rdkssaKeyringRef_t *ref;
+} mount_key_t;
+
 #endif
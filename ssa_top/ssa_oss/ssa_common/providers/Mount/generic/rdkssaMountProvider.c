@@ -16,8 +16,17 @@
  * SPDX-License-Identifier: Apache-2.0
 */
 
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mount.h>
+#include <sys/stat.h>
+
 #include "rdkssa.h"
 #include "rdkssaCommonProtected.h"
+#include "rdkssaProviderProtected.h"
+#include "rdkssaMountProtected.h"
 #include "rdkssaMountProvider.h"
 #include "rdkssaMountProviderPrivate.h"
 #include "safec_lib.h"
@@ -25,54 +34,65 @@
  * Forward declarations for individual handlers for each attrib
  */
 
-static inline rdkssaStatus_t rdkssaMountMountpoint(rdkssa_blobptr_t, const char *);
-static inline rdkssaStatus_t rdkssaMountPath(rdkssa_blobptr_t, const char *);
-static rdkssaStatus_t rdkssaMountKey(rdkssa_blobptr_t, const char *);
-static inline rdkssaStatus_t rdkssaMountPartition(rdkssa_blobptr_t, const char *);
+static inline rdkssaStatus_t rdkssaMountMountpoint(rdkssa_blobptr_t, const rdkssaAttrView_t *);
+static inline rdkssaStatus_t rdkssaMountPath(rdkssa_blobptr_t, const rdkssaAttrView_t *);
+static rdkssaStatus_t rdkssaMountKey(rdkssa_blobptr_t, const rdkssaAttrView_t *);
+static inline rdkssaStatus_t rdkssaMountPartition(rdkssa_blobptr_t, const rdkssaAttrView_t *);
+static rdkssaStatus_t rdkssaMountBackend(rdkssa_blobptr_t, const rdkssaAttrView_t *);
 
 /**
  * Declare stack-based structure that collects the input parameters
  * If a lot of similar declarations/definitions are needed, put them into ./private/rdkssaMountProviderPrivate.h
  */
 typedef struct {
-	char mountPoint[MAX_ATTRIBUTE_VALUE_LENGTH];
-	char mountPath[MAX_ATTRIBUTE_VALUE_LENGTH];
-	/* If reading file */
-	size_t  mountKeyActualSize;
-	uint8_t mountKey[MAX_ATTRIBUTE_VALUE_LENGTH];
-	/* If using a key handle, defined by contract with the SymKey provider or proprietary */
+	/* point into the caller's attribute vector, which outlives the API call */
+	const char *mountPoint;
+	const char *mountPath;
+	/* KEY= value, opened only once the volume is known to need mounting */
+	const char *keySource;
+	mount_key_t key;
+	/* If using a key handle, from rdkssaPutKeyringKey; or defined by contract with a proprietary provider */
 	rdkssa_handle_t keyHandle;
+	rdkssaMountBackend_t backend;
 } mount_param_t, *mount_param_ptr;
 
 
-// MOUNTPOINT = name the mountpoint.
-static rdkssaStatus_t rdkssaMountMountpoint(rdkssa_blobptr_t blobPtr, const char *valueStr) {
+// MOUNTPOINT = name the mountpoint. The value is used in place, not copied
+static rdkssaStatus_t rdkssaMountMountpoint(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
     RDKSSA_LOG_DEBUG( "    rdkssaMountMountpoint\n" );
 	mount_param_ptr pp = (mount_param_ptr)blobPtr;
-	errno_t rc = -1;
 
 	if ( pp == NULL ) { return rdkssaBadPointer;}
-	if ( rdkssaAttrCheck( valueStr ) == NULL ) { return rdkssaValidityError; } 
-	rc = strcpy_s( pp->mountPoint, sizeof(pp->mountPoint) , valueStr );
-	ERR_CHK(rc);
+	if ( rdkssaAttrViewCheck( view ) == NULL ) { return rdkssaValidityError; } 
+	pp->mountPoint = view->value;
 	return rdkssaOK;
 }
 
-// PATH = Name the path to the new dir
-static rdkssaStatus_t rdkssaMountPath(rdkssa_blobptr_t blobPtr, const char *valueStr) {
+// PATH = Name the path to the new dir. The value is used in place, not copied
+static rdkssaStatus_t rdkssaMountPath(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
     RDKSSA_LOG_DEBUG( "    rdkssaMountPath\n" );
 	mount_param_ptr pp = (mount_param_ptr)blobPtr;
-	errno_t rc = -1;
 
 	if ( pp == NULL ) { return rdkssaBadPointer;}
-	if ( rdkssaAttrCheck( valueStr ) == NULL ) { return rdkssaValidityError; } 
-	rc = strcpy_s( pp->mountPath, sizeof(pp->mountPath) , valueStr );
-	ERR_CHK(rc);
+	if ( rdkssaAttrViewCheck( view ) == NULL ) { return rdkssaValidityError; } 
+	pp->mountPath = view->value;
 	return rdkssaOK;	
 }
 
-//  KEY = fetch key
-static rdkssaStatus_t rdkssaMountKey(rdkssa_blobptr_t blobPtr, const char *valueStr) {
+// check a KEY= value, for rdkssaMount and rdkssaMountBatch
+static rdkssaStatus_t mountKeySource( const rdkssaAttrView_t *view, const char **keySource ) {
+	const char *valueStr = rdkssaAttrViewCheck( view );
+
+	if ( valueStr == NULL ) { 
+		RDKSSA_LOG_ERROR( "rdkssaMount KEY bad attribute\n" );
+		return rdkssaValidityError; 
+	} 
+	*keySource = valueStr;
+	return rdkssaOK;
+}
+
+//  KEY = name the key source. The value is used in place, the key itself is opened by mountKeyOpen
+static rdkssaStatus_t rdkssaMountKey(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
     RDKSSA_LOG_DEBUG( "    rdkssaMountKey\n" );
 	mount_param_ptr pp = (mount_param_ptr)blobPtr;
 
@@ -80,59 +100,160 @@ static rdkssaStatus_t rdkssaMountKey(rdkssa_blobptr_t blobPtr, const char *value
 		RDKSSA_LOG_ERROR( "rdkssaMount KEY NULL ptr\n" );
 		return rdkssaBadPointer;
 	}
-	if ( rdkssaAttrCheck( valueStr ) == NULL ) { 
-		RDKSSA_LOG_ERROR( "rdkssaMount KEY bad attribute\n" );
-		return rdkssaValidityError; 
-	} 
+	return mountKeySource( view, &pp->keySource );
+ }
 
-	FILE *keyfileh;
-	
-	if ( strncmp( valueStr, "HANDLE", strlen("HANDLE") ) == 0 ) {
-		/* this OSS provider doesn't yes support handling handle-based keys */
-		RDKSSA_LOG_ERROR( "rdkssaMount KEY=HANDLE not implemented\n" );
-		return rdkssaNYIError;
+// mountKeyOpen - open the key named by KEY=; nothing is read yet
+static rdkssaStatus_t mountKeyOpen( mount_param_ptr pp ) {
+	mount_key_t *key = &pp->key;
+	struct stat st;
+
+	/* a key handle names a key in the in-process keyring: use its bytes where they are */
+	if ( strncmp( pp->keySource, "HANDLE", strlen("HANDLE") ) == 0 ) {
+		if ( pp->keyHandle == NULL ) {
+			RDKSSA_LOG_ERROR( "rdkssaMount KEY=HANDLE without a key handle\n" );
+			return rdkssaBadPointer;
+		}
+		key->type = mountKeyMemory;
+		return rdkssaKeyringAcquire( pp->keyHandle, &key->ref, &key->mem, &key->memLen );
 	}
-	
 	/**
 	 * OSS version of provider assumes KEY= is a file name if not a HANDLE
 	 * Proprietary versions may treat the KEY= parameter differently
 	 * including any adding other key generation/derivation logic in 
 	 * this function.
 	 *
-	 * The exit condition is that if KEY= is specified, there is a key returned
-	 * in the mount parameters structure with non-zero length
+	 * The exit condition is that if KEY= is specified, there is a key source
+	 * in the mount parameters structure; a source that turns out to be empty
+	 * fails the mount when it is read
 	 *
 	 * Proprietary versions may defer key management to the main API logic
 	 */
-	if ( strncmp( valueStr, "STDIN", strlen("STDIN") ) == 0 ) {
-		keyfileh = stdin;
+	if ( strncmp( pp->keySource, "STDIN", strlen("STDIN") ) == 0 ) {
+		key->type = mountKeyStdin;
+		return rdkssaOK;
+	}
+	/* close-on-exec, so a helper started meanwhile by another thread does not inherit the key file */
+	key->fd = open( pp->keySource, O_RDONLY | O_CLOEXEC );
+	if ( key->fd < 0 ) {
+		RDKSSA_LOG_ERROR( "rdkssaMount KEY missing file\n" );
+		return rdkssaFileError;
+	}
+	key->type = mountKeyFile;
+	/* a plain file is checked now, before there is a helper to stop */
+	if ( fstat( key->fd, &st ) == 0 && S_ISREG( st.st_mode ) ) {
+		if ( st.st_size == 0 ) {
+			RDKSSA_LOG_ERROR( "rdkssaMount KEY empty file\n" );
+			return rdkssaFileError;
+		}
+		if ( st.st_size > RDKSSA_MOUNT_KEY_MAX ) {
+			RDKSSA_LOG_ERROR( "rdkssaMount KEY longer than %d bytes\n", RDKSSA_MOUNT_KEY_MAX );
+			return rdkssaBadLength;
+		}
+	}
+	return rdkssaOK;
+}
+
+// mountKeyClose - release what mountKeyOpen took
+static void mountKeyClose( mount_key_t *key ) {
+	if ( key->type == mountKeyFile && key->fd >= 0 ) {
+		close( key->fd );
+	} else if ( key->type == mountKeyMemory && key->ref != NULL ) {
+		rdkssaKeyringRelease( key->ref );
+	}
+	key->type = mountKeyNone;
+	key->fd = -1;
+	key->ref = NULL;
+}
+
+// copy stdin to fd, RDKSSA_MOUNT_KEY_MAX bytes at most, 0 or errno
+static int mountCopyStdin( int fd, size_t *copied ) {
+	uint8_t *chunk = rdkssaSecAlloc( RDKSSA_COPY_CHUNK );
+	size_t n, total = 0;
+	int err = 0;
+
+	*copied = 0;
+	if ( chunk == NULL ) {
+		return ENOMEM;
+	}
+	/* stdin is shared: holding its lock, one caller gets the whole key */
+	flockfile( stdin );
+	while ( total <= RDKSSA_MOUNT_KEY_MAX && ( n = fread( chunk, 1, RDKSSA_COPY_CHUNK, stdin ) ) > 0 ) {
+		total += n;
+		if ( rdkssaWriteAll( fd, chunk, n ) != 0 ) {
+			err = errno;
+			break;
+		}
+	}
+	funlockfile( stdin );
+	rdkssaSecFree( chunk );
+	if ( err == 0 && total > RDKSSA_MOUNT_KEY_MAX ) {
+		err = EFBIG;
+	}
+	*copied = total;
+	return err;
+}
+
+// mountKeyRead - read the whole key into buf, for a backend that needs it in memory
+static rdkssaStatus_t mountKeyRead( mount_key_t *key, uint8_t *buf, size_t size, size_t *len ) {
+	ssize_t n = 0;
+
+	*len = 0;
+	if ( key->type == mountKeyMemory ) {
+		if ( key->memLen > size ) {
+			return rdkssaBadLength;
+		}
+		memcpy( buf, key->mem, key->memLen );
+		*len = key->memLen;
+	} else if ( key->type == mountKeyStdin ) {
+		flockfile( stdin );
+		*len = fread( buf, 1, size, stdin );
+		funlockfile( stdin );
 	} else {
-		keyfileh = fopen( valueStr, "r" );
-		if ( keyfileh == NULL ) {
-			RDKSSA_LOG_ERROR( "rdkssaMount KEY missing file\n" );
-			return rdkssaFileError; 
+		while ( *len < size && ( ( n = read( key->fd, buf + *len, size - *len ) ) > 0 || ( n < 0 && errno == EINTR ) ) ) {
+			*len += ( n > 0 ) ? (size_t)n : 0;
 		}
-	}	   
-	
-	/* read the key bytes, up to max length, no validity check on key length except empty */
-	/* This version of OSS provider does not use the storage provider, just the file system */
-	if ( !( pp->mountKeyActualSize = fread( pp->mountKey, 1, MAX_ATTRIBUTE_VALUE_LENGTH, keyfileh ) ) ) {
-		if ( keyfileh != stdin ) { 
-			fclose( keyfileh ); 
+		if ( n < 0 ) {
+			RDKSSA_LOG_ERROR( "rdkssaMount KEY read failed (%d)\n", errno );
+			return rdkssaFileError;
 		}
-		RDKSSA_LOG_ERROR( "rdkssaMount KEY empty file\n" );
+	}
+	if ( *len == 0 ) {
+		RDKSSA_LOG_ERROR( "rdkssaMount KEY empty\n" );
 		return rdkssaFileError;
 	}
-	if ( keyfileh != stdin ) { fclose( keyfileh ); }	
 	return rdkssaOK;
-	
- }
+}
 
-static rdkssaStatus_t rdkssaMountPartition(rdkssa_blobptr_t blobPtr, const char *valueStr) {
+static rdkssaStatus_t rdkssaMountPartition(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
     RDKSSA_LOG_ERROR( "rdkssaMountPartition not implemented\n" );
     return rdkssaNYIError;
 }
 
+// check a BACKEND= value, for rdkssaMount and rdkssaMountBatch
+static rdkssaStatus_t mountBackend( const rdkssaAttrView_t *view, rdkssaMountBackend_t *backend ) {
+	const char *valueStr = rdkssaAttrViewCheck( view );
+
+	if ( valueStr != NULL && strcmp( valueStr, "HELPER" ) == 0 ) {
+		*backend = rdkssaMountBackendHelper;
+	} else if ( valueStr != NULL && strcmp( valueStr, "FSCRYPT" ) == 0 ) {
+		*backend = rdkssaMountBackendFscrypt;
+	} else {
+		RDKSSA_LOG_ERROR( "rdkssaMount BACKEND must be HELPER or FSCRYPT\n" );
+		return rdkssaValidityError;
+	}
+	return rdkssaOK;
+}
+
+// BACKEND = HELPER | FSCRYPT, what mounts the volume
+static rdkssaStatus_t rdkssaMountBackend(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
+    RDKSSA_LOG_DEBUG( "    rdkssaMountBackend\n" );
+	mount_param_ptr pp = (mount_param_ptr)blobPtr;
+
+	if ( pp == NULL ) { return rdkssaBadPointer;}
+	return mountBackend( view, &pp->backend );
+}
+
 
 /**
  * mountWriteKeyCallback
@@ -140,86 +261,612 @@ static rdkssaStatus_t rdkssaMountPartition(rdkssa_blobptr_t blobPtr, const char
  * This callback function is called by rdkssaExecvPipeOutput used to
  * pipe to a child function to avoid exposure of key material to user
  * file system. Function is in rdkssaProvierHelpers.
+ * The key is streamed from its source: a key file is spliced into the pipe.
  */
  
 static rdkssaStatus_t mountWriteKeyCallback( int fd, rdkssa_blobptr_t callerBlob)
 {
 		mount_param_ptr pp = (mount_param_ptr)callerBlob;
+		size_t sent = 0;
+		int err = 0;
 		
 		/* shouldn't be NULL but we are defensive*/
 		if ( pp == NULL ) {
 			RDKSSA_LOG_ERROR( "mountWriteKeyCallback NULL ptr\n" );
 			return rdkssaBadPointer;
 		}
-		/* We know there is a key because the parameters were checked for a 0-length key */
-		ssize_t rc = write( fd, pp->mountKey, pp->mountKeyActualSize );
-		if ( rc != pp->mountKeyActualSize ) {
-			RDKSSA_LOG_ERROR( "mountWriteKeyCallback write error\n" );
+		switch ( pp->key.type ) {
+		case mountKeyMemory:
+			err = ( rdkssaWriteAll( fd, pp->key.mem, pp->key.memLen ) == 0 ) ? 0 : errno;
+			sent = pp->key.memLen;
+			break;
+		case mountKeyFile:
+			err = ( rdkssaCopyFd( fd, pp->key.fd, RDKSSA_MOUNT_KEY_MAX, &sent ) == 0 ) ? 0 : errno;
+			break;
+		case mountKeyStdin:
+			err = mountCopyStdin( fd, &sent );
+			break;
+		default:
+			return rdkssaBadPointer;
+		}
+		if ( err == EFBIG ) {
+			RDKSSA_LOG_ERROR( "mountWriteKeyCallback key longer than %d bytes\n", RDKSSA_MOUNT_KEY_MAX );
+			return rdkssaBadLength;
+		}
+		if ( err != 0 ) {
+			RDKSSA_LOG_ERROR( "mountWriteKeyCallback write error (%d)\n", err );
 			return rdkssaFileError;			
 		}
+		/* the helper is stopped when the key turns out to be empty */
+		if ( sent == 0 ) {
+			RDKSSA_LOG_ERROR( "mountWriteKeyCallback empty key\n" );
+			return rdkssaFileError;
+		}
 		return rdkssaOK;
 }
 
 /**
- * API Entry points for Mount Provider supported API's
+ * Function pointers to specific handlers as/if needed for each identified attribute
  */
-RDKSSA_API( rdkssaMount )
+static const AttributeHandlerStruct mountHandlers[]= {
+    {"MOUNTPOINT", NULL, rdkssaMountMountpoint },
+    {"PATH", NULL, rdkssaMountPath },
+    {"KEY", NULL, rdkssaMountKey },
+    {"PARTITION", NULL, rdkssaMountPartition },	// nyi.
+    {"BACKEND", NULL, rdkssaMountBackend },
+	{ NULL, NULL }
+};
+static AttributeHandlerIndex mountHandlerIndex = RDKSSA_HANDLER_INDEX( mountHandlers );
+
+// mountParamInit - empty parameters, key handle from the caller's blob
+static void mountParamInit( mount_param_ptr pp, rdkssa_blobptr_t apiBlobPtr )
 {
-	mount_param_t mountParameters;
-	rdkssaStatus_t iRetAtr;
-	
-    /**
-     * Function pointers to specific handlers as/if needed for each identified attribute
-     */
-    static const AttributeHandlerStruct mountHandlers[]= {
-        {"MOUNTPOINT", rdkssaMountMountpoint },
-        {"PATH", rdkssaMountPath },
-        {"KEY", rdkssaMountKey },
-        {"PARTITION", rdkssaMountPartition },	// nyi.
-		{ NULL, NULL }
-    };	
-	
 	/* init the handle field */
 	if ( apiBlobPtr == NULL ) { 
-		mountParameters.keyHandle = NULL;
+		pp->keyHandle = NULL;
 	} else {
-		mountParameters.keyHandle = *( rdkssa_handle_t * )apiBlobPtr;
+		pp->keyHandle = *( rdkssa_handle_t * )apiBlobPtr;
 	}
+	/* no mountpoint or path yet (don't! use memset or initializers to do things like this */
+	pp->mountPoint = NULL;
+	pp->mountPath = NULL;
+	pp->keySource = NULL;
+	pp->key.type = mountKeyNone;
+	pp->key.fd = -1;
+	pp->key.mem = NULL;
+	pp->key.memLen = 0;
+	pp->key.ref = NULL;
+	pp->backend = RDKSSA_MOUNT_BACKEND;
+}
 
-	/* make empty strings (don't! use memset or initializers to do things like this */
-	mountParameters.mountPoint[0] = '\0';
-	mountParameters.mountPath[0] = '\0';
-	mountParameters.mountKeyActualSize = 0; /* 0 length means there is no key! */
-	/* Perform the operations defined by the attribute vector */
-	iRetAtr = rdkssaHandleAPIHelper((void*)&mountParameters, apiAttributes, mountHandlers );
-	if ( iRetAtr != rdkssaOK ) {
-		RDKSSA_LOG_ERROR( "rdkssaMount error in handler\n" );
-		return iRetAtr;
+// mount with the FSCRYPT backend, which needs the key itself
+static rdkssaStatus_t mountFscrypt( mount_param_ptr pp )
+{
+	/* one byte more than it takes, so a longer key is not mistaken for a good one */
+	const size_t keySize = RDKSSA_MOUNT_FSCRYPT_KEY_SIZE + 1;
+	uint8_t *keyBuf;
+	size_t keyLen;
+	rdkssaStatus_t iRetAtr;
+
+	if ( pp->key.type == mountKeyMemory ) {
+		return rdkssaMountFscrypt( pp->mountPoint, pp->mountPath, pp->key.mem, pp->key.memLen );
 	}
-	/* All input parameters have been processed, Note: HANDLE and PARTITION are unsupported for now */
-	if ( mountParameters.mountPoint[0] == '\0' || mountParameters.mountPath[0] == '\0' ) { 
+	if ( ( keyBuf = rdkssaSecAlloc( keySize ) ) == NULL ) {
+		return rdkssaGeneralFailure;
+	}
+	iRetAtr = mountKeyRead( &pp->key, keyBuf, keySize, &keyLen );
+	if ( iRetAtr == rdkssaOK ) {
+		iRetAtr = rdkssaMountFscrypt( pp->mountPoint, pp->mountPath, keyBuf, keyLen );
+	}
+	rdkssaSecFree( keyBuf );
+	return iRetAtr;
+}
+
+// mountExecute - mount once all attributes have been handled
+static rdkssaStatus_t mountExecute( mount_param_ptr pp )
+{
+	rdkssaStatus_t iRetAtr;
+	int mounted;
+
+	/* All input parameters have been processed, Note: PARTITION is unsupported for now */
+	if ( pp->mountPoint == NULL || pp->mountPath == NULL ) { 
 		RDKSSA_LOG_ERROR( "rdkssaMount missing required parameter(s)\n" );
 		return rdkssaMissingAttribute;
 	}
 	/* See if the OSS version has implemented ANY key management */
-	if ( mountParameters.mountKeyActualSize == 0 ) {
+	if ( pp->keySource == NULL ) {
 		RDKSSA_LOG_ERROR( "rdkssaMount key management not implemented\n" );	
 		/* Proprietary key management is required for this version of Mount Provider*/
 		return rdkssaNYIError;
 	}
-	/* All set: mountpoint, path, and key all exist. call exec with callback */
-	const char *mountArgv[ 4 ] = { "/usr/bin/ecfsMount" };
-	mountArgv[1] = mountParameters.mountPoint;
-	mountArgv[2] = mountParameters.mountPath;
-	iRetAtr = rdkssaExecvPipeOutput( mountArgv, (rdkssa_blobptr_t)&mountParameters,  mountWriteKeyCallback );
-	if ( iRetAtr != rdkssaOK ) {
-		RDKSSA_LOG_ERROR( "rdkssaMount exec failed\n" );	
+	/* nothing to do, and no key to read, if the volume is mounted already; if in doubt, let the backend decide */
+	if ( pp->backend == rdkssaMountBackendFscrypt ) {
+		/* a bind mount's source in mountinfo is the device, not PATH */
+		mounted = rdkssaMountFscryptIsMounted( pp->mountPoint, pp->mountPath );
+	} else if ( rdkssaMountInfoIsMounted( pp->mountPoint, pp->mountPath, &mounted ) != rdkssaOK ) {
+		mounted = 0;
+	}
+	if ( mounted ) {
+		RDKSSA_LOG_INFO( "rdkssaMount %s already mounted\n", pp->mountPoint );
+		return rdkssaAlreadyMounted;
+	}
+	if ( ( iRetAtr = mountKeyOpen( pp ) ) != rdkssaOK ) {
+		mountKeyClose( &pp->key );
+		return iRetAtr;
+	}
+	/* All set: mountpoint, path, and key all exist */
+	if ( pp->backend == rdkssaMountBackendFscrypt ) {
+		iRetAtr = mountFscrypt( pp );
+	} else {
+		/* call exec with callback */
+		const char *mountArgv[ 4 ] = { RDKSSA_MOUNT_HELPER };
+		mountArgv[1] = pp->mountPoint;
+		mountArgv[2] = pp->mountPath;
+		iRetAtr = rdkssaExecvPipeOutput( mountArgv, (rdkssa_blobptr_t)pp,  mountWriteKeyCallback );
+	}
+	mountKeyClose( &pp->key );
+	if ( iRetAtr > 0 ) {
+		/* the helper's exit status: 1 must not read as rdkssaAlreadyMounted */
+		RDKSSA_LOG_ERROR( "rdkssaMount helper exited with %d\n", iRetAtr );
+		iRetAtr = rdkssaGeneralFailure;
+	} else if ( iRetAtr != rdkssaOK ) {
+		RDKSSA_LOG_ERROR( "rdkssaMount %s failed\n", pp->backend == rdkssaMountBackendFscrypt ? "fscrypt" : "exec" );	
 	}
 	return iRetAtr;
 }
+
+/**
+ * Unmount: collect the volumes named by the attributes, then unmount them against one mount table snapshot
+ */
+typedef struct {
+	/* point into the caller's attribute vector, which outlives the API call */
+	const char *target[MAX_SUPPORTED_ATTRIBUTES];
+	uint8_t isSource[MAX_SUPPORTED_ATTRIBUTES];		/* PATH= rather than MOUNTPOINT= */
+	int count;
+	int flags;										/* umount2 flags */
+} unmount_param_t, *unmount_param_ptr;
+
+static rdkssaStatus_t unmountAddTarget( rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view, int isSource ) {
+	unmount_param_ptr up = (unmount_param_ptr)blobPtr;
+
+	if ( up == NULL ) { return rdkssaBadPointer;}
+	if ( rdkssaAttrViewCheck( view ) == NULL ) { return rdkssaValidityError; }
+	if ( up->count >= MAX_SUPPORTED_ATTRIBUTES ) { return rdkssaBadLength; }
+	up->target[up->count] = view->value;
+	up->isSource[up->count] = (uint8_t)isSource;
+	up->count++;
+	return rdkssaOK;
+}
+
+// MOUNTPOINT = a mountpoint to unmount. The value is used in place, not copied
+static rdkssaStatus_t rdkssaUnmountMountpoint(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
+    RDKSSA_LOG_DEBUG( "    rdkssaUnmountMountpoint\n" );
+	return unmountAddTarget( blobPtr, view, 0 );
+}
+
+// PATH = the path a volume was mounted from. The value is used in place, not copied
+static rdkssaStatus_t rdkssaUnmountPath(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
+    RDKSSA_LOG_DEBUG( "    rdkssaUnmountPath\n" );
+	return unmountAddTarget( blobPtr, view, 1 );
+}
+
+// LAZY = YES | NO
+static rdkssaStatus_t rdkssaUnmountLazy(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
+    RDKSSA_LOG_DEBUG( "    rdkssaUnmountLazy\n" );
+	unmount_param_ptr up = (unmount_param_ptr)blobPtr;
+	const char *valueStr = rdkssaAttrViewCheck( view );
+
+	if ( up == NULL ) { return rdkssaBadPointer;}
+	if ( valueStr == NULL ) { return rdkssaValidityError; }
+	if ( strcmp( valueStr, "YES" ) == 0 ) {
+		up->flags |= MNT_DETACH;
+	} else if ( strcmp( valueStr, "NO" ) == 0 ) {
+		up->flags &= ~MNT_DETACH;
+	} else {
+		RDKSSA_LOG_ERROR( "rdkssaUnmount LAZY must be YES or NO\n" );
+		return rdkssaValidityError;
+	}
+	return rdkssaOK;
+}
+
+static const AttributeHandlerStruct unmountHandlers[]= {
+    {"MOUNTPOINT", NULL, rdkssaUnmountMountpoint },
+    {"PATH", NULL, rdkssaUnmountPath },
+    {"LAZY", NULL, rdkssaUnmountLazy },
+	{ NULL, NULL }
+};
+static AttributeHandlerIndex unmountHandlerIndex = RDKSSA_HANDLER_INDEX( unmountHandlers );
+
+// unmount one mountpoint, through the helper process if there is one
+static rdkssaStatus_t unmountOne( const char *mountPoint, int flags )
+{
+	int err;
+
+	if ( rdkssaHelperUmount( mountPoint, flags, &err ) != 0 ) {
+		err = ( umount2( mountPoint, flags ) == 0 ) ? 0 : errno;
+	}
+	if ( err == 0 || err == EINVAL ) {	/* EINVAL: no longer a mountpoint, unmounted meanwhile */
+		RDKSSA_LOG_INFO( "rdkssaUnmount %s unmounted\n", mountPoint );
+		return rdkssaOK;
+	}
+	RDKSSA_LOG_ERROR( "rdkssaUnmount %s failed (%d)\n", mountPoint, err );
+	return RDKSSA_PLATFORM_ERROR( err );
+}
+
+// unmountExecute - unmount once all attributes have been handled
+static rdkssaStatus_t unmountExecute( unmount_param_ptr up )
+{
+	rdkssaMountInfo_t info;
+	const rdkssaMountEntry_t *e;
+	int order[MAX_SUPPORTED_ATTRIBUTES];
+	int n = 0, i, j, pos;
+	rdkssaStatus_t iRetAtr, iRetFirst = rdkssaOK;
+
+	if ( up->count == 0 ) {
+		RDKSSA_LOG_ERROR( "rdkssaUnmount missing MOUNTPOINT or PATH\n" );
+		return rdkssaMissingAttribute;
+	}
+	iRetAtr = rdkssaMountInfoLoad( &info );
+	if ( iRetAtr != rdkssaOK ) {
+		return iRetAtr;
+	}
+	/* find each volume; keep them in reverse mount order so nested volumes go first */
+	for ( i = 0; i < up->count; i++ ) {
+		e = up->isSource[i] ? rdkssaMountInfoFindSource( &info, up->target[i] ) : rdkssaMountInfoFind( &info, up->target[i] );
+		if ( e == NULL ) {
+			RDKSSA_LOG_INFO( "rdkssaUnmount %s not mounted\n", up->target[i] );
+			continue;
+		}
+		pos = (int)( e - info.entry );
+		for ( j = 0; j < n && order[j] != pos; j++ ) {}
+		if ( j < n ) {
+			continue;	/* named twice */
+		}
+		for ( j = n; j > 0 && order[j-1] < pos; j-- ) {
+			order[j] = order[j-1];
+		}
+		order[j] = pos;
+		n++;
+	}
+	for ( i = 0; i < n; i++ ) {
+		iRetAtr = unmountOne( info.entry[order[i]].mountPoint, up->flags );
+		if ( iRetAtr != rdkssaOK && iRetFirst == rdkssaOK ) {
+			iRetFirst = iRetAtr;
+		}
+	}
+	rdkssaMountInfoRelease( &info );
+	return iRetFirst;
+}
+
+/**
+ * Batch mount: collect several volumes, then mount them on up to WORKERS threads at once.
+ * A volume nested in another one of the batch waits for it, and is not mounted if that failed.
+ */
+typedef struct {
+	/* point into the caller's attribute vector, which outlives the API call */
+	const char *mountPoint;
+	const char *mountPath;
+	const char *keySource;
+	int parent;										/* batch volume mountPoint lies in, or -1 */
+} mount_batch_volume_t;
+
+typedef struct {
+	mount_batch_volume_t volume[MAX_SUPPORTED_ATTRIBUTES];
+	int count;
+	int workers;
+	int stdinKey;									/* KEY=STDIN given */
+	rdkssaMountBackend_t backend;					/* for all volumes */
+	/* while mounting */
+	pthread_mutex_t lock;
+	pthread_cond_t finishedCond;
+	int order[MAX_SUPPORTED_ATTRIBUTES];			/* volumes, parents first */
+	int next;										/* into order */
+	uint8_t finished[MAX_SUPPORTED_ATTRIBUTES];
+	rdkssaStatus_t result[MAX_SUPPORTED_ATTRIBUTES];
+} mount_batch_t, *mount_batch_ptr;
+
+// the volume that PATH= and KEY= apply to: the one the latest MOUNTPOINT= started
+static mount_batch_volume_t *mountBatchCurrent( rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view, const char *name ) {
+	mount_batch_ptr bp = (mount_batch_ptr)blobPtr;
+
+	if ( bp == NULL || rdkssaAttrViewCheck( view ) == NULL ) { return NULL; }
+	if ( bp->count == 0 ) {
+		RDKSSA_LOG_ERROR( "rdkssaMountBatch %s before the first MOUNTPOINT\n", name );
+		return NULL;
+	}
+	return &bp->volume[bp->count - 1];
+}
+
+// MOUNTPOINT = start the next volume. The value is used in place, not copied
+static rdkssaStatus_t rdkssaMountBatchMountpoint(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
+    RDKSSA_LOG_DEBUG( "    rdkssaMountBatchMountpoint\n" );
+	mount_batch_ptr bp = (mount_batch_ptr)blobPtr;
+	mount_batch_volume_t *vp;
+
+	if ( bp == NULL ) { return rdkssaBadPointer;}
+	if ( rdkssaAttrViewCheck( view ) == NULL ) { return rdkssaValidityError; }
+	if ( bp->count >= MAX_SUPPORTED_ATTRIBUTES ) { return rdkssaBadLength; }
+	vp = &bp->volume[bp->count++];
+	vp->mountPoint = view->value;
+	vp->mountPath = NULL;
+	vp->keySource = NULL;
+	vp->parent = -1;
+	return rdkssaOK;
+}
+
+// PATH = path of the current volume
+static rdkssaStatus_t rdkssaMountBatchPath(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
+    RDKSSA_LOG_DEBUG( "    rdkssaMountBatchPath\n" );
+	mount_batch_volume_t *vp = mountBatchCurrent( blobPtr, view, "PATH" );
+
+	if ( vp == NULL ) { return rdkssaValidityError; }
+	vp->mountPath = view->value;
+	return rdkssaOK;
+}
+
+// KEY = key source of the current volume, as for rdkssaMount
+static rdkssaStatus_t rdkssaMountBatchKey(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
+    RDKSSA_LOG_DEBUG( "    rdkssaMountBatchKey\n" );
+	mount_batch_ptr bp = (mount_batch_ptr)blobPtr;
+	mount_batch_volume_t *vp = mountBatchCurrent( blobPtr, view, "KEY" );
+	const char *keySource;
+	rdkssaStatus_t iRetAtr;
+
+	if ( vp == NULL ) { return rdkssaValidityError; }
+	if ( ( iRetAtr = mountKeySource( view, &keySource ) ) != rdkssaOK ) {
+		return iRetAtr;
+	}
+	if ( strncmp( keySource, "HANDLE", strlen("HANDLE") ) == 0 ) {
+		/* blobPtr carries the statuses, not a key handle */
+		RDKSSA_LOG_ERROR( "rdkssaMountBatch KEY=HANDLE not supported\n" );
+		return rdkssaNYIError;
+	}
+	if ( strncmp( keySource, "STDIN", strlen("STDIN") ) == 0 ) {
+		/* the volumes are mounted in no particular order, so which one would get what was read is undefined */
+		if ( bp->stdinKey ) {
+			RDKSSA_LOG_ERROR( "rdkssaMountBatch KEY=STDIN for more than one volume\n" );
+			return rdkssaValidityError;
+		}
+		bp->stdinKey = 1;
+	}
+	vp->keySource = keySource;
+	return rdkssaOK;
+}
+
+// WORKERS = how many volumes to mount at once
+static rdkssaStatus_t rdkssaMountBatchWorkers(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
+    RDKSSA_LOG_DEBUG( "    rdkssaMountBatchWorkers\n" );
+	mount_batch_ptr bp = (mount_batch_ptr)blobPtr;
+	const char *valueStr = rdkssaAttrViewCheck( view );
+	char *end;
+	long workers;
+
+	if ( bp == NULL ) { return rdkssaBadPointer;}
+	if ( valueStr == NULL ) { return rdkssaValidityError; }
+	workers = strtol( valueStr, &end, 10 );
+	if ( end == valueStr || *end != '\0' || workers < 1 || workers > RDKSSA_MOUNT_BATCH_MAX_WORKERS ) {
+		RDKSSA_LOG_ERROR( "rdkssaMountBatch WORKERS must be 1..%d\n", RDKSSA_MOUNT_BATCH_MAX_WORKERS );
+		return rdkssaValidityError;
+	}
+	bp->workers = (int)workers;
+	return rdkssaOK;
+}
+
+// BACKEND = HELPER | FSCRYPT, for all volumes of the batch
+static rdkssaStatus_t rdkssaMountBatchBackend(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
+    RDKSSA_LOG_DEBUG( "    rdkssaMountBatchBackend\n" );
+	mount_batch_ptr bp = (mount_batch_ptr)blobPtr;
+
+	if ( bp == NULL ) { return rdkssaBadPointer;}
+	return mountBackend( view, &bp->backend );
+}
+
+static const AttributeHandlerStruct mountBatchHandlers[]= {
+    {"MOUNTPOINT", NULL, rdkssaMountBatchMountpoint },
+    {"PATH", NULL, rdkssaMountBatchPath },
+    {"KEY", NULL, rdkssaMountBatchKey },
+    {"PARTITION", NULL, rdkssaMountPartition },	// nyi.
+    {"WORKERS", NULL, rdkssaMountBatchWorkers },
+    {"BACKEND", NULL, rdkssaMountBatchBackend },
+	{ NULL, NULL }
+};
+static AttributeHandlerIndex mountBatchHandlerIndex = RDKSSA_HANDLER_INDEX( mountBatchHandlers );
+
+// is path at or below dir
+static int mountBatchUnder( const char *path, const char *dir ) {
+	size_t len = strlen( dir );
+
+	while ( len > 1 && dir[len-1] == '/' ) { len--; }
+	if ( strncmp( path, dir, len ) != 0 ) { return 0; }
+	return path[len] == '\0' || path[len] == '/' || ( len == 1 && dir[0] == '/' );
+}
+
+// find each volume's parent in the batch and order the volumes parents first
+static void mountBatchPlan( mount_batch_ptr bp ) {
+	int depth[MAX_SUPPORTED_ATTRIBUTES];
+	const char *mp, *parentMp;
+	int i, j, best;
+
+	for ( i = 0; i < bp->count; i++ ) {
+		best = -1;
+		mp = bp->volume[i].mountPoint;
+		for ( j = 0; j < bp->count; j++ ) {
+			parentMp = bp->volume[j].mountPoint;
+			/* the same mountpoint twice: the later one stacks on the earlier one */
+			if ( j == i || ( j > i && mountBatchUnder( parentMp, mp ) ) ) {
+				continue;
+			}
+			if ( mountBatchUnder( mp, parentMp ) &&
+				 ( best < 0 || strlen( parentMp ) >= strlen( bp->volume[best].mountPoint ) ) ) {
+				best = j;
+			}
+		}
+		bp->volume[i].parent = best;
+	}
+	for ( i = 0; i < bp->count; i++ ) {
+		depth[i] = 0;
+		for ( j = bp->volume[i].parent; j >= 0; j = bp->volume[j].parent ) { depth[i]++; }
+		/* stable insertion by depth */
+		for ( j = i; j > 0 && depth[bp->order[j-1]] > depth[i]; j-- ) {
+			bp->order[j] = bp->order[j-1];
+		}
+		bp->order[j] = i;
+	}
+}
+
+// mount one volume of the batch
+static rdkssaStatus_t mountBatchOne( mount_batch_ptr bp, const mount_batch_volume_t *vp ) {
+	mount_param_t mp;
+
+	mountParamInit( &mp, NULL );
+	mp.mountPoint = vp->mountPoint;
+	mp.mountPath = vp->mountPath;
+	mp.keySource = vp->keySource;
+	mp.backend = bp->backend;
+	return mountExecute( &mp );
+}
+
+// take volumes in order until none are left; the caller's thread is one of the workers
+static void *mountBatchWorker( void *arg ) {
+	mount_batch_ptr bp = (mount_batch_ptr)arg;
+	rdkssaStatus_t iRetAtr;
+	int v, parent;
+
+	pthread_mutex_lock( &bp->lock );
+	while ( bp->next < bp->count ) {
+		v = bp->order[bp->next++];
+		/* the parent was taken earlier, so it is being mounted or done */
+		parent = bp->volume[v].parent;
+		while ( parent >= 0 && !bp->finished[parent] ) {
+			pthread_cond_wait( &bp->finishedCond, &bp->lock );
+		}
+		if ( parent >= 0 && !RDKSSA_SUCCESS( bp->result[parent] ) ) {
+			RDKSSA_LOG_ERROR( "rdkssaMountBatch %s skipped, %s not mounted\n", bp->volume[v].mountPoint,
+							  bp->volume[parent].mountPoint );
+			iRetAtr = rdkssaGeneralFailure;
+		} else {
+			pthread_mutex_unlock( &bp->lock );
+			iRetAtr = mountBatchOne( bp, &bp->volume[v] );
+			pthread_mutex_lock( &bp->lock );
+		}
+		bp->result[v] = iRetAtr;
+		bp->finished[v] = 1;
+		pthread_cond_broadcast( &bp->finishedCond );
+	}
+	pthread_mutex_unlock( &bp->lock );
+	return NULL;
+}
+
+// mountBatchExecute - mount once all attributes have been handled
+static rdkssaStatus_t mountBatchExecute( mount_batch_ptr bp, rdkssaStatus_t *status )
+{
+	pthread_t tid[RDKSSA_MOUNT_BATCH_MAX_WORKERS];
+	int i, started = 0;
+	rdkssaStatus_t iRetFirst = rdkssaOK;
+
+	if ( bp->count == 0 ) {
+		RDKSSA_LOG_ERROR( "rdkssaMountBatch missing MOUNTPOINT\n" );
+		return rdkssaMissingAttribute;
+	}
+	mountBatchPlan( bp );
+	pthread_mutex_init( &bp->lock, NULL );
+	pthread_cond_init( &bp->finishedCond, NULL );
+	bp->next = 0;
+	for ( i = 0; i < bp->count; i++ ) {
+		bp->finished[i] = 0;
+	}
+	if ( bp->workers > bp->count ) {
+		bp->workers = bp->count;
+	}
+	/* fewer threads than asked for if they can't be had; the caller's thread always works */
+	while ( started < bp->workers - 1 && pthread_create( &tid[started], NULL, mountBatchWorker, bp ) == 0 ) {
+		started++;
+	}
+	mountBatchWorker( bp );
+	for ( i = 0; i < started; i++ ) {
+		pthread_join( tid[i], NULL );
+	}
+	pthread_cond_destroy( &bp->finishedCond );
+	pthread_mutex_destroy( &bp->lock );
+
+	for ( i = 0; i < bp->count; i++ ) {
+		if ( status != NULL ) {
+			status[i] = bp->result[i];
+		}
+		if ( !RDKSSA_SUCCESS( bp->result[i] ) && iRetFirst == rdkssaOK ) {
+			iRetFirst = bp->result[i];
+		}
+	}
+	return iRetFirst;
+}
+
+/**
+ * API Entry points for Mount Provider supported API's
+ */
+RDKSSA_API( rdkssaMount )
+{
+	mount_param_t mountParameters;
+	rdkssaStatus_t iRetAtr;
+
+	mountParamInit( &mountParameters, apiBlobPtr );
+	/* Perform the operations defined by the attribute vector */
+	iRetAtr = rdkssaHandleAPIIndexedHelper((void*)&mountParameters, apiAttributes, &mountHandlerIndex );
+	if ( iRetAtr != rdkssaOK ) {
+		RDKSSA_LOG_ERROR( "rdkssaMount error in handler\n" );
+		return iRetAtr;
+	}
+	return mountExecute( &mountParameters );
+}
+
+RDKSSA_PREPARE_API( rdkssaMount )
+{
+	return rdkssaPrepareAPIHelper( apiAttributes, &mountHandlerIndex, preparedCall );
+}
+
+RDKSSA_EXECUTE_API( rdkssaMount )
+{
+	mount_param_t mountParameters;
+	rdkssaStatus_t iRetAtr;
+
+	mountParamInit( &mountParameters, apiBlobPtr );
+	iRetAtr = rdkssaExecutePreparedHelper( (void*)&mountParameters, preparedCall, &mountHandlerIndex );
+	if ( iRetAtr != rdkssaOK ) {
+		RDKSSA_LOG_ERROR( "rdkssaMount error in handler\n" );
+		return iRetAtr;
+	}
+	return mountExecute( &mountParameters );
+}
+
+RDKSSA_API( rdkssaMountBatch )
+{
+	mount_batch_t batch;
+	rdkssaStatus_t iRetAtr;
+
+	batch.count = 0;
+	batch.workers = RDKSSA_MOUNT_BATCH_WORKERS;
+	batch.stdinKey = 0;
+	batch.backend = RDKSSA_MOUNT_BACKEND;
+	iRetAtr = rdkssaHandleAPIIndexedHelper( (void*)&batch, apiAttributes, &mountBatchHandlerIndex );
+	if ( iRetAtr != rdkssaOK ) {
+		RDKSSA_LOG_ERROR( "rdkssaMountBatch error in handler\n" );
+		return iRetAtr;
+	}
+	return mountBatchExecute( &batch, (rdkssaStatus_t *)apiBlobPtr );
+}
+
 RDKSSA_API( rdkssaUnmount )
 {
-	return rdkssaNYIError;
+	unmount_param_t unmountParameters;
+	rdkssaStatus_t iRetAtr;
+
+	unmountParameters.count = 0;
+	unmountParameters.flags = 0;
+	iRetAtr = rdkssaHandleAPIIndexedHelper( (void*)&unmountParameters, apiAttributes, &unmountHandlerIndex );
+	if ( iRetAtr != rdkssaOK ) {
+		RDKSSA_LOG_ERROR( "rdkssaUnmount error in handler\n" );
+		return iRetAtr;
+	}
+	return unmountExecute( &unmountParameters );
 }
 
 
@@ -227,24 +874,155 @@ RDKSSA_API( rdkssaUnmount )
 /**
  * See template for an example
  */
-#if defined( UNIT_TESTS ) || defined( PLTFORM_TEST )
+#if defined( UNIT_TESTS ) || defined( PLTFORM_TEST ) || defined( MOUNT_STRESS_TEST ) || defined( MOUNT_BENCH )
 #include "./unit_tests.h"
-#endif // needed for both UNIT_TESTS and PLTFORM_TEST
+#endif // needed for UNIT_TESTS, PLTFORM_TEST, MOUNT_STRESS_TEST and MOUNT_BENCH
 
 #ifdef UNIT_TESTS
-// STUB rdkssaHandleAPIHelper - do nothing
-rdkssaStatus_t rdkssaHandleAPIHelper( rdkssa_blobptr_t apiBlobPtr, const char *const attributes[], const AttributeHandlerStruct attributeTable[]) {
-    RDKSSA_LOG_UT("rdkssaHandleAPIHelper STUBBED OUT\n" );
+// STUB rdkssaHandleAPIIndexedHelper - just enough of the real one: split NAME=value, call the view handler
+rdkssaStatus_t rdkssaHandleAPIIndexedHelper( rdkssa_blobptr_t apiBlobPtr, const char *const attributes[], AttributeHandlerIndex *attributeIndex) {
+    const AttributeHandlerStruct *h;
+    rdkssaAttrView_t view;
+    rdkssaStatus_t ret;
+    const char *eq;
+    int i;
+
+    for ( i = 0; attributes[i] != NULL; i++ ) {
+        if ( ( eq = strchr( attributes[i], '=' ) ) == NULL ) return rdkssaSyntaxError;
+        view.name = attributes[i];
+        view.nameLen = (size_t)( eq - attributes[i] );
+        view.value = eq + 1;
+        view.valueLen = strlen( eq + 1 );
+        view.flags = 0;
+        for ( h = attributeIndex->attributeTable; h->attributeNameStr != NULL; h++ ) {
+            if ( strlen( h->attributeNameStr ) == view.nameLen && strncmp( h->attributeNameStr, view.name, view.nameLen ) == 0 ) break;
+        }
+        if ( h->attributeNameStr == NULL ) return rdkssaAttributeNotFound;
+        if ( ( ret = h->attributeViewOperation( apiBlobPtr, &view ) ) != rdkssaOK ) return ret;
+    }
+    return rdkssaOK;
+}
+rdkssaStatus_t rdkssaPrepareAPIHelper( const char * const attributes[], AttributeHandlerIndex *attributeIndex, rdkssa_handle_t *preparedCall ) {
+    RDKSSA_LOG_UT("rdkssaPrepareAPIHelper STUBBED OUT\n" );
+    return rdkssaOK;
+}
+rdkssaStatus_t rdkssaExecutePreparedHelper( rdkssa_blobptr_t apiBlobPtr, rdkssa_handle_t preparedCall, AttributeHandlerIndex *attributeIndex ) {
+    RDKSSA_LOG_UT("rdkssaExecutePreparedHelper STUBBED OUT\n" );
     return rdkssaOK;
 }
+
+// STUB exec: records what the helper would have been given, key included, and returns utExecStatus
+// (or utExecFailStatus for the mountpoint utExecFailOn)
+static pthread_mutex_t utExecLock = PTHREAD_MUTEX_INITIALIZER;
+static int utExecCalls;
+static int utExecStatus;
+static const char *utExecFailOn;
+static int utExecFailStatus;
+static const char *utExecArgv[3];
+static const char *utExecOrder[MAX_SUPPORTED_ATTRIBUTES];
+static char utExecKey[RDKSSA_MOUNT_KEY_MAX + 1];
+static ssize_t utExecKeyLen;
 int rdkssaExecvPipeOutput(const char *argv[],rdkssa_blobptr_t callerBlob, rdkssaIOCallback callback ) {
-    RDKSSA_LOG_DEBUG("rdkssaExecvPipeOutput\n" );
+    int fds[2], ret;
+    ssize_t n;
+
+    UTST0( pipe( fds ) );
+    ret = callback( fds[1], callerBlob );
+    close( fds[1] );
+    pthread_mutex_lock( &utExecLock );
+    utExecKeyLen = 0;
+    while ( ( n = read( fds[0], utExecKey + utExecKeyLen, sizeof( utExecKey ) - utExecKeyLen ) ) > 0 ) {
+        utExecKeyLen += n;
+    }
+    close( fds[0] );
+    memcpy( utExecArgv, argv, sizeof( utExecArgv ) );
+    if ( utExecCalls < MAX_SUPPORTED_ATTRIBUTES ) {
+        utExecOrder[utExecCalls] = argv[1];
+    }
+    utExecCalls++;
+    if ( ret == rdkssaOK ) {
+        ret = ( utExecFailOn != NULL && strcmp( argv[1], utExecFailOn ) == 0 ) ? utExecFailStatus : utExecStatus;
+    }
+    pthread_mutex_unlock( &utExecLock );
+    return ret;
+}
+int rdkssaWriteAll( int fd, const void *buf, size_t len ) {
+    return ( write( fd, buf, len ) == (ssize_t)len ) ? 0 : -1;
+}
+int rdkssaCopyFd( int outFd, int inFd, size_t limit, size_t *copied ) {
+    char chunk[RDKSSA_COPY_CHUNK];
+    ssize_t n;
+
+    *copied = 0;
+    while ( *copied <= limit && ( n = read( inFd, chunk, sizeof( chunk ) ) ) > 0 ) {
+        *copied += (size_t)n;
+        if ( write( outFd, chunk, n ) != n ) return -1;
+    }
+    if ( *copied > limit ) { errno = EFBIG; return -1; }
+    return 0;
+}
+int rdkssaHelperUmount( const char *target, int flags, int *err ) {
+    return -1;
+}
+// STUB keyring: one key, handle UT_KEY_HANDLE
+#define UT_KEY_HANDLE   ((rdkssa_handle_t)(uintptr_t)0x1234)
+static const uint8_t utRingKey[] = "keyring-key";
+static int utRingRefs;
+rdkssaStatus_t rdkssaKeyringAcquire( rdkssa_handle_t keyHandle, rdkssaKeyringRef_t **ref, const uint8_t **key, size_t *keyLen ) {
+    if ( keyHandle != UT_KEY_HANDLE ) {
+        return rdkssaMissingSource;
+    }
+    *ref = (rdkssaKeyringRef_t *)utRingKey;
+    *key = utRingKey;
+    *keyLen = sizeof( utRingKey ) - 1;
+    utRingRefs++;
+    return rdkssaOK;
+}
+void rdkssaKeyringRelease( rdkssaKeyringRef_t *ref ) {
+    utRingRefs--;
+}
+// STUB fscrypt backend
+static int utFscryptCalls;
+static size_t utFscryptKeyLen;
+rdkssaStatus_t rdkssaMountFscrypt( const char *mountPoint, const char *path, const uint8_t *key, size_t keyLen ) {
+    utFscryptCalls++;
+    utFscryptKeyLen = keyLen;
+    return rdkssaOK;
+}
+// STUB mount table: utMounted says whether everything is mounted already
+static int utMounted;
+int rdkssaMountFscryptIsMounted( const char *mountPoint, const char *path ) {
+    return utMounted;
+}
+rdkssaStatus_t rdkssaMountInfoLoad( rdkssaMountInfo_t *info ) {
+    info->count = 0;
+    info->entry = NULL;
+    info->text = NULL;
+    return rdkssaOK;
+}
+void rdkssaMountInfoRelease( rdkssaMountInfo_t *info ) {
+}
+const rdkssaMountEntry_t *rdkssaMountInfoFind( const rdkssaMountInfo_t *info, const char *mountPoint ) {
+    return NULL;
+}
+const rdkssaMountEntry_t *rdkssaMountInfoFindSource( const rdkssaMountInfo_t *info, const char *source ) {
+    return NULL;
+}
+rdkssaStatus_t rdkssaMountInfoIsMounted( const char *mountPoint, const char *source, int *mounted ) {
+    *mounted = utMounted;
     return rdkssaOK;
 }
 // ut stubs -- these are shortened versions of real functions from helpers
+int rdkssaLogLevel = RDKSSA_LOG_LEVEL_DEFAULT;
 void rdkssa_memwipe( volatile void *mem, size_t sz ) {
     memset( (void *)mem, 0, sz );
 }
+void *rdkssaSecAlloc( size_t size ) {
+    return calloc( 1, size );
+}
+void rdkssaSecFree( void *mem ) {
+    free( mem );
+}
 void rdkssa_memfree(void **mem, size_t sz) {
     if(*mem) { free((void *)*mem); *mem=NULL;}
 }
@@ -254,18 +1032,308 @@ const char *rdkssaAttrCheck( const char *valueStr ) {
     if ( strpbrk(valueStr, RDKSSA_BADCHARS ) != NULL )  retStr = NULL;
     return retStr;
 }
+const char *rdkssaAttrViewCheck( const rdkssaAttrView_t *view ) {
+    if ( view == NULL || view->value == NULL ) return NULL;
+    return rdkssaAttrCheck( view->value );
+}
+
+#define UT_KEY_FILE     "/tmp/ut_rdkssa_mount_key"
+#define UT_EMPTY_FILE   "/tmp/ut_rdkssa_mount_empty"
+
+static void ut_mountHandlers( void );
+static void ut_mountExecute( void );
+static void ut_mountKeyHandle( void );
+static void ut_mountKeyStream( void );
+static void ut_mountBatch( void );
+static void ut_unmount( void );
+
 int utmain_mount(int argc, char *argv[]);
 int main(int argc, char *argv[] ) {
     return utmain_mount( argc, argv );
 }
 int utmain_mount(int argc, char *argv[] )
 {
+    FILE *f;
+
     RDKSSA_LOG_UT("=== Unit tests MOUNT begin ===\n");
-    RDKSSA_LOG_UT("=== Unit tests FAIL ===\n");	
-	return -1;
-    RDKSSA_LOG_UT("=== Unit tests STOR SUCCESS ===\n");
+    UTST( ( f = fopen( UT_KEY_FILE, "w" ) ) != NULL );
+    UTST( fputs( "ut-mount-key", f ) >= 0 );
+    UTST0( fclose( f ) );
+    UTST( ( f = fopen( UT_EMPTY_FILE, "w" ) ) != NULL );
+    UTST0( fclose( f ) );
+
+    ut_mountHandlers( );
+    ut_mountExecute( );
+    ut_mountKeyHandle( );
+    ut_mountKeyStream( );
+    ut_mountBatch( );
+    ut_unmount( );
+
+    remove( UT_KEY_FILE );
+    remove( UT_EMPTY_FILE );
+    RDKSSA_LOG_UT("=== Unit tests MOUNT SUCCESS ===\n");
     return 0;
 }
+
+// a view of "NAME=value", as the attribute helpers would pass it to a handler
+static const rdkssaAttrView_t *utView( rdkssaAttrView_t *view, const char *attribute ) {
+    const char *eq = strchr( attribute, '=' );
+
+    view->name = attribute;
+    view->nameLen = (size_t)( eq - attribute );
+    view->value = eq + 1;
+    view->valueLen = strlen( eq + 1 );
+    view->flags = 0;
+    return view;
+}
+
+static void ut_mountHandlers( void ) {
+    RDKSSA_LOG_UT("  mount handlers expect 5 errors\n");
+    rdkssaAttrView_t view;
+    mount_param_t mp;
+    unmount_param_t up;
+    rdkssa_handle_t handle = UT_KEY_HANDLE;
+
+    mountParamInit( &mp, NULL );
+    UTST( mp.keyHandle == NULL && mp.mountPoint == NULL && mp.keySource == NULL && mp.key.type == mountKeyNone );
+    UTST( mp.backend == RDKSSA_MOUNT_BACKEND );
+    mountParamInit( &mp, (rdkssa_blobptr_t)&handle );
+    UTST( mp.keyHandle == UT_KEY_HANDLE );
+
+    // values are used in place
+    UTST( rdkssaMountMountpoint( (rdkssa_blobptr_t)&mp, utView( &view, "MOUNTPOINT=/ut/mnt" ) ) == rdkssaOK );
+    UTST( mp.mountPoint == view.value );
+    UTST( rdkssaMountPath( (rdkssa_blobptr_t)&mp, utView( &view, "PATH=/ut/path" ) ) == rdkssaOK );
+    UTST( mp.mountPath == view.value );
+    UTST( rdkssaMountKey( (rdkssa_blobptr_t)&mp, utView( &view, "KEY=" UT_KEY_FILE ) ) == rdkssaOK );
+    UTST( mp.keySource == view.value && mp.key.type == mountKeyNone );
+    UTST( rdkssaMountBackend( (rdkssa_blobptr_t)&mp, utView( &view, "BACKEND=FSCRYPT" ) ) == rdkssaOK );
+    UTST( mp.backend == rdkssaMountBackendFscrypt );
+    UTST( rdkssaMountBackend( (rdkssa_blobptr_t)&mp, utView( &view, "BACKEND=HELPER" ) ) == rdkssaOK );
+    UTST( mp.backend == rdkssaMountBackendHelper );
+
+    UTST( rdkssaMountMountpoint( NULL, utView( &view, "MOUNTPOINT=/ut/mnt" ) ) == rdkssaBadPointer );
+    UTST( rdkssaMountPath( (rdkssa_blobptr_t)&mp, utView( &view, "PATH=/ut/$(path)" ) ) == rdkssaValidityError );
+    UTST( rdkssaMountKey( NULL, utView( &view, "KEY=" UT_KEY_FILE ) ) == rdkssaBadPointer );
+    UTST( rdkssaMountKey( (rdkssa_blobptr_t)&mp, utView( &view, "KEY=a|b" ) ) == rdkssaValidityError );
+    UTST( rdkssaMountBackend( (rdkssa_blobptr_t)&mp, utView( &view, "BACKEND=DMCRYPT" ) ) == rdkssaValidityError );
+    UTST( mp.backend == rdkssaMountBackendHelper );
+    UTST( rdkssaMountPartition( (rdkssa_blobptr_t)&mp, utView( &view, "PARTITION=1" ) ) == rdkssaNYIError );
+
+    up.count = 0;
+    up.flags = 0;
+    UTST( rdkssaUnmountLazy( (rdkssa_blobptr_t)&up, utView( &view, "LAZY=YES" ) ) == rdkssaOK );
+    UTST( up.flags == MNT_DETACH );
+    UTST( rdkssaUnmountLazy( (rdkssa_blobptr_t)&up, utView( &view, "LAZY=NO" ) ) == rdkssaOK );
+    UTST( up.flags == 0 );
+    UTST( rdkssaUnmountLazy( (rdkssa_blobptr_t)&up, utView( &view, "LAZY=MAYBE" ) ) == rdkssaValidityError );
+}
+
+static void ut_mountExecute( void ) {
+    RDKSSA_LOG_UT("  mount execute expect 8 errors\n");
+    const char * const noMountPoint[] = { "PATH=/ut/path", "KEY=" UT_KEY_FILE, NULL };
+    const char * const noKey[] = { "MOUNTPOINT=/ut/mnt", "PATH=/ut/path", NULL };
+    const char * const missingKey[] = { "MOUNTPOINT=/ut/mnt", "PATH=/ut/path", "KEY=/tmp/ut_rdkssa_no_such_key", NULL };
+    const char * const emptyKey[] = { "MOUNTPOINT=/ut/mnt", "PATH=/ut/path", "KEY=" UT_EMPTY_FILE, NULL };
+    const char * const keyFile[] = { "MOUNTPOINT=/ut/mnt", "PATH=/ut/path", "KEY=" UT_KEY_FILE, NULL };
+    const char * const fscrypt[] = { "MOUNTPOINT=/ut/mnt", "PATH=/ut/path", "KEY=" UT_KEY_FILE, "BACKEND=FSCRYPT", NULL };
+    const char * const unknown[] = { "MOUNTPOINT=/ut/mnt", "PATH=/ut/path", "SIZE=1", NULL };
+    int calls;
+
+    utMounted = 0;
+    utExecStatus = rdkssaOK;
+    UTST( rdkssaMount( NULL, noMountPoint ) == rdkssaMissingAttribute );
+    UTST( rdkssaMount( NULL, noKey ) == rdkssaNYIError );
+    UTST( rdkssaMount( NULL, missingKey ) == rdkssaFileError );
+    UTST( rdkssaMount( NULL, emptyKey ) == rdkssaFileError );
+    UTST( rdkssaMount( NULL, unknown ) == rdkssaAttributeNotFound );
+    UTST( utExecCalls == 0 );
+
+    // the helper gets MOUNTPOINT PATH, and the key file's bytes on its stdin
+    UTST( rdkssaMount( NULL, keyFile ) == rdkssaOK );
+    UTST( utExecCalls == 1 );
+    UT_STRCMP( utExecArgv[0], RDKSSA_MOUNT_HELPER, strlen( RDKSSA_MOUNT_HELPER ) + 1 );
+    UT_STRCMP( utExecArgv[1], "/ut/mnt", 8 );
+    UT_STRCMP( utExecArgv[2], "/ut/path", 9 );
+    UTST( utExecKeyLen == (ssize_t)strlen( "ut-mount-key" ) );
+    UTST( memcmp( utExecKey, "ut-mount-key", utExecKeyLen ) == 0 );
+
+    // a helper that fails is a failure, whatever its exit status; 1 is not rdkssaAlreadyMounted
+    utExecStatus = 3;
+    UTST( rdkssaMount( NULL, keyFile ) == rdkssaGeneralFailure );
+    utExecStatus = 1;
+    UTST( rdkssaMount( NULL, keyFile ) == rdkssaGeneralFailure );
+    utExecStatus = rdkssaGeneralFailure;        // killed by a signal, or could not be started
+    UTST( rdkssaMount( NULL, keyFile ) == rdkssaGeneralFailure );
+    utExecStatus = rdkssaOK;
+
+    // already mounted: neither the key nor the helper are needed
+    utMounted = 1;
+    calls = utExecCalls;
+    UTST( rdkssaMount( NULL, missingKey ) == rdkssaAlreadyMounted );
+    UTST( rdkssaMount( NULL, fscrypt ) == rdkssaAlreadyMounted );
+    UTST( utExecCalls == calls && utFscryptCalls == 0 );
+    utMounted = 0;
+
+    // BACKEND=FSCRYPT mounts in process
+    UTST( rdkssaMount( NULL, fscrypt ) == rdkssaOK );
+    UTST( utExecCalls == calls && utFscryptCalls == 1 );
+    UTST( utFscryptKeyLen == strlen( "ut-mount-key" ) );
+}
+
+static void ut_mountKeyHandle( void ) {
+    RDKSSA_LOG_UT("  mount key handle expect 2 errors\n");
+    const char * const byHandle[] = { "MOUNTPOINT=/ut/mnt", "PATH=/ut/path", "KEY=HANDLE", NULL };
+    rdkssa_handle_t handle = UT_KEY_HANDLE;
+    rdkssa_handle_t other = (rdkssa_handle_t)(uintptr_t)1;
+
+    // the keyring's bytes go to the helper, and the key is released afterwards
+    UTST( rdkssaMount( (rdkssa_blobptr_t)&handle, byHandle ) == rdkssaOK );
+    UTST( utExecKeyLen == (ssize_t)strlen( (const char *)utRingKey ) );
+    UTST( memcmp( utExecKey, utRingKey, utExecKeyLen ) == 0 );
+    UTST( utRingRefs == 0 );
+    utExecStatus = 5;
+    UTST( rdkssaMount( (rdkssa_blobptr_t)&handle, byHandle ) == rdkssaGeneralFailure );
+    UTST( utRingRefs == 0 );
+    utExecStatus = rdkssaOK;
+
+    UTST( rdkssaMount( NULL, byHandle ) == rdkssaBadPointer );
+    UTST( rdkssaMount( (rdkssa_blobptr_t)&other, byHandle ) == rdkssaMissingSource );
+}
+
+#define UT_BIG_KEY_FILE "/tmp/ut_rdkssa_mount_bigkey"
+// write a key file of len bytes, returns its bytes
+static const char *utKeyFile( const char *file, size_t len ) {
+    static char bytes[RDKSSA_MOUNT_KEY_MAX + 1];
+    FILE *f;
+    size_t i;
+
+    for ( i = 0; i < len; i++ ) {
+        bytes[i] = (char)( 'a' + i % 26 );
+    }
+    UTST( ( f = fopen( file, "w" ) ) != NULL );
+    UTST( fwrite( bytes, 1, len, f ) == len );
+    UTST0( fclose( f ) );
+    return bytes;
+}
+
+static void ut_mountKeyStream( void ) {
+    RDKSSA_LOG_UT("  mount key stream expect 3 errors\n");
+    const char * const bigKey[] = { "MOUNTPOINT=/ut/mnt", "PATH=/ut/path", "KEY=" UT_BIG_KEY_FILE, NULL };
+    const char * const stdinKey[] = { "MOUNTPOINT=/ut/mnt", "PATH=/ut/path", "KEY=STDIN", NULL };
+    const char * const fscrypt[] = { "MOUNTPOINT=/ut/mnt", "PATH=/ut/path", "KEY=" UT_BIG_KEY_FILE, "BACKEND=FSCRYPT", NULL };
+    const char *bytes;
+    int calls;
+
+    // longer than an attribute value, and the longest there may be: delivered whole
+    bytes = utKeyFile( UT_BIG_KEY_FILE, MAX_ATTRIBUTE_VALUE_LENGTH * 2 + 3 );
+    UTST( rdkssaMount( NULL, bigKey ) == rdkssaOK );
+    UTST( utExecKeyLen == MAX_ATTRIBUTE_VALUE_LENGTH * 2 + 3 );
+    UTST0( memcmp( utExecKey, bytes, utExecKeyLen ) );
+    bytes = utKeyFile( UT_BIG_KEY_FILE, RDKSSA_MOUNT_KEY_MAX );
+    UTST( rdkssaMount( NULL, bigKey ) == rdkssaOK );
+    UTST( utExecKeyLen == RDKSSA_MOUNT_KEY_MAX );
+    UTST0( memcmp( utExecKey, bytes, utExecKeyLen ) );
+
+    // one byte too long: refused before there is a helper
+    calls = utExecCalls;
+    utKeyFile( UT_BIG_KEY_FILE, RDKSSA_MOUNT_KEY_MAX + 1 );
+    UTST( rdkssaMount( NULL, bigKey ) == rdkssaBadLength );
+    UTST( utExecCalls == calls );
+
+    // the FSCRYPT backend reads the key, one byte more than it takes
+    utKeyFile( UT_BIG_KEY_FILE, RDKSSA_MOUNT_FSCRYPT_KEY_SIZE );
+    UTST( rdkssaMount( NULL, fscrypt ) == rdkssaOK );
+    UTST( utFscryptKeyLen == RDKSSA_MOUNT_FSCRYPT_KEY_SIZE );
+    utKeyFile( UT_BIG_KEY_FILE, RDKSSA_MOUNT_FSCRYPT_KEY_SIZE * 2 );
+    UTST( rdkssaMount( NULL, fscrypt ) == rdkssaOK );
+    UTST( utFscryptKeyLen == RDKSSA_MOUNT_FSCRYPT_KEY_SIZE + 1 );
+    remove( UT_BIG_KEY_FILE );
+
+    // KEY=STDIN: streamed; at EOF the empty key stops the helper
+    UTST( freopen( UT_KEY_FILE, "r", stdin ) != NULL );
+    UTST( rdkssaMount( NULL, stdinKey ) == rdkssaOK );
+    UTST( utExecKeyLen == (ssize_t)strlen( "ut-mount-key" ) );
+    UTST0( memcmp( utExecKey, "ut-mount-key", utExecKeyLen ) );
+    UTST( rdkssaMount( NULL, stdinKey ) == rdkssaFileError );
+}
+
+static void ut_mountBatch( void ) {
+    RDKSSA_LOG_UT("  mount batch expect 15 errors\n");
+    const char * const nested[] = { "WORKERS=1",
+        "MOUNTPOINT=/ut/a/b", "PATH=/ut/pab", "KEY=" UT_KEY_FILE,
+        "MOUNTPOINT=/ut/a", "PATH=/ut/pa", "KEY=" UT_KEY_FILE,
+        "MOUNTPOINT=/ut/c", "PATH=/ut/pc", "KEY=" UT_KEY_FILE,
+        "MOUNTPOINT=/ut/a/b/c", "PATH=/ut/pabc", "KEY=" UT_KEY_FILE,
+        "MOUNTPOINT=/ut/ab", "PATH=/ut/pab2", "KEY=" UT_KEY_FILE, NULL };
+    const char * const parallel[] = { "WORKERS=4",
+        "MOUNTPOINT=/ut/a", "PATH=/ut/pa", "KEY=" UT_KEY_FILE,
+        "MOUNTPOINT=/ut/b", "PATH=/ut/pb", "KEY=" UT_KEY_FILE,
+        "MOUNTPOINT=/ut/c", "PATH=/ut/pc", "KEY=" UT_KEY_FILE, "BACKEND=HELPER", NULL };
+    const char * const badWorkers[] = { "WORKERS=0", "MOUNTPOINT=/ut/a", NULL };
+    const char * const pathFirst[] = { "PATH=/ut/pa", "MOUNTPOINT=/ut/a", NULL };
+    const char * const twoStdin[] = { "MOUNTPOINT=/ut/a", "KEY=STDIN", "MOUNTPOINT=/ut/b", "KEY=STDIN", NULL };
+    const char * const byHandle[] = { "MOUNTPOINT=/ut/a", "KEY=HANDLE", NULL };
+    const char * const none[] = { "WORKERS=2", NULL };
+    rdkssaStatus_t status[5];
+    int calls;
+
+    // parents first, in the order given otherwise; /ut/ab is not inside /ut/a
+    calls = utExecCalls;
+    UTST( rdkssaMountBatch( (rdkssa_blobptr_t)status, nested ) == rdkssaOK );
+    UTST( utExecCalls == calls + 5 );
+    UT_STRCMP( utExecOrder[calls + 0], "/ut/a", 6 );
+    UT_STRCMP( utExecOrder[calls + 1], "/ut/c", 6 );
+    UT_STRCMP( utExecOrder[calls + 2], "/ut/ab", 7 );
+    UT_STRCMP( utExecOrder[calls + 3], "/ut/a/b", 8 );
+    UT_STRCMP( utExecOrder[calls + 4], "/ut/a/b/c", 10 );
+    UTST( status[0] == rdkssaOK && status[4] == rdkssaOK );
+
+    // a failed parent: its volumes are skipped, the others mounted, the first failure returned
+    utExecFailOn = "/ut/a/b";
+    utExecFailStatus = 7;
+    calls = utExecCalls;
+    UTST( rdkssaMountBatch( (rdkssa_blobptr_t)status, nested ) == rdkssaGeneralFailure );
+    UTST( utExecCalls == calls + 4 );
+    UTST( status[0] == rdkssaGeneralFailure && status[1] == rdkssaOK && status[2] == rdkssaOK );
+    UTST( status[3] == rdkssaGeneralFailure && status[4] == rdkssaOK );
+    // a helper exiting with 1, or killed, is not taken for an already mounted volume
+    utExecFailStatus = 1;
+    UTST( rdkssaMountBatch( (rdkssa_blobptr_t)status, nested ) == rdkssaGeneralFailure );
+    UTST( status[0] == rdkssaGeneralFailure && status[3] == rdkssaGeneralFailure );
+    utExecFailStatus = rdkssaGeneralFailure;
+    UTST( rdkssaMountBatch( (rdkssa_blobptr_t)status, nested ) == rdkssaGeneralFailure );
+    UTST( status[0] == rdkssaGeneralFailure && status[3] == rdkssaGeneralFailure );
+    utExecFailOn = NULL;
+
+    // several workers; already mounted counts as mounted
+    calls = utExecCalls;
+    UTST( rdkssaMountBatch( (rdkssa_blobptr_t)status, parallel ) == rdkssaOK );
+    UTST( utExecCalls == calls + 3 );
+    utMounted = 1;
+    UTST( rdkssaMountBatch( NULL, parallel ) == rdkssaOK );
+    UTST( rdkssaMountBatch( (rdkssa_blobptr_t)status, parallel ) == rdkssaOK );
+    UTST( status[0] == rdkssaAlreadyMounted && status[2] == rdkssaAlreadyMounted );
+    UTST( utExecCalls == calls + 3 );
+    utMounted = 0;
+
+    UTST( rdkssaMountBatch( NULL, badWorkers ) == rdkssaValidityError );
+    UTST( rdkssaMountBatch( NULL, pathFirst ) == rdkssaValidityError );
+    UTST( rdkssaMountBatch( NULL, twoStdin ) == rdkssaValidityError );
+    UTST( rdkssaMountBatch( NULL, byHandle ) == rdkssaNYIError );
+    UTST( rdkssaMountBatch( NULL, none ) == rdkssaMissingAttribute );
+}
+
+static void ut_unmount( void ) {
+    RDKSSA_LOG_UT("  unmount expect 3 errors\n");
+    const char * const none[] = { "LAZY=YES", NULL };
+    const char * const notMounted[] = { "MOUNTPOINT=/ut/mnt", "PATH=/ut/path", NULL };
+    const char * const badLazy[] = { "MOUNTPOINT=/ut/mnt", "LAZY=SOON", NULL };
+
+    UTST( rdkssaUnmount( NULL, notMounted ) == rdkssaOK );
+    UTST( rdkssaUnmount( NULL, none ) == rdkssaMissingAttribute );
+    UTST( rdkssaUnmount( NULL, badLazy ) == rdkssaValidityError );
+}
 #endif
 
 #ifdef PLTFORM_TEST
@@ -277,6 +1345,13 @@ int pltfrmmain(int argc, char *argv[] ) {
         "KEY=/etc/ecfs-mount-sample-dummy-key",
 	 NULL };
     UTST( rdkssaMount( NULL, attrtbl ) == rdkssaOK );
+    UTST( rdkssaMount( NULL, attrtbl ) == rdkssaAlreadyMounted );
+    const char * const unmounttbl[] = {
+        "MOUNTPOINT=/nvram/rdkssa",
+	 NULL };
+    UTST( rdkssaUnmount( NULL, unmounttbl ) == rdkssaOK );
+    UTST( rdkssaUnmount( NULL, unmounttbl ) == rdkssaOK );	/* not mounted any more: nothing to do */
+    UTST( rdkssaMount( NULL, attrtbl ) == rdkssaOK );
     RDKSSA_LOG_UT( "PLTFORM TEST SUCCESS\n" );
     return 0;
 }
@@ -286,3 +1361,517 @@ int main(int argc, char *argv[] ) {
 }
 #endif
 
+#ifdef MOUNT_STRESS_TEST
+/**
+ * Concurrent rdkssaMount calls through the real exec path, against a stub helper
+ * build with -DRDKSSA_MOUNT_HELPER='"<stub>"' (see the ssa_oss Makefile, target stressmount)
+ */
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#define STRESS_KEY_FILE     "/tmp/ut_rdkssa_stress_key"
+#define STRESS_ITER         (200)
+
+static const char * const stressAttrs[] = {
+    "MOUNTPOINT=/tmp/ut_rdkssa_stress_mnt",
+    "PATH=/tmp/ut_rdkssa_stress_path",
+    "KEY=" STRESS_KEY_FILE,
+    NULL };
+static int stressFailures;
+static int stressEnvStop;
+
+static void *stressWorker( void *arg ) {
+    int i, n = (int)(intptr_t)arg;
+    for ( i = 0; i < n; i++ ) {
+        if ( !RDKSSA_SUCCESS( rdkssaMount( NULL, stressAttrs ) ) ) {
+            __atomic_add_fetch( &stressFailures, 1, __ATOMIC_RELAXED );
+        }
+    }
+    return NULL;
+}
+
+// the application changing its environment meanwhile must not disturb helper launches
+static void *stressEnvChurn( void *arg ) {
+    char val[16];
+    int i = 0;
+    while ( !__atomic_load_n( &stressEnvStop, __ATOMIC_RELAXED ) ) {
+        snprintf( val, sizeof(val), "%d", i++ );
+        setenv( "RDKSSA_STRESS_CHURN", val, 1 );
+        unsetenv( "RDKSSA_STRESS_CHURN" );
+    }
+    return NULL;
+}
+
+// tear down a set of volumes, nested and not mounted ones included, with one call
+#define UNMOUNT_VOLUMES     (16)
+#define UNMOUNT_DIR         "/tmp/ut_rdkssa_um"
+static void stressUnmount( void ) {
+    char attrBuf[UNMOUNT_VOLUMES+2][64];
+    const char *attrs[UNMOUNT_VOLUMES+4];
+    rdkssaMountInfo_t info;
+    uint64_t t0, tMounted, tIdle;
+    int i, n = 0, fd;
+
+    RDKSSA_LOG_UT( "  unmount\n" );
+    for ( i = 0; i < UNMOUNT_VOLUMES; i++ ) {
+        snprintf( attrBuf[i], sizeof(attrBuf[i]), "MOUNTPOINT=" UNMOUNT_DIR "%d", i );
+        mkdir( attrBuf[i] + strlen("MOUNTPOINT="), 0700 );
+        if ( mount( "tmpfs", attrBuf[i] + strlen("MOUNTPOINT="), "tmpfs", 0, NULL ) != 0 ) {
+            RDKSSA_LOG_UT( "  unmount skipped, can't mount tmpfs (%d)\n", errno );
+            while ( i-- > 0 ) umount( attrBuf[i] + strlen("MOUNTPOINT=") );
+            return;
+        }
+        attrs[n++] = attrBuf[i];
+    }
+    // nested in the first one, named last: must still go first
+    snprintf( attrBuf[i], sizeof(attrBuf[i]), "MOUNTPOINT=" UNMOUNT_DIR "0/inner" );
+    mkdir( attrBuf[i] + strlen("MOUNTPOINT="), 0700 );
+    UTST0( mount( "tmpfs", attrBuf[i] + strlen("MOUNTPOINT="), "tmpfs", 0, NULL ) );
+    attrs[n++] = attrBuf[i];
+    attrs[n++] = "MOUNTPOINT=" UNMOUNT_DIR "-notmounted";
+    attrs[n++] = "PATH=/nvram/ut-not-mounted";
+    attrs[n] = NULL;
+
+    t0 = utNowNs();
+    UTST( rdkssaUnmount( NULL, attrs ) == rdkssaOK );
+    tMounted = utNowNs() - t0;
+    UTST( rdkssaMountInfoLoad( &info ) == rdkssaOK );
+    for ( i = 0; i < UNMOUNT_VOLUMES; i++ ) {
+        UTST( rdkssaMountInfoFind( &info, attrBuf[i] + strlen("MOUNTPOINT=") ) == NULL );
+    }
+    rdkssaMountInfoRelease( &info );
+    t0 = utNowNs();
+    UTST( rdkssaUnmount( NULL, attrs ) == rdkssaOK );
+    tIdle = utNowNs() - t0;
+    RDKSSA_LOG_UT( "    %d volumes unmounted in %llu us, none mounted %llu us\n", UNMOUNT_VOLUMES + 1,
+                   (unsigned long long)( tMounted / 1000 ), (unsigned long long)( tIdle / 1000 ) );
+
+    // a busy volume needs LAZY=YES
+    const char * const busy[] = { attrBuf[0], NULL };
+    const char * const busyLazy[] = { attrBuf[0], "LAZY=YES", NULL };
+    UTST0( mount( "tmpfs", attrBuf[0] + strlen("MOUNTPOINT="), "tmpfs", 0, NULL ) );
+    UTST( ( fd = open( UNMOUNT_DIR "0/busy", O_CREAT | O_RDWR | O_CLOEXEC, 0600 ) ) >= 0 );
+    RDKSSA_LOG_UT( "  unmount expect 5 errors\n" );
+    UTST( rdkssaUnmount( NULL, busy ) == RDKSSA_PLATFORM_ERROR( EBUSY ) );
+    UTST( rdkssaUnmount( NULL, busyLazy ) == rdkssaOK );
+    close( fd );
+
+    const char * const badLazy[] = { attrBuf[0], "LAZY=MAYBE", NULL };
+    const char * const noTarget[] = { "LAZY=YES", NULL };
+    UTST( rdkssaUnmount( NULL, badLazy ) == rdkssaValidityError );
+    UTST( rdkssaUnmount( NULL, noTarget ) == rdkssaMissingAttribute );
+    remove( UNMOUNT_DIR "0/busy" );
+    rmdir( UNMOUNT_DIR "0/inner" );
+    for ( i = 0; i < UNMOUNT_VOLUMES; i++ ) {
+        rmdir( attrBuf[i] + strlen("MOUNTPOINT=") );
+    }
+    RDKSSA_LOG_UT( "  unmount SUCCESS\n" );
+}
+
+// a volume that is mounted already costs no helper spawn and no key read
+#define ALREADY_ITER        (1000)
+static void stressAlreadyMounted( void ) {
+    const char *mountPoint = stressAttrs[0] + strlen("MOUNTPOINT=");
+    const char *path = stressAttrs[1] + strlen("PATH=");
+    const char * const noKey[] = { stressAttrs[0], stressAttrs[1], "KEY=/tmp/ut_rdkssa_no_such_key", NULL };
+    uint64_t t0, t;
+    int i, already = 0;
+
+    RDKSSA_LOG_UT( "  already mounted\n" );
+    mkdir( mountPoint, 0700 );
+    if ( mount( path, mountPoint, "tmpfs", 0, NULL ) != 0 ) {
+        RDKSSA_LOG_UT( "  already mounted skipped, can't mount tmpfs (%d)\n", errno );
+        rmdir( mountPoint );
+        return;
+    }
+    t0 = utNowNs();
+    for ( i = 0; i < ALREADY_ITER; i++ ) {
+        already += ( rdkssaMount( NULL, noKey ) == rdkssaAlreadyMounted );
+    }
+    t = utNowNs() - t0;
+    UTST( already == ALREADY_ITER );
+    RDKSSA_LOG_UT( "    %d calls in %llu us, %.2f us/call\n", ALREADY_ITER, (unsigned long long)( t / 1000 ),
+                   t / 1000.0 / ALREADY_ITER );
+    UTST0( umount( mountPoint ) );
+    // not mounted any more: back to reading the key, which is missing
+    RDKSSA_LOG_UT( "  already mounted expect 1 error\n" );
+    UTST( rdkssaMount( NULL, noKey ) == rdkssaFileError );
+    rmdir( mountPoint );
+    RDKSSA_LOG_UT( "  already mounted SUCCESS\n" );
+}
+
+// volumes mounted by a batch, the mount helper taking BATCH_DELAY each
+#define BATCH_VOLUMES       (8)
+#define BATCH_DELAY         "0.1"
+#define BATCH_DIR           "/tmp/ut_rdkssa_batch"
+static uint64_t stressBatchRun( const char *workers, const char * const *volumes, rdkssaStatus_t *status,
+                                rdkssaStatus_t expect ) {
+    const char *attrs[MAX_SUPPORTED_ATTRIBUTES+1] = { workers };
+    uint64_t t0;
+    int n = 1;
+
+    while ( *volumes != NULL && n < MAX_SUPPORTED_ATTRIBUTES ) {
+        attrs[n++] = *volumes++;
+    }
+    attrs[n] = NULL;
+    t0 = utNowNs();
+    UTST( rdkssaMountBatch( status, attrs ) == expect );
+    return utNowNs() - t0;
+}
+
+static void stressBatch( void ) {
+    char attrBuf[BATCH_VOLUMES][3][64];
+    const char *volumes[BATCH_VOLUMES*3+1];
+    rdkssaStatus_t status[BATCH_VOLUMES];
+    uint64_t tSerial, tParallel;
+    char delayFile[96];
+    FILE *f;
+    int i;
+
+    RDKSSA_LOG_UT( "  batch\n" );
+    mkdir( BATCH_DIR, 0700 );
+    for ( i = 0; i < BATCH_VOLUMES; i++ ) {
+        snprintf( attrBuf[i][0], sizeof(attrBuf[i][0]), "MOUNTPOINT=" BATCH_DIR "/mnt%d", i );
+        snprintf( attrBuf[i][1], sizeof(attrBuf[i][1]), "PATH=" BATCH_DIR "/vol%d", i );
+        snprintf( attrBuf[i][2], sizeof(attrBuf[i][2]), "KEY=" STRESS_KEY_FILE );
+        volumes[3*i] = attrBuf[i][0];
+        volumes[3*i+1] = attrBuf[i][1];
+        volumes[3*i+2] = attrBuf[i][2];
+        mkdir( attrBuf[i][1] + strlen("PATH="), 0700 );
+        snprintf( delayFile, sizeof(delayFile), "%s/ecfsMountStub.delay", attrBuf[i][1] + strlen("PATH=") );
+        UTST( ( f = fopen( delayFile, "w" ) ) != NULL );
+        fputs( BATCH_DELAY "\n", f );
+        fclose( f );
+    }
+    volumes[3*BATCH_VOLUMES] = NULL;
+
+    tSerial = stressBatchRun( "WORKERS=1", volumes, status, rdkssaOK );
+    tParallel = stressBatchRun( "WORKERS=8", volumes, status, rdkssaOK );
+    for ( i = 0; i < BATCH_VOLUMES; i++ ) {
+        UTST( status[i] == rdkssaOK );
+    }
+    RDKSSA_LOG_UT( "    %d volumes, helper " BATCH_DELAY " s each: 1 worker %llu ms, 8 workers %llu ms\n", BATCH_VOLUMES,
+                   (unsigned long long)( tSerial / 1000000 ), (unsigned long long)( tParallel / 1000000 ) );
+    UTST( tParallel * 2 < tSerial );
+
+    // a volume without key fails alone; the one nested in it is not mounted; order of statuses is the caller's
+    const char * const partial[] = {
+        "MOUNTPOINT=" BATCH_DIR "/mnt0/inner", "PATH=" BATCH_DIR "/vol1", "KEY=" STRESS_KEY_FILE,
+        "MOUNTPOINT=" BATCH_DIR "/mnt0", "PATH=" BATCH_DIR "/vol0", "KEY=/tmp/ut_rdkssa_no_such_key",
+        "MOUNTPOINT=" BATCH_DIR "/mnt2", "PATH=" BATCH_DIR "/vol2", "KEY=" STRESS_KEY_FILE,
+        NULL };
+    RDKSSA_LOG_UT( "  batch expect 2 errors\n" );
+    stressBatchRun( "WORKERS=3", partial, status, rdkssaGeneralFailure );
+    UTST( status[0] == rdkssaGeneralFailure );
+    UTST( status[1] == rdkssaFileError );
+    UTST( status[2] == rdkssaOK );
+
+    const char * const pathFirst[] = { "PATH=" BATCH_DIR "/vol0", "MOUNTPOINT=" BATCH_DIR "/mnt0", NULL };
+    const char * const twoStdin[] = { "MOUNTPOINT=" BATCH_DIR "/mnt0", "KEY=STDIN", "MOUNTPOINT=" BATCH_DIR "/mnt1",
+                                      "KEY=STDIN", NULL };
+    RDKSSA_LOG_UT( "  batch expect 13 errors\n" );
+    stressBatchRun( "WORKERS=0", volumes, NULL, rdkssaValidityError );
+    stressBatchRun( "WORKERS=17", volumes, NULL, rdkssaValidityError );
+    stressBatchRun( "WORKERS=1", pathFirst, NULL, rdkssaValidityError );
+    stressBatchRun( "WORKERS=1", twoStdin, NULL, rdkssaValidityError );
+    stressBatchRun( "WORKERS=1", volumes + 3*BATCH_VOLUMES, NULL, rdkssaMissingAttribute );
+
+    for ( i = 0; i < BATCH_VOLUMES; i++ ) {
+        snprintf( delayFile, sizeof(delayFile), "%s/ecfsMountStub.delay", attrBuf[i][1] + strlen("PATH=") );
+        remove( delayFile );
+        rmdir( attrBuf[i][1] + strlen("PATH=") );
+    }
+    rmdir( BATCH_DIR );
+    RDKSSA_LOG_UT( "  batch SUCCESS\n" );
+}
+
+// a helper that exits with 1 or is killed fails the mount: 1 is not rdkssaAlreadyMounted
+#define FAIL_DIR            "/tmp/ut_rdkssa_fail"
+static void stressHelperFails( void ) {
+    static const char * const how[] = { "1", "SEGV" };
+    const char * const failing[] = { "MOUNTPOINT=" FAIL_DIR "/mnt", "PATH=" FAIL_DIR "/vol", "KEY=" STRESS_KEY_FILE, NULL };
+    const char * const batch[] = {
+        "MOUNTPOINT=" FAIL_DIR "/mnt", "PATH=" FAIL_DIR "/vol", "KEY=" STRESS_KEY_FILE,
+        "MOUNTPOINT=" FAIL_DIR "/mnt2", "PATH=" FAIL_DIR "/vol2", "KEY=" STRESS_KEY_FILE,
+        NULL };
+    rdkssaStatus_t status[2];
+    size_t i;
+    FILE *f;
+
+    RDKSSA_LOG_UT( "  helper fails\n" );
+    UTST0( system( "rm -rf " FAIL_DIR " && mkdir -p " FAIL_DIR "/vol " FAIL_DIR "/vol2" ) );
+    for ( i = 0; i < sizeof( how ) / sizeof( how[0] ); i++ ) {
+        UTST( ( f = fopen( FAIL_DIR "/vol/ecfsMountStub.fail", "w" ) ) != NULL );
+        fprintf( f, "%s\n", how[i] );
+        fclose( f );
+        RDKSSA_LOG_UT( "  helper fails (%s) expect 2 errors\n", how[i] );
+        UTST( rdkssaMount( NULL, failing ) == rdkssaGeneralFailure );
+        stressBatchRun( "WORKERS=2", batch, status, rdkssaGeneralFailure );
+        UTST( status[0] == rdkssaGeneralFailure && status[1] == rdkssaOK );
+    }
+    UTST0( system( "rm -rf " FAIL_DIR ) );
+    RDKSSA_LOG_UT( "  helper fails SUCCESS\n" );
+}
+
+// KEY=HANDLE: the key comes from the keyring, no file is read
+#define HANDLE_ITER         (200)
+static void stressKeyHandle( void ) {
+    const char * const keyName[] = { "NAME=stress_mount_key", NULL };
+    const char * const byHandle[] = { stressAttrs[0], stressAttrs[1], "KEY=HANDLE", NULL };
+    rdkssaDataBufPtr_t keyBytes = rdkssaSecDataBuf( 16 );
+    rdkssaKeyringBlob_t put = { NULL, keyBytes };
+    uint64_t t0, tFile, tHandle;
+    int i;
+
+    RDKSSA_LOG_UT( "  key handle\n" );
+    UTST( keyBytes != NULL );
+    memcpy( keyBytes->dataBuffer, "stress-test-key\n", 16 );
+    UTST( rdkssaPutKeyringKey( &put, keyName ) == rdkssaOK );
+    rdkssaSecFree( keyBytes );
+
+    t0 = utNowNs();
+    for ( i = 0; i < HANDLE_ITER; i++ ) {
+        UTST( rdkssaMount( &put.keyHandle, byHandle ) == rdkssaOK );
+    }
+    tHandle = utNowNs() - t0;
+    t0 = utNowNs();
+    for ( i = 0; i < HANDLE_ITER; i++ ) {
+        UTST( rdkssaMount( NULL, stressAttrs ) == rdkssaOK );
+    }
+    tFile = utNowNs() - t0;
+    RDKSSA_LOG_UT( "    %d mounts: key file %llu ms, key handle %llu ms\n", HANDLE_ITER,
+                   (unsigned long long)( tFile / 1000000 ), (unsigned long long)( tHandle / 1000000 ) );
+
+    RDKSSA_LOG_UT( "  key handle expect 2 errors\n" );
+    UTST( rdkssaMount( NULL, byHandle ) == rdkssaBadPointer );
+    UTST( rdkssaDeleteKeyFromKeyring( &put.keyHandle, keyName ) == rdkssaOK );
+    put.keyHandle = (rdkssa_handle_t)(uintptr_t)1;
+    UTST( rdkssaMount( &put.keyHandle, byHandle ) == rdkssaMissingSource );
+    RDKSSA_LOG_UT( "  key handle SUCCESS\n" );
+}
+
+#define FSCRYPT_ITER        (100)
+#define FSCRYPT_DIR         "/tmp/ut_rdkssa_fscrypt_stress"
+// mount and unmount by exec'ing the stub helper, then in process with BACKEND=FSCRYPT on an ext4 image
+static void stressFscrypt( void ) {
+    const char * const fsAttrs[] = { "MOUNTPOINT=" FSCRYPT_DIR "/mnt", "PATH=" FSCRYPT_DIR "/fs/secure",
+                                     "KEY=" FSCRYPT_DIR "/key", "BACKEND=FSCRYPT", NULL };
+    const char * const helperAttrs[] = { fsAttrs[0], fsAttrs[1], fsAttrs[2], "BACKEND=HELPER", NULL };
+    const char * const unmountAttrs[] = { fsAttrs[0], NULL };
+    uint8_t key[64];
+    uint64_t t0, tHelper, tFscrypt;
+    int i;
+    FILE *f;
+
+    RDKSSA_LOG_UT( "  fscrypt backend\n" );
+    UTST0( system( "rm -rf " FSCRYPT_DIR "; mkdir -p " FSCRYPT_DIR "/fs" ) );
+    if ( system( "truncate -s 16M " FSCRYPT_DIR "/fs.img && mkfs.ext4 -q -O encrypt " FSCRYPT_DIR "/fs.img 2>/dev/null"
+                 " && mount -o loop " FSCRYPT_DIR "/fs.img " FSCRYPT_DIR "/fs 2>/dev/null" ) != 0 ) {
+        RDKSSA_LOG_UT( "  fscrypt backend skipped, needs root, mkfs.ext4 and loop devices\n" );
+        UTST0( system( "rm -rf " FSCRYPT_DIR ) );
+        return;
+    }
+    for ( i = 0; i < (int)sizeof( key ); i++ ) {
+        key[i] = (uint8_t)( i * 7 );
+    }
+    UTST( ( f = fopen( FSCRYPT_DIR "/key", "w" ) ) != NULL );
+    UTST( fwrite( key, 1, sizeof( key ), f ) == sizeof( key ) );
+    fclose( f );
+
+    t0 = utNowNs();
+    for ( i = 0; i < FSCRYPT_ITER; i++ ) {
+        UTST( rdkssaMount( NULL, helperAttrs ) == rdkssaOK );	/* the stub mounts nothing */
+    }
+    tHelper = utNowNs() - t0;
+    t0 = utNowNs();
+    for ( i = 0; i < FSCRYPT_ITER; i++ ) {
+        UTST( rdkssaMount( NULL, fsAttrs ) == rdkssaOK );
+        UTST( rdkssaMount( NULL, fsAttrs ) == rdkssaAlreadyMounted );
+        UTST( rdkssaUnmount( NULL, unmountAttrs ) == rdkssaOK );
+    }
+    tFscrypt = utNowNs() - t0;
+    RDKSSA_LOG_UT( "    %d mounts: helper exec %llu us/mount, fscrypt mount+unmount %llu us\n", FSCRYPT_ITER,
+                   (unsigned long long)( tHelper / 1000 / FSCRYPT_ITER ),
+                   (unsigned long long)( tFscrypt / 1000 / FSCRYPT_ITER ) );
+    UTST0( system( "umount " FSCRYPT_DIR "/fs && rm -rf " FSCRYPT_DIR ) );
+    RDKSSA_LOG_UT( "  fscrypt backend SUCCESS\n" );
+}
+
+int stressmain( int argc, char *argv[] ) {
+    static const int threadCounts[] = { 1, 2, 4, 8, 16 };
+    pthread_t tid[16], churn;
+    uint64_t t0, t;
+    size_t n;
+    int i;
+    FILE *f;
+
+    RDKSSA_LOG_UT( "MOUNT STRESS TEST, helper " RDKSSA_MOUNT_HELPER "\n" );
+    stressUnmount( );
+    stressAlreadyMounted( );
+    UTST( ( f = fopen( STRESS_KEY_FILE, "w" ) ) != NULL );
+    UTST( fputs( "stress-test-key\n", f ) >= 0 );
+    fclose( f );
+    stressBatch( );
+    stressHelperFails( );
+    stressKeyHandle( );
+    stressFscrypt( );
+    UTST0( pthread_create( &churn, NULL, stressEnvChurn, NULL ) );
+    for ( n = 0; n < sizeof(threadCounts)/sizeof(threadCounts[0]); n++ ) {
+        int threads = threadCounts[n];
+        t0 = utNowNs();
+        for ( i = 0; i < threads; i++ ) {
+            UTST0( pthread_create( &tid[i], NULL, stressWorker, (void *)(intptr_t)( STRESS_ITER / threads ) ) );
+        }
+        for ( i = 0; i < threads; i++ ) {
+            pthread_join( tid[i], NULL );
+        }
+        t = utNowNs() - t0;
+        RDKSSA_LOG_UT( "  %2d threads: %d mounts in %4llu ms, %6.0f mounts/s\n", threads, STRESS_ITER,
+                       (unsigned long long)( t / 1000000 ), STRESS_ITER * 1e9 / (double)t );
+    }
+    __atomic_store_n( &stressEnvStop, 1, __ATOMIC_RELAXED );
+    pthread_join( churn, NULL );
+    remove( STRESS_KEY_FILE );
+    UTST( stressFailures == 0 );
+    RDKSSA_LOG_UT( "MOUNT STRESS TEST SUCCESS\n" );
+    return 0;
+}
+
+int main(int argc, char *argv[] ) {
+    return stressmain( argc, argv );
+}
+#endif
+
+#ifdef MOUNT_BENCH
+/**
+ * rdkssaMount latency per phase, through the real exec path, against a stub mounter
+ * build with -DRDKSSA_MOUNT_HELPER='"<stub>"', normally the compiled ecfsMountStub (see the ssa_oss Makefile,
+ * target benchmount, or make check); run as: bench [iterations [stub delay in ms]]
+ *
+ * The phases are those of mountExecute with the helper backend, timed one by one:
+ * parse   attribute vector to mount_param_t
+ * check   already mounted?
+ * key     key file opened
+ * spawn   helper started and the key streamed to its stdin
+ * wait    helper exit
+ * and rdkssaMount itself, over as many calls again.
+ */
+#include <sys/stat.h>
+#define BENCH_DIR           "/tmp/ut_rdkssa_bench"
+#define BENCH_PATH          BENCH_DIR "/path"
+#define BENCH_KEY           "bench-mount-key\n"
+#define BENCH_ITER          (1000)
+#define BENCH_WARMUP        (20)
+#define BENCH_PHASES        (6)
+
+static const char * const benchPhase[BENCH_PHASES] = { "parse", "check", "key", "spawn", "wait", "rdkssaMount" };
+
+static int benchCompare( const void *a, const void *b ) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return ( x > y ) - ( x < y );
+}
+
+// one mount, phase by phase, into t[0..4]
+static void benchMountPhases( const char * const attrs[], uint64_t *t ) {
+    mount_param_t mp;
+    rdkssaExec_t *exec;
+    uint64_t t0, t1;
+    int mounted;
+
+    t0 = utNowNs();
+    mountParamInit( &mp, NULL );
+    UTST( rdkssaHandleAPIIndexedHelper( (void*)&mp, attrs, &mountHandlerIndex ) == rdkssaOK );
+    t1 = utNowNs(); t[0] = t1 - t0; t0 = t1;
+    UTST( rdkssaMountInfoIsMounted( mp.mountPoint, mp.mountPath, &mounted ) == rdkssaOK && !mounted );
+    t1 = utNowNs(); t[1] = t1 - t0; t0 = t1;
+    UTST( mountKeyOpen( &mp ) == rdkssaOK );
+    t1 = utNowNs(); t[2] = t1 - t0; t0 = t1;
+    const char *mountArgv[ 4 ] = { RDKSSA_MOUNT_HELPER, mp.mountPoint, mp.mountPath };
+    UTST( rdkssaExecvPipeOutputAsync( mountArgv, (rdkssa_blobptr_t)&mp, mountWriteKeyCallback, &exec ) == rdkssaOK );
+    t1 = utNowNs(); t[3] = t1 - t0; t0 = t1;
+    UTST( rdkssaExecWait( exec, RDKSSA_EXEC_TIMEOUT_MS ) == 0 );
+    t[4] = utNowNs() - t0;
+    mountKeyClose( &mp.key );
+}
+
+int benchmain( int argc, char *argv[] ) {
+    const char * const attrs[] = { "MOUNTPOINT=" BENCH_DIR "/mnt", "PATH=" BENCH_PATH, "KEY=" BENCH_DIR "/key", NULL };
+    int iter = ( argc > 1 ) ? atoi( argv[1] ) : BENCH_ITER;
+    int delayMs = ( argc > 2 ) ? atoi( argv[2] ) : 0;
+    uint64_t *t[BENCH_PHASES], phase[BENCH_PHASES], t0;
+    char line[256];
+    int i, p, records = 0;
+    FILE *f;
+
+    if ( iter < 1 ) {
+        iter = BENCH_ITER;
+    }
+    RDKSSA_LOG_UT( "MOUNT BENCH, helper " RDKSSA_MOUNT_HELPER ", %d iterations, %d ms stub delay\n", iter, delayMs );
+    mkdir( BENCH_DIR, 0700 );
+    mkdir( BENCH_PATH, 0700 );
+    UTST( ( f = fopen( BENCH_DIR "/key", "w" ) ) != NULL );
+    UTST( fputs( BENCH_KEY, f ) >= 0 );
+    UTST0( fclose( f ) );
+    remove( BENCH_PATH "/ecfsMountStub.delay" );
+    if ( delayMs > 0 ) {
+        UTST( ( f = fopen( BENCH_PATH "/ecfsMountStub.delay", "w" ) ) != NULL );
+        fprintf( f, "%d.%03d\n", delayMs / 1000, delayMs % 1000 );
+        UTST0( fclose( f ) );
+    }
+    for ( p = 0; p < BENCH_PHASES; p++ ) {
+        UTST( ( t[p] = malloc( iter * sizeof( uint64_t ) ) ) != NULL );
+    }
+    for ( i = 0; i < BENCH_WARMUP; i++ ) {
+        UTST( rdkssaMount( NULL, attrs ) == rdkssaOK );
+    }
+    // the stub records every mount it is given, from here on
+    UTST( ( f = fopen( BENCH_PATH "/ecfsMountStub.record", "w" ) ) != NULL );
+    UTST0( fclose( f ) );
+
+    for ( i = 0; i < iter; i++ ) {
+        benchMountPhases( attrs, phase );
+        for ( p = 0; p < BENCH_PHASES - 1; p++ ) {
+            t[p][i] = phase[p];
+        }
+    }
+    for ( i = 0; i < iter; i++ ) {
+        t0 = utNowNs();
+        UTST( rdkssaMount( NULL, attrs ) == rdkssaOK );
+        t[BENCH_PHASES - 1][i] = utNowNs() - t0;
+    }
+
+    // each mount reached the stub, with the whole key
+    UTST( ( f = fopen( BENCH_PATH "/ecfsMountStub.record", "r" ) ) != NULL );
+    while ( fgets( line, sizeof( line ), f ) != NULL ) {
+        UT_STRCMP( line, BENCH_DIR "/mnt ", strlen( BENCH_DIR "/mnt " ) );
+        UTST( (size_t)atoi( line + strlen( BENCH_DIR "/mnt " ) ) == strlen( BENCH_KEY ) );
+        records++;
+    }
+    fclose( f );
+    UTST( records == 2 * iter );
+
+    RDKSSA_LOG_UT( "  %-12s %10s %10s %10s %10s\n", "phase", "p50 us", "p99 us", "max us", "mean us" );
+    for ( p = 0; p < BENCH_PHASES; p++ ) {
+        uint64_t sum = 0;
+        for ( i = 0; i < iter; i++ ) {
+            sum += t[p][i];
+        }
+        qsort( t[p], iter, sizeof( uint64_t ), benchCompare );
+        RDKSSA_LOG_UT( "  %-12s %10.1f %10.1f %10.1f %10.1f\n", benchPhase[p], t[p][iter / 2] / 1000.0,
+                       t[p][(int)( (int64_t)iter * 99 / 100 )] / 1000.0, t[p][iter - 1] / 1000.0, sum / 1000.0 / iter );
+        free( t[p] );
+    }
+    remove( BENCH_PATH "/ecfsMountStub.record" );
+    remove( BENCH_PATH "/ecfsMountStub.delay" );
+    remove( BENCH_DIR "/key" );
+    rmdir( BENCH_PATH );
+    rmdir( BENCH_DIR "/mnt" );
+    rmdir( BENCH_DIR );
+    RDKSSA_LOG_UT( "MOUNT BENCH SUCCESS\n" );
+    return 0;
+}
+
+int main(int argc, char *argv[] ) {
+    return benchmain( argc, argv );
+}
+#endif
@@ -21,4 +21,25 @@
 
 /* Include definitions private to the mount provider implementation */
 
+/* helper that mounts a volume: argv MOUNTPOINT PATH, key on stdin */
+#ifndef RDKSSA_MOUNT_HELPER
+#define RDKSSA_MOUNT_HELPER     "/usr/bin/ecfsMount"
+#endif
+
+/* largest key KEY= may name, in bytes */
+#ifndef RDKSSA_MOUNT_KEY_MAX
+#define RDKSSA_MOUNT_KEY_MAX    (16 * 1024)
+#endif
+
+/* backend when BACKEND= is not given (rdkssaMountProtected.h) */
+#ifndef RDKSSA_MOUNT_BACKEND
+#define RDKSSA_MOUNT_BACKEND    rdkssaMountBackendHelper
+#endif
+
+/* rdkssaMountBatch: mounts run at once when WORKERS= is not given, and the most WORKERS= may ask for */
+#ifndef RDKSSA_MOUNT_BATCH_WORKERS
+#define RDKSSA_MOUNT_BATCH_WORKERS      (4)
+#endif
+#define RDKSSA_MOUNT_BATCH_MAX_WORKERS  (16)
+
 #endif
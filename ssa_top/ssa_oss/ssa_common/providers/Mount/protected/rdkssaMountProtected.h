@@ -0,0 +1,55 @@
+/*
+ * Copyright 2020 Comcast Cable Communications Management, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+*/
+
+/* Shared by the Mount Provider variants and their backends */
+
+#ifndef __rdkssa_mount_protected_inc__
+#define __rdkssa_mount_protected_inc__
+
+#include "rdkssa.h"
+
+/**
+ * Mount backends: what mounts a volume once its key is known (BACKEND= attribute)
+ *
+ * HELPER	exec RDKSSA_MOUNT_HELPER MOUNTPOINT PATH with the key on its stdin
+ * FSCRYPT	in process: add the key to the filesystem's fscrypt keyring, encrypt PATH with it if PATH is
+ *			a new or empty directory, and bind mount PATH on MOUNTPOINT (Mount/fscrypt)
+ */
+typedef enum {
+	rdkssaMountBackendHelper = 0,
+	rdkssaMountBackendFscrypt
+} rdkssaMountBackend_t;
+
+/* the FSCRYPT backend's key size, FSCRYPT_MAX_KEY_SIZE */
+#define RDKSSA_MOUNT_FSCRYPT_KEY_SIZE	(64)
+
+/**
+ * rdkssaMountFscrypt - mount PATH on MOUNTPOINT with the FSCRYPT backend
+ *
+ * key: RDKSSA_MOUNT_FSCRYPT_KEY_SIZE raw bytes, used for an AES-256-XTS/CTS v2 policy
+ * returns rdkssaOK, rdkssaBadLength for a key of another size, rdkssaValidityError if PATH is encrypted
+ * with another key, or RDKSSA_PLATFORM_ERROR( errno ) of the step that failed
+ */
+rdkssaStatus_t rdkssaMountFscrypt( const char *mountPoint, const char *path, const uint8_t *key, size_t keyLen );
+
+/**
+ * rdkssaMountFscryptIsMounted - is PATH bind mounted on MOUNTPOINT
+ */
+int rdkssaMountFscryptIsMounted( const char *mountPoint, const char *path );
+
+#endif
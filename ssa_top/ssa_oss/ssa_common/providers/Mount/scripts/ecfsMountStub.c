@@ -0,0 +1,78 @@
+/*
+ * Copyright 2020 Comcast Cable Communications Management, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+*/
+
+/**
+ * ecfsMountStub, compiled: stand-in for ecfsMount in benchmarks, so the numbers are not a shell's start-up
+ *
+ * enter with Mountpoint Path, key on stdin; mounts nothing
+ * fails like ecfsMount would if an argument or the key is missing
+ * takes as many seconds as Path/ecfsMountStub.delay says, like a slow device
+ * fails as Path/ecfsMountStub.fail says: an exit status, or SEGV to be killed by that signal
+ * appends "Mountpoint keylength" to Path/ecfsMountStub.record if that file exists
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define STUB_KEY_MAX    (4096)
+
+int main( int argc, char *argv[] ) {
+	char file[4096], key[STUB_KEY_MAX], how[16] = "";
+	size_t keyLen = 0;
+	ssize_t n;
+	double delay;
+	struct timespec ts;
+	FILE *f;
+
+	if ( argc < 3 || argv[1][0] == '\0' || argv[2][0] == '\0' ) {
+		return 2;
+	}
+	while ( keyLen < sizeof( key ) && ( n = read( 0, key + keyLen, sizeof( key ) - keyLen ) ) > 0 ) {
+		keyLen += (size_t)n;
+	}
+	if ( keyLen == 0 ) {
+		return 3;
+	}
+	snprintf( file, sizeof( file ), "%s/ecfsMountStub.fail", argv[2] );
+	if ( ( f = fopen( file, "r" ) ) != NULL ) {
+		if ( fscanf( f, "%15s", how ) == 1 && strcmp( how, "SEGV" ) == 0 ) {
+			raise( SIGSEGV );
+		}
+		fclose( f );
+		return atoi( how );
+	}
+	snprintf( file, sizeof( file ), "%s/ecfsMountStub.delay", argv[2] );
+	if ( ( f = fopen( file, "r" ) ) != NULL ) {
+		if ( fscanf( f, "%lf", &delay ) == 1 && delay > 0 ) {
+			ts.tv_sec = (time_t)delay;
+			ts.tv_nsec = (long)( ( delay - ts.tv_sec ) * 1e9 );
+			nanosleep( &ts, NULL );
+		}
+		fclose( f );
+	}
+	snprintf( file, sizeof( file ), "%s/ecfsMountStub.record", argv[2] );
+	if ( access( file, W_OK ) == 0 && ( f = fopen( file, "a" ) ) != NULL ) {
+		fprintf( f, "%s %zu\n", argv[1], keyLen );
+		fclose( f );
+	}
+	return 0;
+}
@@ -21,4 +21,18 @@
 #ifndef __rdkssa_providers_protected_inc__
 #define __rdkssa_providers_protected_inc__
 
+#include "rdkssa.h"
+
+/**
+ * In-process keyring (Keyring provider), for providers that take KEY=HANDLE
+ *
+ * rdkssaKeyringAcquire resolves a handle from rdkssaPutKeyringKey and pins the key's current bytes: *key
+ * points into the keyring itself and stays valid until rdkssaKeyringRelease( *ref ), even if the key is
+ * replaced or deleted meanwhile.  Nothing is copied, so do not keep *key past the release.
+ * returns rdkssaOK, rdkssaBadPointer, or rdkssaMissingSource if the handle names no key (any more)
+ */
+typedef struct rdkssaKeyringRef rdkssaKeyringRef_t;
+rdkssaStatus_t rdkssaKeyringAcquire( rdkssa_handle_t keyHandle, rdkssaKeyringRef_t **ref, const uint8_t **key, size_t *keyLen );
+void rdkssaKeyringRelease( rdkssaKeyringRef_t *ref );
+
 #endif //__rdkssa_providers_protected_inc__
@@ -26,6 +26,7 @@
 #include <unistd.h>
 
 typedef enum { 
+    rdkssaAlreadyMounted=1,     /* success, rdkssaMount found the volume already mounted */
     rdkssaOK=0,
     rdkssaGeneralFailure=-1,
     rdkssaBadPointer=-2,
@@ -39,12 +40,18 @@ typedef enum {
 	rdkssaEmptyAttribute=-10,
 	rdkssaMissingAttribute=-11,
 	rdkssaProviderNotFound=-12,
+	rdkssaTimeout=-13,
     /* more here */
     
     rdkssaNYIError=-100
               
 } rdkssaStatus_t;
 
+/**
+ * True for the statuses that mean the call succeeded
+ */
+#define RDKSSA_SUCCESS(status) ((status)==rdkssaOK || (status)==rdkssaAlreadyMounted)
+
 /**
  * Typedef for type safety when passing the generic pointers around
  */
@@ -57,6 +64,12 @@ typedef void * rdkssa_blobptr_t;
 
 typedef void * rdkssa_handle_t;
 
+/**
+ * Platform error codes returned by the API's, e.g. an errno (see "All API's return" below)
+ */
+#define RDKSSA_PLATFORM_ERROR_BASE                  (10000)
+#define RDKSSA_PLATFORM_ERROR( err )                ( RDKSSA_PLATFORM_ERROR_BASE + (err) )
+
 
 /**
 *  rdkssaDataBuf_t defines a structure containing the length and databuffer for 
@@ -69,6 +82,12 @@ typedef void * rdkssa_handle_t;
 *
 *  You MUST use the above allocation method to account for the alignment padding.
 *  Do NOT use something like malloc( sizeof(size_t) + my_data_length );
+*
+*  Or let the library allocate it: rdkssaDataBufAlloc( sizeOfData ) returns a zeroed buffer with
+*  sizeOfData set (NULL if out of memory), and rdkssaDataBufRelease wipes it and takes it back.
+*  Buffers up to RDKSSA_DATABUF_MAX_POOLED bytes of data come from per-thread free lists in power of two
+*  size classes, so a thread that keeps allocating and releasing buffers does not call malloc or free.
+*  Release only buffers from rdkssaDataBufAlloc, from any thread; never free() them.
 */
 
 typedef struct rdkssaDataBuf_s { 
@@ -76,11 +95,21 @@ typedef struct rdkssaDataBuf_s {
     uint8_t  __attribute__ ((aligned (sizeof(void*)))) dataBuffer[];
 } rdkssaDataBuf_t, *rdkssaDataBufPtr_t;
 
+#define RDKSSA_DATABUF_MAX_POOLED                   (32768)
+rdkssaDataBufPtr_t rdkssaDataBufAlloc( size_t sizeOfData );
+void rdkssaDataBufRelease( rdkssaDataBufPtr_t buf );
+
 /**
  * Declaration macro to ensure uniform API signature easily
  */
 #define RDKSSA_API( apiname ) rdkssaStatus_t apiname (rdkssa_blobptr_t apiBlobPtr, const char * const apiAttributes[])
 
+/**
+ * Declaration macros for prepared calls (see "Prepared calls" below)
+ */
+#define RDKSSA_PREPARE_API( apiname ) rdkssaStatus_t apiname##Prepare (rdkssa_handle_t *preparedCall, const char * const apiAttributes[])
+#define RDKSSA_EXECUTE_API( apiname ) rdkssaStatus_t apiname##Execute (rdkssa_blobptr_t apiBlobPtr, rdkssa_handle_t preparedCall)
+
 /**
  * Declaration macro for arrays of atttributes, to ensure compatibility easily:
  */
@@ -109,7 +138,21 @@ typedef struct rdkssaDataBuf_s {
  ** - rdkssaOK if no errors occur.  
  ** - Otherwise, one of the above error codes for rdkssa errors, or
  ** - A positive value excess 10000 for error codes coming from the underlying platform implementation. (Subtract 10000 to recover platform error code)
- **   This is so an error code > 10000 can be differentiated from rdkssa codes
+ **   This is so an error code > 10000 can be differentiated from rdkssa codes (RDKSSA_PLATFORM_ERROR)
+ ** - rdkssaBadLength with the size needed in sizeOfData when an output rdkssaDataBuf_t is too small.  A provider
+ **   may keep that result for a short time, so retrying at once, from the same thread with the same attributes
+ **   and a big enough buffer, only copies it.
+ **
+ ** Concurrency:
+ ** - All API's may be called from several threads at once.  Each call keeps its state on its own stack;
+ **   the only shared state is built once under a lock (handler indexes) or is read-only after load.
+ ** - Prepared call handles may be executed concurrently, but must not be released while in use.
+ ** - Helpers get the environment as it was when the library was loaded (later setenv() is not seen),
+ **   and no descriptor the library opens is inherited by a helper other than its own stdin pipe.
+ ** - The library installs no signal handlers and changes no process-wide signal state.  SIGPIPE is
+ **   blocked only in the calling thread while it writes to a helper.  It does rely on being the one to
+ **   reap its helpers: a process that sets SIGCHLD to SIG_IGN or calls waitpid(-1) sees failed helpers.
+ ** - KEY=STDIN reads the process's stdin; concurrent calls using it each get whatever they read first.
  **/
 
 
@@ -131,8 +174,13 @@ typedef struct rdkssaDataBuf_s {
  *                 At least one must be present.
  *
  * Return:         If successful, *apiBlobPtr will contain a 0-terminated string with the value of the requested parameter.  MAC addresses are returned as colon-separated ASCII hex.
+ *                 sizeOfData is set to its length, with the terminating 0.
+ *                 rdkssaMissingSource if the platform has no such attribute.
  *                 Other format specifics are/will be defined on Confluence
  *
+ * The default provider reads the platform once per boot: the first call saves every attribute to a read-only
+ * cache file on a tmpfs (/run/rdkssa/identity), that later calls from any process map and read.
+ *
  */
 RDKSSA_API( rdkssaGetIdentityAttribute);
 
@@ -408,47 +456,109 @@ RDKSSA_API( rdkssaGetRandom );
 * rdkssaMount		-	Mount a secure volume
 *
 *
-* blobPtr: Pointer to a key handle returned from rdkssaCreateSymKey if KEY="HANDLE"
+* blobPtr: Pointer to a key handle returned from rdkssaPutKeyringKey if KEY="HANDLE"; the key is used in place, no file is read
 * attributes[]:
 * +MOUNTPOINT=<where to mount the new volume>
 * +PATH=<path of the new volume to be created>
-* KEY=<path to credential, credential name per caller's storage provider> | "HANDLE" | <omitted>: provider-defined key material
+* KEY=<path to credential, credential name per caller's storage provider> | "STDIN" | "HANDLE" | <omitted>: provider-defined key material
+*	A key file or STDIN is streamed to the mount helper as it is read, up to 16 KiB (RDKSSA_MOUNT_KEY_MAX)
 * PARTITION=<device partition info>
+* BACKEND=HELPER|FSCRYPT	what mounts the volume, default set at build time (RDKSSA_MOUNT_BACKEND), normally HELPER
+*	HELPER:		the mount helper is run with the key on its stdin
+*	FSCRYPT:	no process is started; the 64 byte key is added to the fscrypt keyring of the filesystem PATH is
+*				on, a new or empty PATH is encrypted with it, and PATH is bind mounted on MOUNTPOINT.  The key stays
+*				in the filesystem keyring after rdkssaUnmount, which must be given MOUNTPOINT= for such a volume
+*
+* If PATH is already mounted on MOUNTPOINT nothing is done and rdkssaAlreadyMounted is returned; the key
+* is not read in that case.  Test the result with RDKSSA_SUCCESS() to accept both.
 */
 
 RDKSSA_API( rdkssaMount );
 
 /**
-* rdkssaUnmount	-	Unmount (but leave intact) a secure volume
+* rdkssaUnmount	-	Unmount (but leave intact) one or more secure volumes
 *
 * blobPtr: unused may be NULL
 * attributes[]=
-* +PATH=<path of volume to be unmounted>
+* MOUNTPOINT=<mountpoint of a volume to be unmounted>		(may be repeated)
+* PATH=<path of a volume to be unmounted, as given to rdkssaMount>	(may be repeated)
+* LAZY=YES|NO			detach now and finish when no longer busy (MNT_DETACH), default NO
+* At least one MOUNTPOINT= or PATH= is required.
+*
+* The mount table is read once per call; volumes that are not mounted are skipped without any further
+* work, the others are unmounted with one umount2() each, innermost first.
+* returns rdkssaOK, or RDKSSA_PLATFORM_ERROR( errno ) of the first unmount that failed
 */
 
 RDKSSA_API( rdkssaUnmount );
 
+/**
+* rdkssaMountBatch	-	Mount several secure volumes with one call, some of them at the same time
+*
+* blobPtr: rdkssaStatus_t array with an element per volume, receives each volume's status as rdkssaMount
+*          would have returned it, in the order of the MOUNTPOINT= attributes; may be NULL
+* attributes[]:
+* +MOUNTPOINT=<where to mount a volume>	(repeated, each one starts the next volume)
+* +PATH=<path of the volume>				applies to the volume of the latest MOUNTPOINT=
+* KEY=<as for rdkssaMount>				applies to the volume of the latest MOUNTPOINT=, STDIN for one volume only
+* WORKERS=<1..16>						how many volumes to mount at once, default 4
+* BACKEND=<as for rdkssaMount>			for all volumes of the batch
+*
+* A volume whose MOUNTPOINT lies inside another volume of the batch is mounted after it, and not at
+* all if that one failed.  With the helper process started, the worker runs the mount helpers at once too.
+* returns rdkssaOK if every volume is mounted (rdkssaAlreadyMounted counts), else the status of the
+* first volume that failed
+*/
+
+RDKSSA_API( rdkssaMountBatch );
+
+/**
+ * Prepared calls
+ *
+ * A caller that makes the same API call with the same attribute vector over and over can prepare it once.
+ * <api>Prepare parses, validates and resolves the attributes against the provider and returns an opaque
+ * handle in *preparedCall; the attribute strings are copied, so the caller's vector may be freed afterwards.
+ * <api>Execute then runs the API with only the blob pointer supplied, skipping the attribute processing.
+ * The key file named by KEY= (if any) is still read on every execution that mounts the volume.
+ * Release the handle with rdkssaReleasePrepared, which sets *preparedCall to NULL.
+ * A handle is only read when executed, so several threads may execute it at once; it must not be
+ * released while an execution is in progress.
+ *
+ * Supported for: rdkssaMount
+ */
+RDKSSA_PREPARE_API( rdkssaMount );
+RDKSSA_EXECUTE_API( rdkssaMount );
+void rdkssaReleasePrepared( rdkssa_handle_t *preparedCall );
+
 /**
 * rdkssaKeyring Provider
 *
 * The Keyring Provider provides an interface to securely maintain keys at runtime,
 * allowing storage, retrieval and destruction of supported key objects
 *
+* The keys are held in memory by the process, and are gone when it exits.  A key handle from
+* rdkssaPutKeyringKey can be passed to rdkssaMount with KEY=HANDLE instead of a key file.
 */
 
+typedef struct {
+	rdkssa_handle_t keyHandle;
+	rdkssaDataBufPtr_t keyBytes;
+} rdkssaKeyringBlob_t;
+
 /**
  * rdkssaGetKeyringKey	-	Retrieve the data payload associated with a key serial number if permissions allow
  *
- * blobPtr: ptr to
+ * blobPtr: ptr to rdkssaKeyringBlob_t
  * struct {
- *		rdkssa_handle_t keyHandle;		(opaque) Value returned from a call to rdkssaPutKeyringKey
+ *		rdkssa_handle_t keyHandle;		(opaque) Value returned from a call to rdkssaPutKeyringKey, or NULL
  *		rdkssaDataBufPtr_t keyBytes;	Ppinter to buffer for returned key payload
  *	 }
  * attributes[]=
  * +NAME=<name of key as assigned when rdkssaPutKeyringKey called>
  *
  * The key payload is returned in caller's buffer; the buffer size MUST be large enough for the key payload,
- * and is assumed to be known by the caller
+ * and is assumed to be known by the caller.  If it is not, rdkssaBadLength is returned and sizeOfData
+ * holds the size needed.  A non-NULL keyHandle must be the handle of NAME.
  */
  
 RDKSSA_API(rdkssaGetKeyringKey);
@@ -456,16 +566,17 @@ RDKSSA_API(rdkssaGetKeyringKey);
 /**
  * rdkssaPutKeyringKey	-	Create a new key or update existing 
  *
- * blobPtr: ptr to
+ * blobPtr: ptr to rdkssaKeyringBlob_t
  * struct {
  *		rdkssa_handle_t keyHandle;		(opaque) Value to be returned 
  *		rdkssaDataBufPtr_t keyBytes;	Ppinter to buffer containing key payload
  *	 }
  * attributes[]=
  * +NAME=<name of key to assign> ( [A-Za-z0-9_] )
- * PERM=<permissions string> ( format TBD, default = "ALL" if missing )
+ * PERM=<permissions string> ( format TBD, default = "ALL" if missing, only "ALL" is supported )
  *
- * The key payload is supplied in caller's buffer
+ * The key payload is supplied in caller's buffer, 1..MAX_ATTRIBUTE_VALUE_LENGTH bytes, and copied.
+ * Putting an existing NAME replaces its payload and keeps its handle.
  */
 
 RDKSSA_API(rdkssaPutKeyringKey);
@@ -473,7 +584,8 @@ RDKSSA_API(rdkssaPutKeyringKey);
 /**
  * rdkssaDeleteKeyFromKeyring	-	Delete/destroy key from keyring 
  *
- * blobPtr: keyHandle
+ * blobPtr: pointer to the keyHandle, set to NULL when the key is deleted; may be NULL
+ *          the payload is wiped once no mount that is using it is still in progress
  * attributes[]=
  * +NAME=<name of key as assiged> ( [A-Za-z0-9_] )
  */
@@ -495,8 +607,12 @@ RDKSSA_API(rdkssaHandleAPITemplate);
 /* Logging */
 #ifdef RDKSSA_LOG_FILE
 
+#ifndef RDKSSA_DEBUG_LOG_FILE_NAME
 #define RDKSSA_DEBUG_LOG_FILE_NAME "/rdklogs/logs/rdkssa.txt"
+#endif
 void _rdkssa_debug_log( const char* fmt, ...);
+// lines are written by a background thread (ssaLog.c); wait until everything logged so far is in the file
+void rdkssaLogFlush( void );
 
 #define LOG_ERROR(...)                         _rdkssa_debug_log(__VA_ARGS__)
 #define LOG_INFO(...)                          _rdkssa_debug_log(__VA_ARGS__)
@@ -510,6 +626,37 @@ void _rdkssa_debug_log( const char* fmt, ...);
 
 #endif
 
+/**
+ * Runtime log level
+ *
+ * RDKSSA_ERROR/INFO/DEBUG_ENABLED decide which levels are compiled in; rdkssaLogLevel decides which of those
+ * are printed.  It is set once when the library is loaded: from the RDKSSA_LOG_LEVEL environment variable if
+ * present, otherwise from the first word of RDKSSA_LOG_LEVEL_FILE, otherwise RDKSSA_LOG_LEVEL_DEFAULT.
+ * Either source takes NONE, ERROR, INFO, DEBUG or 0..3.  e.g. on one box:  echo DEBUG > /nvram/rdkssa_log_level
+ *
+ * A disabled level costs one load and compare; the arguments are not evaluated and nothing is formatted.
+ */
+#define RDKSSA_LEVEL_NONE                          (0)
+#define RDKSSA_LEVEL_ERROR                         (1)
+#define RDKSSA_LEVEL_INFO                          (2)
+#define RDKSSA_LEVEL_DEBUG                         (3)
+#ifndef RDKSSA_LOG_LEVEL_DEFAULT
+#define RDKSSA_LOG_LEVEL_DEFAULT                   RDKSSA_LEVEL_ERROR
+#endif
+#ifndef RDKSSA_LOG_LEVEL_FILE
+#define RDKSSA_LOG_LEVEL_FILE                      "/nvram/rdkssa_log_level"
+#endif
+extern int rdkssaLogLevel;
+#define RDKSSA_LOG_ON( level )                     __builtin_expect( rdkssaLogLevel >= (level), 0 )
+#define RDKSSA_LOG_IF( level, stmt )               do { if ( RDKSSA_LOG_ON( level ) ) { stmt; } } while (0)
+
+// file name without the path, folded by the compiler
+#ifdef __FILE_NAME__
+#define RDKSSA_FILE_NAME                           __FILE_NAME__
+#else
+#define RDKSSA_FILE_NAME                           ( __builtin_strrchr( __FILE__, '/' ) ? __builtin_strrchr( __FILE__, '/' ) + 1 : __FILE__ )
+#endif
+
 #ifdef USE_COLORS
 #define COL_RED "\033[0;31m"
 #define COL_GRN "\033[0;32m"
@@ -519,7 +666,7 @@ void _rdkssa_debug_log( const char* fmt, ...);
 #define COL_CYA "\033[0;36m"
 #define COL_DEF "\033[0m"
 #define PREFIX(format)                             ("%12s:%3d:%16s - " format)
-#define RDKSSA_CRITICAL_ERROR(format, ...)         LOG_ERROR(PREFIX(COL_RED"CRITICAL ERR:"COL_DEF format), strrchr(__FILE__,'/')+1,__LINE__, __func__, ##__VA_ARGS__)
+#define RDKSSA_CRITICAL_ERROR(format, ...)         LOG_ERROR(PREFIX(COL_RED"CRITICAL ERR:"COL_DEF format), RDKSSA_FILE_NAME,__LINE__, __func__, ##__VA_ARGS__)
 #else
 // do not use colors on targets
 #define PREFIX(format)                             ("%d\t: %s - " format)
@@ -527,9 +674,9 @@ void _rdkssa_debug_log( const char* fmt, ...);
 #endif
 
 #if defined(USE_COLORS) && defined(RDKSSA_ERROR_ENABLED)
-#define RDKSSA_LOG_ERROR(format, ...)              LOG_ERROR(PREFIX(COL_RED"ERR:"COL_DEF format), strrchr(__FILE__,'/')+1,__LINE__, __func__, ##__VA_ARGS__)
+#define RDKSSA_LOG_ERROR(format, ...)              RDKSSA_LOG_IF( RDKSSA_LEVEL_ERROR, LOG_ERROR(PREFIX(COL_RED"ERR:"COL_DEF format), RDKSSA_FILE_NAME,__LINE__, __func__, ##__VA_ARGS__) )
 #elif defined(RDKSSA_ERROR_ENABLED)
-#define RDKSSA_LOG_ERROR(format, ...)              LOG_ERROR(PREFIX(format), __LINE__, __func__, ##__VA_ARGS__)
+#define RDKSSA_LOG_ERROR(format, ...)              RDKSSA_LOG_IF( RDKSSA_LEVEL_ERROR, LOG_ERROR(PREFIX(format), __LINE__, __func__, ##__VA_ARGS__) )
 #else
 #define RDKSSA_LOG_ERROR(format,  ...)
 #endif
@@ -537,17 +684,17 @@ void _rdkssa_debug_log( const char* fmt, ...);
 
 
 #if defined(USE_COLORS) && defined(RDKSSA_INFO_ENABLED)
-#define RDKSSA_LOG_INFO(format,  ...)              LOG_INFO(PREFIX(COL_YEL"INF:"COL_DEF format),  strrchr(__FILE__,'/')+1,__LINE__, __func__, ##__VA_ARGS__)
+#define RDKSSA_LOG_INFO(format,  ...)              RDKSSA_LOG_IF( RDKSSA_LEVEL_INFO, LOG_INFO(PREFIX(COL_YEL"INF:"COL_DEF format),  RDKSSA_FILE_NAME,__LINE__, __func__, ##__VA_ARGS__) )
 #elif defined(RDKSSA_INFO_ENABLED)
-#define RDKSSA_LOG_INFO(format,  ...)              LOG_INFO(PREFIX(format),  __LINE__, __func__, ##__VA_ARGS__)
+#define RDKSSA_LOG_INFO(format,  ...)              RDKSSA_LOG_IF( RDKSSA_LEVEL_INFO, LOG_INFO(PREFIX(format),  __LINE__, __func__, ##__VA_ARGS__) )
 #else
 #define RDKSSA_LOG_INFO(format,  ...)
 #endif
 
 #if defined(USE_COLORS) && defined(RDKSSA_DEBUG_ENABLED)
-#define RDKSSA_LOG_DEBUG(format, ...)              LOG_DEBUG(PREFIX(COL_BLU"DBG:"COL_DEF format), strrchr(__FILE__,'/')+1,__LINE__, __FUNCTION__, ##__VA_ARGS__)
+#define RDKSSA_LOG_DEBUG(format, ...)              RDKSSA_LOG_IF( RDKSSA_LEVEL_DEBUG, LOG_DEBUG(PREFIX(COL_BLU"DBG:"COL_DEF format), RDKSSA_FILE_NAME,__LINE__, __FUNCTION__, ##__VA_ARGS__) )
 #elif defined(RDKSSA_DEBUG_ENABLED)
-#define RDKSSA_LOG_DEBUG(format,  ...)             LOG_DEBUG(PREFIX(format),  __LINE__, __func__, ##__VA_ARGS__)
+#define RDKSSA_LOG_DEBUG(format,  ...)             RDKSSA_LOG_IF( RDKSSA_LEVEL_DEBUG, LOG_DEBUG(PREFIX(format),  __LINE__, __func__, ##__VA_ARGS__) )
 #else
 #define RDKSSA_LOG_DEBUG(format, ...)
 #endif /* RDKSSA_DEBUG_ENABLED */
@@ -563,6 +710,20 @@ int rdkssaExecvIO( char *exargv[], rdkssa_blobptr_t, void(*callback)(rdkssa_blob
 void rdkssaCleanupVector( char ***v );
 const char *rdkssaAttrCheck( const char *valueStr );
 
+/**
+ * optional persistent helper process, see ssaHelper.c
+ * once started, rdkssaExecv and provider helper launches are handed to the worker
+ * (started as "<helperPath> --helper") instead of being forked from the caller
+ */
+#ifndef RDKSSA_HELPER_PATH
+#define RDKSSA_HELPER_PATH                          "/usr/bin/ssacli"
+#endif
+#define RDKSSA_HELPER_ARG                           "--helper"
+#define RDKSSA_HELPER_FD                            (3)
+rdkssaStatus_t rdkssaHelperStart( const char *helperPath );    // NULL for RDKSSA_HELPER_PATH
+void rdkssaHelperStop( void );
+int rdkssaHelperServe( int sock );                             // worker main loop, exit code
+
 /**
  ** 
  ** Common definitions for all provider components and SSA clients
@@ -16,10 +16,21 @@
  * SPDX-License-Identifier: Apache-2.0
 */
 
+#define _GNU_SOURCE     // pipe2
 #include <unistd.h>
 #include <string.h>
+#include <strings.h>
 #include <sys/wait.h>
-#include <stdarg.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <spawn.h>
+#include <pthread.h>
 
 #include "rdkssa.h"
 #include "rdkssaCommonProtected.h"
@@ -27,26 +38,198 @@
 
 #define NSPR( s ) ((s)?(s):"(null)")  // null string protect
 
-#ifdef RDKSSA_LOG_FILE
-void _rdkssa_debug_log( const char* fmt, ...) {
-    FILE* debug_file = NULL;
-    va_list va;
+// runtime log level, see rdkssa.h
+int rdkssaLogLevel = RDKSSA_LOG_LEVEL_DEFAULT;
 
-    va_start(va,fmt);
-    debug_file = fopen(RDKSSA_DEBUG_LOG_FILE_NAME, "a" );
-    if (debug_file != NULL) {
-        vfprintf(debug_file,fmt,va);
-        fflush(debug_file);
-        fclose(debug_file);
+// NONE, ERROR, INFO, DEBUG (any case, leading blanks ok) or 0..3; -1 if not a level
+static int logLevelParse( const char *str ) {
+    static const char * const names[] = { "NONE", "ERROR", "INFO", "DEBUG" };
+    size_t len;
+    int lvl;
+
+    if ( str == NULL ) return -1;
+    str += strspn( str, " \t" );
+    len = strcspn( str, " \t\r\n" );
+    if ( len == 1 && str[0] >= '0' && str[0] <= '0' + RDKSSA_LEVEL_DEBUG ) {
+        return str[0] - '0';
     }
-    else{
-       fprintf(stderr,"ERROR!!! rdkssa debug log file not set \n");
+    for ( lvl = RDKSSA_LEVEL_NONE; lvl <= RDKSSA_LEVEL_DEBUG; lvl++ ) {
+        if ( len == strlen( names[lvl] ) && strncasecmp( str, names[lvl], len ) == 0 ) {
+            return lvl;
+        }
     }
+    return -1;
+}
+
+// pick the level once when the library is loaded
+__attribute__((constructor))
+static void logLevelInit( void ) {
+    char buf[16];
+    FILE *f;
+    int lvl = logLevelParse( getenv( "RDKSSA_LOG_LEVEL" ) );
 
-    va_end(va);
+    if ( lvl < 0 && ( f = fopen( RDKSSA_LOG_LEVEL_FILE, "re" ) ) != NULL ) {
+        if ( fgets( buf, sizeof(buf), f ) != NULL ) {
+            lvl = logLevelParse( buf );
+        }
+        fclose( f );
+    }
+    if ( lvl >= 0 ) {
+        rdkssaLogLevel = lvl;
+    }
 }
 
-#endif
+/**
+ * helper environment
+ *
+ * environ may be changed by setenv() in another thread while a helper is being started, so helpers get a
+ * copy taken when the library is loaded.  If the copy can not be made, environ is used as before.
+ */
+static char **helperEnv;
+
+__attribute__((constructor))
+static void helperEnvInit( void ) {
+    extern char** environ;
+    size_t n = 0, i;
+
+    while ( environ != NULL && environ[n] != NULL ) n++;
+    char **env = calloc( n + 1, sizeof(char *) );
+    if ( env == NULL ) return;
+    for ( i = 0; i < n; i++ ) {
+        if ( ( env[i] = strdup( environ[i] ) ) == NULL ) {
+            while ( i-- > 0 ) free( env[i] );
+            free( env );
+            return;
+        }
+    }
+    helperEnv = env;
+}
+
+char * const *rdkssaHelperEnv( void ) {
+    extern char** environ;
+    return ( helperEnv != NULL ) ? helperEnv : environ;
+}
+
+// SIGPIPE held off while writing to a helper's pipe, so a helper that exits early gives EPIPE instead
+typedef struct {
+    sigset_t pipeSet, oldSet;
+    int wasPending;                                 // not ours to consume
+} sigpipe_guard_t;
+
+static void sigpipeBlock( sigpipe_guard_t *g ) {
+    sigset_t pending;
+
+    sigemptyset( &g->pipeSet );
+    sigaddset( &g->pipeSet, SIGPIPE );
+    sigpending( &pending );
+    g->wasPending = sigismember( &pending, SIGPIPE );
+    pthread_sigmask( SIG_BLOCK, &g->pipeSet, &g->oldSet );
+}
+
+// undo sigpipeBlock, dropping the SIGPIPE that an EPIPE raised; errno set to err
+static void sigpipeRestore( sigpipe_guard_t *g, int err ) {
+    if ( err == EPIPE && !g->wasPending ) {
+        struct timespec zero = { 0, 0 };
+        while ( sigtimedwait( &g->pipeSet, NULL, &zero ) < 0 && errno == EINTR ) {}
+    }
+    pthread_sigmask( SIG_SETMASK, &g->oldSet, NULL );
+    errno = err;
+}
+
+// write all of buf, SIGPIPE held off by the caller; 0 or errno
+static int writeAllBlocked( int fd, const char *p, size_t len ) {
+    ssize_t n;
+
+    while ( len > 0 ) {
+        n = write( fd, p, len );
+        if ( n < 0 ) {
+            if ( errno == EINTR ) continue;
+            return errno;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// rdkssaWriteAll - write a whole buffer to a helper's pipe without risking SIGPIPE
+int rdkssaWriteAll( int fd, const void *buf, size_t len ) {
+    sigpipe_guard_t guard;
+    int err;
+
+    sigpipeBlock( &guard );
+    err = writeAllBlocked( fd, buf, len );
+    sigpipeRestore( &guard, err );
+    return err ? -1 : 0;
+}
+
+// rdkssaCopyFd - stream inFd to a helper's pipe until EOF, spliced in the kernel where the fds allow it
+int rdkssaCopyFd( int outFd, int inFd, size_t limit, size_t *copied ) {
+    sigpipe_guard_t guard;
+    char *chunk = NULL, probe = 0;
+    int err = 0, useSplice = 1;
+    size_t total = 0, want = limit + 1;     // one byte past the limit, to tell a source of exactly limit bytes from a longer one
+    struct stat st;
+    off_t pos;
+    ssize_t n;
+
+    // a regular file's length is known: stop there, not at an EOF probe the helper may no longer be reading for
+    if ( fstat( inFd, &st ) == 0 && S_ISREG( st.st_mode ) && ( pos = lseek( inFd, 0, SEEK_CUR ) ) >= 0 ) {
+        if ( st.st_size - pos > (off_t)limit ) {
+            if ( copied != NULL ) {
+                *copied = 0;
+            }
+            errno = EFBIG;
+            return -1;
+        }
+        want = ( st.st_size > pos ) ? (size_t)( st.st_size - pos ) : 0;
+    }
+    sigpipeBlock( &guard );
+    while ( total < want ) {
+        if ( useSplice ) {
+            n = splice( inFd, NULL, outFd, NULL, want - total, SPLICE_F_MOVE );
+            if ( n < 0 && ( errno == EINVAL || errno == ENOSYS ) && total == 0 ) {
+                useSplice = 0;                      // e.g. a tty, or no splice: copy through a locked buffer
+                if ( ( chunk = rdkssaSecAlloc( RDKSSA_COPY_CHUNK ) ) == NULL ) {
+                    err = ENOMEM;
+                    break;
+                }
+                continue;
+            }
+            // the pipe's readers are checked before the source: a reader that has its key and is gone is no error at EOF
+            if ( n < 0 && errno == EPIPE ) {
+                if ( read( inFd, &probe, 1 ) == 0 ) {
+                    break;
+                }
+                errno = EPIPE;
+            }
+        } else {
+            n = read( inFd, chunk, ( want - total < RDKSSA_COPY_CHUNK ) ? want - total : RDKSSA_COPY_CHUNK );
+            if ( n > 0 && ( err = writeAllBlocked( outFd, chunk, (size_t)n ) ) != 0 ) {
+                break;
+            }
+        }
+        if ( n < 0 ) {
+            if ( errno == EINTR ) continue;
+            err = errno;
+            break;
+        }
+        if ( n == 0 ) {
+            break;
+        }
+        total += (size_t)n;
+    }
+    RDKSSA_WIPE( &probe, sizeof( probe ) );
+    rdkssaSecFree( chunk );
+    if ( err == 0 && total > limit ) {
+        err = EFBIG;
+    }
+    if ( copied != NULL ) {
+        *copied = total;
+    }
+    sigpipeRestore( &guard, err );
+    return err ? -1 : 0;
+}
 
 // rdkssa_memwipe - clear memory
 void rdkssa_memwipe( volatile void *mem, size_t sz ) {
@@ -54,7 +237,7 @@ void rdkssa_memwipe( volatile void *mem, size_t sz ) {
         RDKSSA_LOG_ERROR("NULL ptr passed \n");
         return;
     }
-    memset( (void *)mem, 0, sz );
+    RDKSSA_WIPE( mem, sz );
     return;
 }
 
@@ -89,91 +272,375 @@ void rdkssaCleanupVector( char ***v )
 }
 
 
-// safe exec calls
-int rdkssaExecv( char *exargv[] ) {
-    if( exargv == NULL || exargv[0] == NULL) {
-        RDKSSA_LOG_ERROR("NULL ptr passed\n");
-        return 1;
-    }
-    extern char** environ; // existing env vars
+/**
+ * Helper process launch
+ *
+ * fork() copies the caller's page tables, which takes time in proportion to its RSS and can fail under
+ * strict overcommit on gateways.  posix_spawn (glibc: clone with CLONE_VM|CLONE_VFORK) runs the child in the
+ * parent's memory until the exec instead; stdin redirection is done with spawn file actions.
+ * Build with RDKSSA_USE_POSIX_SPAWN to launch helpers that way.  Either way a helper that can not be executed
+ * is reported like a child that exited with status 255.
+ */
+#ifdef RDKSSA_USE_POSIX_SPAWN
+#define RDKSSA_SPAWN_DEFAULT    (1)
+#else
+#define RDKSSA_SPAWN_DEFAULT    (0)
+#endif
+#define SPAWN_FAILED            (-1)    // no child: fork/spawn resources
+#define SPAWN_NOEXEC            (-2)    // no child: posix_spawn could not exec the helper
+#define SPAWN_NOEXEC_STATUS     (255)   // what exit( -1 ) in a forked child looks like
+
+// start exargv[0]; stdinFd (if >= 0) becomes its stdin and closeFd (if >= 0) is closed in the child
+// returns the child's pid, SPAWN_FAILED or SPAWN_NOEXEC
+static pid_t spawnHelper( const char * const exargv[], int stdinFd, int closeFd, int usePosixSpawn ) {
+    char * const *env = rdkssaHelperEnv();
+    pid_t pid;
     int ret;
-    int pid = fork ();
-    if (pid == 0) {
+
+    if ( usePosixSpawn ) {
+        posix_spawn_file_actions_t actions;
+        if ( posix_spawn_file_actions_init( &actions ) != 0 ) {
+            RDKSSA_LOG_ERROR( "  spawn actions error\n" );
+            return SPAWN_FAILED;
+        }
+        ret = 0;
+        if ( stdinFd >= 0 ) ret = posix_spawn_file_actions_adddup2( &actions, stdinFd, 0 );
+        if ( ret == 0 && closeFd >= 0 ) ret = posix_spawn_file_actions_addclose( &actions, closeFd );
+        if ( ret == 0 ) ret = posix_spawn( &pid, exargv[0], &actions, NULL, (char * const *)exargv, env );
+        posix_spawn_file_actions_destroy( &actions );
+        if ( ret != 0 ) {
+            RDKSSA_LOG_ERROR( "  posix_spawn for %s returned %d\n", NSPR(exargv[0]), ret );
+            return ( ret == EAGAIN || ret == ENOMEM ) ? SPAWN_FAILED : SPAWN_NOEXEC;
+        }
+        return pid;
+    }
+
+    pid = fork();
+    if ( pid == -1 ) {
+        RDKSSA_LOG_ERROR( "  fork error\n" );
+        return SPAWN_FAILED;
+    }
+    if ( pid == 0 ) {
         // child process -- execute from argv
-        ret = execve( exargv[0], exargv, environ );
-        RDKSSA_LOG_ERROR( "  execve for %s returned %d\n", NSPR(exargv[0]), ret );
-        exit( -1 );
+        // other threads may have held locks at the fork: only async-signal-safe calls from here on
+        if ( stdinFd >= 0 ) dup2( stdinFd, 0 );
+        if ( closeFd >= 0 ) close( closeFd );
+        execve( exargv[0], (char * const *)exargv, env );
+        _exit( SPAWN_NOEXEC_STATUS );
     }
+    return pid;
+}
+
+// wait for a helper started by spawnHelper, return its exit status (rdkssaGeneralFailure if it was killed)
+static int waitHelper( pid_t pid ) {
     int status;
-	
-    ret = waitpid (pid, &status, 0);
+    int ret;
+
+    do {
+        ret = waitpid( pid, &status, 0 );
+    } while ( ret == -1 && errno == EINTR );
     if (ret == -1) {
-        RDKSSA_LOG_ERROR( "    execv wait error %d\n", ret );
+        // ECHILD: reaped by someone else (SIGCHLD ignored, or waitpid(-1) in the application)
+        RDKSSA_LOG_ERROR( "    execv wait error %d\n", errno );
+        return rdkssaGeneralFailure;
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : rdkssaGeneralFailure;
+}
+
+/**
+ * Helper completion handles
+ *
+ * A started helper is tracked by an rdkssaExec_t whose fd becomes readable when the helper exits: a pidfd
+ * where the kernel has pidfd_open (5.3+), otherwise the read end of a self-pipe written by a small waiter
+ * thread blocked in waitpid.  rdkssaExecWait bounds the wait; on timeout the helper is killed with SIGKILL.
+ * A helper stuck in uninterruptible I/O may not die at once; after RDKSSA_EXEC_KILL_GRACE_MS it is left to
+ * be reaped by a detached thread, so the caller still gets rdkssaTimeout in bounded time.
+ */
+#define RDKSSA_EXEC_KILL_GRACE_MS   (1000)
+
+struct rdkssaExec {
+    pid_t pid;
+    int fd;             // pidfd, or read end of the waiter's self-pipe
+    int notifyFd;       // waiter's write end, -1 with a pidfd
+    pthread_t waiter;
+    int status;         // exit status, set by the waiter
+    int state;          // waiter done / handle abandoned, whoever comes second frees
+};
+
+static int execUsePidfd = 1;    // cleared once if pidfd_open is missing, and by the unit tests
+
+static void execFree( rdkssaExec_t *exec ) {
+    close( exec->fd );
+    if ( exec->notifyFd >= 0 ) close( exec->notifyFd );
+    free( exec );
+}
+
+static void *execWaiter( void *arg ) {
+    rdkssaExec_t *exec = arg;
+    ssize_t n;
+    exec->status = waitHelper( exec->pid );
+    do {
+        n = write( exec->notifyFd, "", 1 );
+    } while ( n < 0 && errno == EINTR );
+    if ( __atomic_exchange_n( &exec->state, 1, __ATOMIC_ACQ_REL ) ) {
+        execFree( exec );   // handle was abandoned
+    }
+    return NULL;
+}
+
+static void *execReaper( void *arg ) {
+    waitHelper( (pid_t)(intptr_t)arg );
+    return NULL;
+}
+
+// start a helper with a completion handle; pid from spawnHelper on failure (SPAWN_FAILED, SPAWN_NOEXEC)
+static pid_t execStart( const char * const exargv[], int stdinFd, rdkssaExec_t **execOut ) {
+    rdkssaExec_t *exec = calloc( 1, sizeof(*exec) );
+    int fds[2] = { -1, -1 };
+
+    if ( exec == NULL ) {
+        return SPAWN_FAILED;
+    }
+    exec->notifyFd = -1;
+    int usePidfd = __atomic_load_n( &execUsePidfd, __ATOMIC_RELAXED );
+    if ( !usePidfd && pipe2( fds, O_CLOEXEC ) != 0 ) {
+        free( exec );
+        return SPAWN_FAILED;
+    }
+    exec->pid = spawnHelper( exargv, stdinFd, -1, RDKSSA_SPAWN_DEFAULT );
+    if ( exec->pid < 0 ) {
+        pid_t ret = exec->pid;
+        if ( fds[0] >= 0 ) { close( fds[0] ); close( fds[1] ); }
+        free( exec );
         return ret;
-    } else if (ret != pid) {
-        RDKSSA_LOG_ERROR( "    execv child process NOT done: %d, status %d\n", ret, status );
-        return 1; // error
     }
-    if (WIFEXITED(status)) {
-        ret = WEXITSTATUS(status);
+    exec->fd = -1;
+#ifdef SYS_pidfd_open
+    if ( usePidfd ) {
+        exec->fd = (int)syscall( SYS_pidfd_open, exec->pid, 0 );
+        if ( exec->fd < 0 ) {
+            __atomic_store_n( &execUsePidfd, 0, __ATOMIC_RELAXED );   // old kernel, from now on use the waiter
+            RDKSSA_LOG_INFO( "  pidfd_open not available (%d)\n", errno );
+        }
     }
-    return ret;
+#endif
+    if ( exec->fd < 0 ) {
+        if ( fds[0] < 0 && pipe2( fds, O_CLOEXEC ) != 0 ) {
+            fds[0] = -1;
+        }
+        if ( fds[0] >= 0 ) {
+            exec->fd = fds[0];
+            exec->notifyFd = fds[1];
+            if ( pthread_create( &exec->waiter, NULL, execWaiter, exec ) != 0 ) {
+                exec->fd = -1;
+                close( fds[0] );
+                close( fds[1] );
+            }
+        }
+        if ( exec->fd < 0 ) {
+            RDKSSA_LOG_ERROR( "  no completion handle for pid %d\n", (int)exec->pid );
+            kill( exec->pid, SIGKILL );
+            waitHelper( exec->pid );
+            free( exec );
+            return SPAWN_FAILED;
+        }
+    } else if ( fds[0] >= 0 ) {
+        close( fds[0] );
+        close( fds[1] );
+    }
+    *execOut = exec;
+    return exec->pid;
 }
 
-// safe exec with IO redirection (this may need synchronization!)
-// should be in protected directory. Move later.
-rdkssaStatus_t rdkssaExecvPipeOutput(const char *exargv[], rdkssa_blobptr_t callerBlob, rdkssaIOCallback callback ) {
-	int ret;
-	extern char** environ; // existing env vars
+// wait up to timeoutMs (< 0: forever) for the handle's fd, 1 if the helper is done, 0 on timeout
+static int execPoll( rdkssaExec_t *exec, int timeoutMs ) {
+    struct pollfd pfd = { exec->fd, POLLIN, 0 };
+    struct timespec now, end;
+    int ret, left = timeoutMs;
+
+    clock_gettime( CLOCK_MONOTONIC, &end );
+    end.tv_sec += timeoutMs / 1000;
+    end.tv_nsec += ( timeoutMs % 1000 ) * 1000000L;
+    if ( end.tv_nsec >= 1000000000L ) { end.tv_sec++; end.tv_nsec -= 1000000000L; }
+    for ( ;; ) {
+        ret = poll( &pfd, 1, left );
+        if ( ret >= 0 || errno != EINTR ) {
+            return ret > 0;
+        }
+        if ( timeoutMs >= 0 ) {
+            clock_gettime( CLOCK_MONOTONIC, &now );
+            left = (int)( ( end.tv_sec - now.tv_sec ) * 1000 + ( end.tv_nsec - now.tv_nsec ) / 1000000L );
+            if ( left < 0 ) left = 0;
+        }
+    }
+}
 
-	if( exargv == NULL || exargv[0] == NULL || callback == NULL ) {
+// collect the exit status of a finished helper and release the handle
+static int execReap( rdkssaExec_t *exec ) {
+    int status;
+    if ( exec->notifyFd >= 0 ) {
+        pthread_join( exec->waiter, NULL );
+        status = exec->status;
+    } else {
+        status = waitHelper( exec->pid );
+    }
+    execFree( exec );
+    return status;
+}
+
+// give up on a killed helper that is still running; it is reaped in the background
+static void execAbandon( rdkssaExec_t *exec ) {
+    pthread_attr_t attr;
+    pthread_t tid;
+
+    if ( exec->notifyFd >= 0 ) {
+        pthread_detach( exec->waiter );
+        if ( __atomic_exchange_n( &exec->state, 1, __ATOMIC_ACQ_REL ) ) {
+            execFree( exec );   // waiter finished meanwhile
+        }
+        return;
+    }
+    pthread_attr_init( &attr );
+    pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+    if ( pthread_create( &tid, &attr, execReaper, (void *)(intptr_t)exec->pid ) != 0 ) {
+        RDKSSA_LOG_ERROR( "  pid %d left unreaped\n", (int)exec->pid );
+    }
+    pthread_attr_destroy( &attr );
+    close( exec->fd );
+    free( exec );
+}
+
+int rdkssaExecFd( const rdkssaExec_t *exec ) {
+    return ( exec == NULL ) ? -1 : exec->fd;
+}
+
+int rdkssaExecWait( rdkssaExec_t *exec, int timeoutMs ) {
+    if ( exec == NULL ) {
+        RDKSSA_LOG_ERROR("NULL ptr passed\n");
+        return rdkssaBadPointer;
+    }
+    if ( execPoll( exec, timeoutMs ) ) {
+        return execReap( exec );
+    }
+    RDKSSA_LOG_ERROR( "  helper pid %d timed out after %d ms, killing it\n", (int)exec->pid, timeoutMs );
+    kill( exec->pid, SIGKILL );
+    if ( execPoll( exec, RDKSSA_EXEC_KILL_GRACE_MS ) ) {
+        execReap( exec );
+    } else {
+        RDKSSA_LOG_ERROR( "  helper pid %d did not exit, reaping it in the background\n", (int)exec->pid );
+        execAbandon( exec );
+    }
+    return rdkssaTimeout;
+}
+
+// run a helper from this process and wait for it, also what the helper process worker runs
+int rdkssaExecvLocal( const char * const exargv[], int stdinFd, int timeoutMs ) {
+    rdkssaExec_t *exec = NULL;
+    pid_t pid;
+
+    if ( timeoutMs < 0 ) {
+        pid = spawnHelper( exargv, stdinFd, -1, RDKSSA_SPAWN_DEFAULT );
+    } else {
+        pid = execStart( exargv, stdinFd, &exec );
+    }
+    if ( pid == SPAWN_NOEXEC ) {
+        return SPAWN_NOEXEC_STATUS;
+    } else if ( pid < 0 ) {
+        return rdkssaGeneralFailure;
+    }
+    return ( exec == NULL ) ? waitHelper( pid ) : rdkssaExecWait( exec, timeoutMs );
+}
+
+// safe exec calls
+int rdkssaExecv( char *exargv[] ) {
+    int status;
+    if( exargv == NULL || exargv[0] == NULL) {
+        RDKSSA_LOG_ERROR("NULL ptr passed\n");
+        return 1;
+    }
+    if ( rdkssaHelperExec( (const char * const *)exargv, -1, -1, &status ) == 0 ) {
+        return status;
+    }
+    return rdkssaExecvLocal( (const char * const *)exargv, -1, -1 );
+}
+
+// safe exec with IO redirection, started without waiting
+rdkssaStatus_t rdkssaExecvPipeOutputAsync( const char *exargv[], rdkssa_blobptr_t callerBlob, rdkssaIOCallback callback, rdkssaExec_t **exec ) {
+	rdkssaStatus_t ret;
+
+	if( exargv == NULL || exargv[0] == NULL || callback == NULL || exec == NULL ) {
 		RDKSSA_LOG_ERROR("NULL ptr passed\n");
 		return rdkssaBadPointer;
 	}
+	*exec = NULL;
 
 	int fds[2];                      // an array that will hold two file descriptors
-	if ( pipe(fds) == -1 ) {    // populates fds with two file descriptors
+	if ( pipe2( fds, O_CLOEXEC ) == -1 ) {    // populates fds with two file descriptors
 		RDKSSA_LOG_ERROR( "  pipe failed\n" );
 		return rdkssaGeneralFailure;
 	}
 
-	pid_t pid = fork();              // create child process that is a clone of the parent
-	if ( pid == -1 ) {
-		RDKSSA_LOG_ERROR("  fork error\n");
-		return rdkssaGeneralFailure;
-	}
-
-	if (pid == 0) {
-		// child process -- execute from argv
-		dup2(fds[0],0);    
-		close(fds[1]);		// is that right?
-		ret = execve( exargv[0],(char* const*) exargv, environ );  // reads from parent stdout
-		RDKSSA_LOG_ERROR( "  execve for %s returned %d\n", NSPR(exargv[0]), ret );
-		exit( ret );
+	// child reads the pipe as its stdin
+	pid_t pid = execStart( exargv, fds[0], exec );
+	close( fds[0] );						// for redirected input use popen
+	if ( pid < 0 ) {
+		close( fds[1] );
+		return ( pid == SPAWN_NOEXEC ) ? SPAWN_NOEXEC_STATUS : rdkssaGeneralFailure;
 	}
 	// parent
-	close( fds[0] );						// for redirected input use popen
-	callback(fds[1],callerBlob);			// callback function writes stdout
+	ret = callback(fds[1],callerBlob);		// callback function writes stdout
+	close( fds[1] );						// helper sees the end of its input
+	if ( ret != rdkssaOK ) {
+		RDKSSA_LOG_ERROR( "  callback failed (%d), stopping %s\n", ret, exargv[0] );
+		kill( pid, SIGKILL );
+		rdkssaExecWait( *exec, -1 );
+		*exec = NULL;
+	}
+	return ret;
+}
 
-	int status;
-	ret = waitpid (pid, &status, 0);
+// safe exec with IO redirection, waits up to timeoutMs (< 0: forever)
+int rdkssaExecvPipeOutputTimeout( const char *exargv[], rdkssa_blobptr_t callerBlob, rdkssaIOCallback callback, int timeoutMs ) {
+	rdkssaExec_t *exec;
+	rdkssaStatus_t ret;
+
+	// helper process mode: the callback fills the pipe first, then the worker gets the read end.
+	// The write end is non-blocking so output larger than the pipe buffer fails instead of hanging.
+	if ( rdkssaHelperActive() && exargv != NULL && exargv[0] != NULL && callback != NULL ) {
+		int fds[2], status;
+		if ( pipe2( fds, O_CLOEXEC ) == -1 ) {
+			RDKSSA_LOG_ERROR( "  pipe failed\n" );
+			return rdkssaGeneralFailure;
+		}
+		fcntl( fds[1], F_SETFL, fcntl( fds[1], F_GETFL ) | O_NONBLOCK );
+		ret = callback( fds[1], callerBlob );
+		close( fds[1] );
+		if ( ret != rdkssaOK ) {
+			RDKSSA_LOG_ERROR( "  callback failed (%d), %s not started\n", ret, exargv[0] );
+			status = ret;
+		} else if ( rdkssaHelperExec( exargv, fds[0], timeoutMs, &status ) != 0 ) {
+			status = rdkssaExecvLocal( exargv, fds[0], timeoutMs );
+		}
+		close( fds[0] );
+		return status;
+	}
 
-	if (ret == -1) {
-		RDKSSA_LOG_ERROR( "    execv wait error %d\n", ret );
+	ret = rdkssaExecvPipeOutputAsync( exargv, callerBlob, callback, &exec );
+	if ( ret != rdkssaOK || exec == NULL ) {
 		return ret;
-	} else if (ret != pid) {
-		RDKSSA_LOG_ERROR( "    execv child process NOT done: %d, status %d\n", ret, status );
-		return 1; // error
 	}
-	if (WIFEXITED(status)) {
-		ret = WEXITSTATUS(status);
-	}
-	return ret;
+	return rdkssaExecWait( exec, timeoutMs );
+}
+
+// safe exec with IO redirection, safe to call from several threads (see Concurrency in rdkssa.h)
+rdkssaStatus_t rdkssaExecvPipeOutput(const char *exargv[], rdkssa_blobptr_t callerBlob, rdkssaIOCallback callback ) {
+	return rdkssaExecvPipeOutputTimeout( exargv, callerBlob, callback, RDKSSA_EXEC_TIMEOUT_MS );
 }
 
 // verfify that attribute string is valid (size, contents)
 // return string if valid, return NULL if not
-const char *rdkssaAttrCheck( const char *valueStr ) {
+// scalar reference version, kept as the fallback and to cross-check attrScan in the unit tests
+const char *rdkssaAttrCheckScalar( const char *valueStr ) {
     const char *retStr = valueStr;
     if ( valueStr == NULL || *valueStr == '\0' ) {
         RDKSSA_LOG_ERROR("  null attribute\n");
@@ -191,6 +658,250 @@ const char *rdkssaAttrCheck( const char *valueStr ) {
     // should we check for whitespace too?
     return retStr;
 }
+
+/**
+ * Single pass attribute scan
+ *
+ * attrStop[] marks every byte that ends a scan: the terminating NUL and each of RDKSSA_BADCHARS.
+ * attrScan returns the offset of the first such byte, or limit if none is found in the first limit bytes,
+ * so the length and the contents of a value are checked with one walk over the string.
+ *
+ * The SSE2/NEON versions screen 16 bytes at a time with a few range compares that cover every stop byte
+ * (below '+', ';' to '@', and '[' to ']' / '{' to '}' folded together by case).  Only a block that trips
+ * the screen is walked with attrStop[], so ordinary path and key values never touch the table.
+ * Loads are 16 byte aligned so they never cross into the next page; they may read past the terminator
+ * within the same block, which is why they are excluded from address sanitizing.
+ * Build with RDKSSA_NO_SIMD to use the table only.
+ */
+// keep in step with RDKSSA_BADCHARS "{}@\\&|*<>[]()$;"
+static const uint8_t attrStop[256] = {
+    ['\0'] = 1,
+    ['{'] = 1, ['}'] = 1, ['@'] = 1, ['\\'] = 1, ['&'] = 1, ['|'] = 1, ['*'] = 1, ['<'] = 1,
+    ['>'] = 1, ['['] = 1, [']'] = 1, ['('] = 1, [')'] = 1, ['$'] = 1, [';'] = 1,
+};
+
+static size_t attrScanTable( const char *str, size_t offset, size_t limit ) {
+    const unsigned char *s = (const unsigned char *)str;
+    while ( offset < limit && !attrStop[s[offset]] ) offset++;
+    return offset;
+}
+
+#if !defined(RDKSSA_NO_SIMD) && ( defined(__SSE2__) || defined(__ARM_NEON) )
+#ifdef __SSE2__
+#include <emmintrin.h>
+#define RDKSSA_ATTR_SIMD "sse2"
+
+// non zero if any byte of the aligned block at p may be a stop byte (signed compares: bytes >= 0x80 trip it too)
+__attribute__((no_sanitize_address))
+static inline int attrBlockSuspect( const char *p ) {
+    __m128i x = _mm_load_si128( (const __m128i *)p );
+    __m128i f = _mm_or_si128( x, _mm_set1_epi8( 0x20 ) );  // '['..']' -> '{'..'}'
+    __m128i hit = _mm_cmplt_epi8( x, _mm_set1_epi8( '+' ) );
+    hit = _mm_or_si128( hit, _mm_and_si128( _mm_cmpgt_epi8( x, _mm_set1_epi8( ':' ) ),
+                                            _mm_cmplt_epi8( x, _mm_set1_epi8( 'A' ) ) ) );
+    hit = _mm_or_si128( hit, _mm_and_si128( _mm_cmpgt_epi8( f, _mm_set1_epi8( 'z' ) ),
+                                            _mm_cmplt_epi8( f, _mm_set1_epi8( '~' ) ) ) );
+    return _mm_movemask_epi8( hit );
+}
+#else
+#include <arm_neon.h>
+#define RDKSSA_ATTR_SIMD "neon"
+
+// non zero if any byte of the aligned block at p may be a stop byte
+__attribute__((no_sanitize_address))
+static inline int attrBlockSuspect( const char *p ) {
+    uint8x16_t x = vld1q_u8( (const uint8_t *)__builtin_assume_aligned( p, 16 ) );
+    uint8x16_t f = vorrq_u8( x, vdupq_n_u8( 0x20 ) );       // '['..']' -> '{'..'}'
+    uint8x16_t hit = vcltq_u8( x, vdupq_n_u8( '+' ) );
+    hit = vorrq_u8( hit, vandq_u8( vcgtq_u8( x, vdupq_n_u8( ':' ) ), vcltq_u8( x, vdupq_n_u8( 'A' ) ) ) );
+    hit = vorrq_u8( hit, vandq_u8( vcgtq_u8( f, vdupq_n_u8( 'z' ) ), vcltq_u8( f, vdupq_n_u8( '~' ) ) ) );
+    uint64x2_t wide = vreinterpretq_u64_u8( hit );
+    return ( vgetq_lane_u64( wide, 0 ) | vgetq_lane_u64( wide, 1 ) ) != 0;
+}
+#endif
+
+static size_t attrScan( const char *str, size_t limit ) {
+    size_t offset, end, i;
+
+    // unaligned head
+    offset = (16 - ((uintptr_t)str & 15)) & 15;
+    if ( offset > limit ) offset = limit;
+    i = attrScanTable( str, 0, offset );
+    if ( i < offset ) return i;
+
+    while ( offset < limit ) {
+        if ( attrBlockSuspect( str + offset ) ) {
+            end = offset + 16 < limit ? offset + 16 : limit;
+            i = attrScanTable( str, offset, end );
+            if ( i < end ) return i;
+        }
+        offset += 16;
+    }
+    return limit;
+}
+
+#else
+#define RDKSSA_ATTR_SIMD "table"
+
+static size_t attrScan( const char *str, size_t limit ) {
+    return attrScanTable( str, 0, limit );
+}
+#endif
+
+// verfify that attribute string is valid (size, contents)
+// return string if valid, return NULL if not
+const char *rdkssaAttrCheck( const char *valueStr ) {
+    size_t stop;
+    if ( valueStr == NULL || *valueStr == '\0' ) {
+        RDKSSA_LOG_ERROR("  null attribute\n");
+        return NULL;
+    }
+    stop = attrScan( valueStr, MAX_ATTRIBUTE_VALUE_LENGTH+1 );
+    if ( stop > MAX_ATTRIBUTE_VALUE_LENGTH ) {
+        RDKSSA_LOG_ERROR("  attribute too long\n");
+        return NULL;
+    }
+    // stopped short of the terminator: bad character
+    if ( valueStr[stop] != '\0' ) {
+        RDKSSA_LOG_ERROR("Bad Character found in attribute [%s]\n", valueStr);
+        return NULL;
+    }
+    // should we check for whitespace too?
+    return valueStr;
+}
+
+// view flavour of rdkssaAttrCheck: the value length is already known, so only the contents are scanned
+const char *rdkssaAttrViewCheck( const rdkssaAttrView_t *view ) {
+    if ( view != NULL && ( view->flags & RDKSSA_ATTRVIEW_CHECKED ) ) {
+        return view->value;     /* checked when the call was prepared */
+    }
+    if ( view == NULL || view->value == NULL || view->valueLen == 0 ) {
+        RDKSSA_LOG_ERROR("  null attribute\n");
+        return NULL;
+    }
+    if ( view->valueLen > MAX_ATTRIBUTE_VALUE_LENGTH ) {
+        RDKSSA_LOG_ERROR("  attribute too long\n");
+        return NULL;
+    }
+    if ( attrScan( view->value, view->valueLen ) != view->valueLen ) {
+        RDKSSA_LOG_ERROR("Bad Character found in attribute [%s]\n", view->value);
+        return NULL;
+    }
+    return view->value;
+}
+
+/**
+ * Attribute views
+ *
+ * Look for an "=" - if found the operation handler is expected to expect the remainder of the string.
+ * e.g. "MY_ATTRIBUTE=123456\0" will call the handler with "123456\0"  -- NOTE: THE ATTRIBUTE NAME WILL NOT BE PASSED
+ * but instead the value is passed.  You can always structure the value to contain the name if necessary, even like
+ * "MY_ATTRIBUTE=MY_ATTRIBUTE:657838234" and parse the value however you want in the handler.  Complete flexibility.
+ *
+ * The name and value are described by a view into the caller's string, nothing is copied.
+ */
+
+// length of the name part (up to "=" or end of string), scans at most MAX_ATTRIBUTE_NAME_LENGTH+1 chars
+static inline size_t attrNameLength( const char *attributeName )
+{
+    const char *p = attributeName;
+    while ( *p != '\0' && *p != VALUE_DELIM && (size_t)(p - attributeName) <= MAX_ATTRIBUTE_NAME_LENGTH ) {
+        p++;
+    }
+    return p - attributeName;
+}
+
+// fill the view given the length of the name part; does the attribute length and syntax checks
+static rdkssaStatus_t attrViewFrom( const char *attributeName, size_t nameLen, rdkssaAttrView_t *view )
+{
+    /* GW: migrate str* calls to use the SafeC library, so this would be: */
+    /* strnlen_s(attributeString, MAX_ATTRIBUTE_NAME_LENGTH) */
+    size_t inputAtrbLength = nameLen + strnlen( attributeName+nameLen, MAX_ATTRIBUTE_NAME_LENGTH+1-nameLen );
+    if ( inputAtrbLength > MAX_ATTRIBUTE_NAME_LENGTH || inputAtrbLength < MIN_ATTRIBUTE_NAME_LENGTH )
+    {
+        RDKSSA_LOG_ERROR("unexpected attribute length %lu\n",(unsigned long)inputAtrbLength);
+        return rdkssaGeneralFailure;
+    }
+    if ( nameLen == 0 ) {
+        RDKSSA_LOG_ERROR("syntax error in attribute (leading =)\n");
+        return rdkssaSyntaxError;
+    }
+    view->name = attributeName;
+    view->nameLen = nameLen;
+    view->flags = 0;
+    if ( attributeName[nameLen] == VALUE_DELIM ) {
+        view->value = attributeName + nameLen + 1;
+        view->valueLen = inputAtrbLength - nameLen - 1;
+    } else {
+        view->value = NULL;
+        view->valueLen = 0;
+    }
+    return rdkssaOK;
+}
+
+/**
+ * rdkssaAttrViewParse - describe "NAME=value" without copying
+ */
+rdkssaStatus_t rdkssaAttrViewParse( const char *attributeName, rdkssaAttrView_t *view )
+{
+    if ( attributeName == NULL || view == NULL ) {
+        RDKSSA_LOG_ERROR("NULL ptr passed\n");
+        return rdkssaBadPointer;
+    }
+    return attrViewFrom( attributeName, attrNameLength( attributeName ), view );
+}
+
+// the table entry name matches the view's name exactly
+static inline int attrNameMatch( const char *attributeNameStr, const rdkssaAttrView_t *view )
+{
+    return strncmp( attributeNameStr, view->name, view->nameLen ) == 0 && attributeNameStr[view->nameLen] == '\0';
+}
+
+// call whichever flavour of handler the table entry has
+static rdkssaStatus_t callAttributeHandler( const AttributeHandlerStruct *entry, rdkssa_blobptr_t apiBlobPtr, const rdkssaAttrView_t *view )
+{
+    rdkssaStatus_t iRet;
+
+    if ( entry->attributeViewOperation != NULL ) {
+        RDKSSA_LOG_DEBUG( "Calling the view func for %s apiBlobPtr(%p)\n", entry->attributeNameStr, apiBlobPtr );
+        iRet = entry->attributeViewOperation( apiBlobPtr, view );
+    } else {
+        /* string handlers get the value, or the whole attribute if there is no "=" */
+        const char *attrPtr = ( view->value != NULL ) ? view->value : view->name;
+        RDKSSA_LOG_DEBUG( "Calling the func for %s with [%s] apiBlobPtr(%p)\n", entry->attributeNameStr, attrPtr, apiBlobPtr );
+        iRet = entry->attributeOperation( apiBlobPtr, attrPtr );
+    }
+    if ( iRet != rdkssaOK ) {
+        RDKSSA_LOG_ERROR("attribute handler for %s failed (%d)\n", view->name, iRet);
+    }
+    return iRet;
+}
+
+// find the table entry for the view's name, NULL if there is none
+static const AttributeHandlerStruct *linearLookup( const AttributeHandlerStruct attributeTable[], const rdkssaAttrView_t *view )
+{
+    int iAttributIterator;
+
+    /* loop over the attribute names in the provided table */
+    for(iAttributIterator = 0;
+            iAttributIterator<MAX_SUPPORTED_ATTRIBUTES && 
+            attributeTable[iAttributIterator].attributeNameStr != NULL;
+            iAttributIterator++)
+    {
+        if(attributeTable[iAttributIterator].attributeOperation == NULL &&
+           attributeTable[iAttributIterator].attributeViewOperation == NULL)
+        {
+            continue;  /* nothing to call.  Reserved for further use */
+        }
+        // GW: TODO: Move to strcmp_s 
+        if( attrNameMatch( attributeTable[iAttributIterator].attributeNameStr, view ) )
+        {
+            return &attributeTable[iAttributIterator];
+        }
+    }
+    return NULL;
+}
+
 /**
  * 
  * my_attributeHandler
@@ -212,91 +923,27 @@ const char *rdkssaAttrCheck( const char *valueStr ) {
  */
 rdkssaStatus_t attributeHandlerHelper(rdkssa_blobptr_t apiBlobPtr, const char *attributeName, const AttributeHandlerStruct attributeTable[])
 {
-    rdkssaStatus_t iRet=rdkssaGeneralFailure;
-    size_t inputAtrbNameLength;
-    int iAttributIterator = 0;
+    rdkssaStatus_t iRet;
+    rdkssaAttrView_t view;
 
     if ( attributeName == NULL || attributeTable == NULL ) 
     {
         RDKSSA_LOG_ERROR("NULL passed to attributeHandlerHelper: (%p, %p)\n", attributeName, attributeTable);
         return rdkssaBadPointer;
     }
-    /* GW: migrate str* calls to use the SafeC library, so this would be: */
-    /* strnlen_s(attributeString, MAX_ATTRIBUTE_NAME_LENGTH) */
-    inputAtrbNameLength = strnlen( attributeName, MAX_ATTRIBUTE_NAME_LENGTH+1 );
-    if(inputAtrbNameLength > MAX_ATTRIBUTE_NAME_LENGTH || inputAtrbNameLength < MIN_ATTRIBUTE_NAME_LENGTH)
-    {
-        RDKSSA_LOG_DEBUG( "attributeHandlerHelper attributeName=[%c%c%c%c...]\n", 
-                   attributeName[0], attributeName[1], attributeName[2], attributeName[3] );
-        RDKSSA_LOG_ERROR("unexpected attribute length %lu\n",(unsigned long)inputAtrbNameLength);
-        return rdkssaGeneralFailure;
+    iRet = attrViewFrom( attributeName, attrNameLength( attributeName ), &view );
+    if ( iRet != rdkssaOK ) {
+        return iRet;
     }
     RDKSSA_LOG_DEBUG( "attributeHandlerHelper attributeName=[%s]\n", attributeName);
 
-    /**
-     * Look for an "=" - if found the operation handler is expected to expect the remainder of the string.
-     * e.g. "MY_ATTRIBUTE=123456\0" will call the handler with "123456\0"  -- NOTE: THE ATTRIBUTE NAME WILL NOT BE PASSED
-     * but instead the value is passed.  You can always structure the value to contain the name if necessary, even like
-     " "MY_ATTRIBUTE=MY_ATTRIBUTE:657838234" and parse the value however you want in the handler.  Complete flexibility.
-     */
-    char copyName[MAX_ATTRIBUTE_NAME_LENGTH];
-    char *eq = strchr(attributeName,'=');
-    const char *attrPtr = attributeName;
-    
-    if ( eq != NULL ) 
-    { 
-        int copyLen = eq-attributeName;
-        if ( copyLen == 0 ) {
-            RDKSSA_LOG_ERROR("syntax error in attribute (leading =)\n");
-            return rdkssaSyntaxError;
-        }
-        /* checks above promise it doesn't exceed max len */
-        memcpy( copyName, attributeName, copyLen );
-        copyName[copyLen] = '\0';
-        attrPtr = copyName;
-    } 
-    RDKSSA_LOG_DEBUG("attributeHandlerHelper attrPtr[%s], eq[%s]\n", (attrPtr?attrPtr:"NULL"), (eq?eq:"NULL"));
-    /* After that bit, attrPtr points to either the original attrb strng or the prefix to the "=" */
-    /* Now, loop over the attribute names in the provided table */
-    for(iAttributIterator = 0;
-            iAttributIterator<MAX_SUPPORTED_ATTRIBUTES && 
-            attributeTable[iAttributIterator].attributeNameStr != NULL;
-            iAttributIterator++)
-    {
-        if(attributeTable[iAttributIterator].attributeOperation == NULL)
-        {
-            continue;  /* nothing to call.  Reserved for further use */
-        }
-
-        // GW: TODO: Move to strcmp_s 
-        // GW: TODO: Use syntax "xxxx=yyyy" and strchr etc to get name from string
-        //if(!strncmp(my_supportedAttributes[iAttributIterator].attributeNameStr, 
-        //          attributeString, inputAtrbNameLength) )
-        if(strncmp(attributeTable[iAttributIterator].attributeNameStr,
-                   attrPtr, 
-                   MAX_ATTRIBUTE_NAME_LENGTH ) != 0 )
-        {
-            continue;   
-        }
-        
-        // it matches this one, execute the function with the rest of the attribute
-        if ( eq != NULL ) 
-        {
-            attrPtr = ++eq; /* now past the "=" */
-        }
-        RDKSSA_LOG_DEBUG( "Calling the func for %s with [%s] apiBlobPtr(%p) attrib handler ptr(%p)\n", attributeTable[iAttributIterator].attributeNameStr,
-                                                   attrPtr, apiBlobPtr, attributeTable[iAttributIterator].attributeOperation );
-
-        iRet = attributeTable[iAttributIterator].attributeOperation(apiBlobPtr, attrPtr);
-        if(iRet != rdkssaOK)
-        {
-            RDKSSA_LOG_ERROR("attribute handler for %s failed (%d)\n", attributeName, iRet);
-        }
-//        RDKSSA_LOG_DEBUG("Ret value [%d]\n", iRet);
-        return iRet;
+    const AttributeHandlerStruct *entry = linearLookup( attributeTable, &view );
+    if ( entry == NULL ) {
+        RDKSSA_LOG_ERROR("Attribute not available [%s]\n", attributeName);
+        return rdkssaAttributeNotFound;
     }
-    RDKSSA_LOG_ERROR("Attribute not available [%s]\n", attributeName);
-    return rdkssaAttributeNotFound;
+    // it matches this one, execute the function with the rest of the attribute
+    return callAttributeHandler( entry, apiBlobPtr, &view );
 }
 
 /**
@@ -324,6 +971,277 @@ rdkssaStatus_t rdkssaHandleAPIHelper( rdkssa_blobptr_t apiBlobPtr, const char *
     return iRetAtr;
 }
 
+/**
+ * Hashed attribute dispatch
+ *
+ * attrNameHash - seeded FNV-1a over the name part of an attribute, stops at '=' or end of string.
+ * The length of the name part is returned in *nameLen, so nobody has to look for the '=' again.
+ */
+static inline uint32_t attrNameHash( const char *name, uint32_t seed, size_t *nameLen )
+{
+    uint32_t h = 2166136261u ^ seed;
+    const char *p = name;
+    while ( *p != '\0' && *p != VALUE_DELIM && (size_t)(p - name) <= MAX_ATTRIBUTE_NAME_LENGTH ) {
+        h ^= (uint8_t)*p++;
+        h *= 16777619u;
+    }
+    *nameLen = p - name;
+    return h ^ ( h >> 15 );
+}
+
+#define INDEX_SEED_TRIES                           (1<<16)
+static pthread_mutex_t indexBuildLock = PTHREAD_MUTEX_INITIALIZER;
+
+// find a seed that puts every reachable table entry in its own slot
+// called once per index, with indexBuildLock held
+static void buildAttributeIndex( AttributeHandlerIndex *idx )
+{
+    const AttributeHandlerStruct *tbl = idx->attributeTable;
+    uint8_t reachable[MAX_SUPPORTED_ATTRIBUTES];
+    uint32_t slots = 8, seed;
+    size_t nameLen;
+    int count, used = 0, i, j;
+
+    /* same rules as the linear scan: skip reserved entries, first of duplicate names wins */
+    for( count=0; count<MAX_SUPPORTED_ATTRIBUTES && tbl[count].attributeNameStr != NULL; count++ ) {
+        reachable[count] = 0;
+        if ( ( tbl[count].attributeOperation == NULL && tbl[count].attributeViewOperation == NULL ) ||
+             strchr( tbl[count].attributeNameStr, VALUE_DELIM ) != NULL ) {
+            continue;
+        }
+        for( j=0; j<count; j++ ) {
+            if ( reachable[j] && strcmp( tbl[j].attributeNameStr, tbl[count].attributeNameStr ) == 0 ) break;
+        }
+        if ( j == count ) {
+            reachable[count] = 1;
+            used++;
+        }
+    }
+    while ( slots < 4*used && slots < RDKSSA_HANDLER_INDEX_SLOTS ) {
+        slots <<= 1;
+    }
+
+    for( seed=1; seed<=INDEX_SEED_TRIES; seed++ ) {
+        memset( idx->slot, 0, sizeof(idx->slot) );
+        for( i=0; i<count; i++ ) {
+            if ( !reachable[i] ) continue;
+            uint32_t h = attrNameHash( tbl[i].attributeNameStr, seed, &nameLen ) & (slots-1);
+            if ( idx->slot[h] != 0 ) break;     /* collision, try the next seed */
+            idx->slot[h] = i+1;
+        }
+        if ( i == count ) {
+            idx->seed = seed;
+            idx->mask = slots-1;
+            RDKSSA_LOG_DEBUG( "attribute index: %d names in %u slots, seed %u\n", used, slots, seed );
+            __atomic_store_n( &idx->state, 1, __ATOMIC_RELEASE );
+            return;
+        }
+    }
+    RDKSSA_LOG_ERROR( "attribute index: no perfect hash for %d names, using linear lookup\n", used );
+    __atomic_store_n( &idx->state, -1, __ATOMIC_RELEASE );
+}
+
+// parse the attribute and find its table entry through the index (built here on first use)
+// *entry is NULL if the name is not in the table
+static rdkssaStatus_t indexedLookup( AttributeHandlerIndex *attributeIndex, const char *attributeName,
+                                     rdkssaAttrView_t *view, const AttributeHandlerStruct **entry )
+{
+    rdkssaStatus_t iRet;
+    size_t nameLen;
+
+    int state = __atomic_load_n( &attributeIndex->state, __ATOMIC_ACQUIRE );
+    if ( state == 0 ) {
+        pthread_mutex_lock( &indexBuildLock );
+        if ( attributeIndex->state == 0 ) {
+            buildAttributeIndex( attributeIndex );
+        }
+        pthread_mutex_unlock( &indexBuildLock );
+        state = __atomic_load_n( &attributeIndex->state, __ATOMIC_ACQUIRE );
+    }
+    *entry = NULL;
+    if ( state < 0 ) {
+        iRet = attrViewFrom( attributeName, attrNameLength( attributeName ), view );
+        if ( iRet == rdkssaOK ) {
+            *entry = linearLookup( attributeIndex->attributeTable, view );
+        }
+        return iRet;
+    }
+
+    uint32_t h = attrNameHash( attributeName, attributeIndex->seed, &nameLen );
+    iRet = attrViewFrom( attributeName, nameLen, view );
+    if ( iRet != rdkssaOK ) {
+        return iRet;
+    }
+    uint8_t slot = attributeIndex->slot[ h & attributeIndex->mask ];
+    /* the slot only says "maybe", the name must still match exactly */
+    if ( slot != 0 && attrNameMatch( attributeIndex->attributeTable[slot-1].attributeNameStr, view ) ) {
+        *entry = &attributeIndex->attributeTable[slot-1];
+    }
+    return rdkssaOK;
+}
+
+/**
+ * attributeIndexedHandlerHelper - same contract as attributeHandlerHelper, using the table's hash index
+ */
+rdkssaStatus_t attributeIndexedHandlerHelper(rdkssa_blobptr_t apiBlobPtr, const char *attributeName, AttributeHandlerIndex *attributeIndex)
+{
+    rdkssaStatus_t iRet;
+    rdkssaAttrView_t view;
+    const AttributeHandlerStruct *entry;
+
+    if ( attributeName == NULL || attributeIndex == NULL || attributeIndex->attributeTable == NULL )
+    {
+        RDKSSA_LOG_ERROR("NULL passed to attributeIndexedHandlerHelper: (%p, %p)\n", attributeName, attributeIndex);
+        return rdkssaBadPointer;
+    }
+    iRet = indexedLookup( attributeIndex, attributeName, &view, &entry );
+    if ( iRet != rdkssaOK ) {
+        return iRet;
+    }
+    if ( entry == NULL ) {
+        RDKSSA_LOG_ERROR("Attribute not available [%s]\n", attributeName);
+        return rdkssaAttributeNotFound;
+    }
+    return callAttributeHandler( entry, apiBlobPtr, &view );
+}
+
+/**
+ * rdkssaHandleAPIIndexedHelper - same contract as rdkssaHandleAPIHelper, using the table's hash index
+ */
+rdkssaStatus_t rdkssaHandleAPIIndexedHelper( rdkssa_blobptr_t apiBlobPtr, const char * const attributes[], AttributeHandlerIndex *attributeIndex)
+{
+    rdkssaStatus_t iRetAtr = rdkssaAttributeNotFound;
+
+    if ( attributeIndex == NULL || attributes == NULL ) {
+        RDKSSA_LOG_ERROR("NULL param passed (, %p, %p)\n", attributes, attributeIndex);
+        return rdkssaBadPointer;
+    }
+
+    int i;
+    for( i=0; i < MAX_SUPPORTED_ATTRIBUTES && attributes[i] != NULL; i++ ) {
+        iRetAtr = attributeIndexedHandlerHelper(apiBlobPtr, attributes[i], attributeIndex);
+        if ( iRetAtr != rdkssaOK ) { break; }
+    }
+    return iRetAtr;
+}
+
+/**
+ * Prepared calls
+ */
+#define RDKSSA_PREPARED_MAGIC                      (0x52505243)  /* "RPRC" */
+
+typedef struct {
+    const AttributeHandlerStruct *entry;
+    rdkssaAttrView_t view;                  /* points into strings[] below */
+} preparedAttr_t;
+
+typedef struct {
+    uint32_t magic;
+    int      count;
+    size_t   size;                          /* of the whole allocation, for the wipe */
+    const AttributeHandlerStruct *attributeTable;   /* the API this call was prepared for */
+    preparedAttr_t attr[MAX_SUPPORTED_ATTRIBUTES];
+    char     strings[];                     /* copies of the attribute strings */
+} preparedCall_t;
+
+rdkssaStatus_t rdkssaPrepareAPIHelper( const char * const attributes[], AttributeHandlerIndex *attributeIndex, rdkssa_handle_t *preparedCall )
+{
+    size_t attrLen[MAX_SUPPORTED_ATTRIBUTES];
+    size_t total = 0;
+    rdkssaStatus_t iRet;
+    int n, i;
+
+    if ( attributes == NULL || attributeIndex == NULL || attributeIndex->attributeTable == NULL || preparedCall == NULL ) {
+        RDKSSA_LOG_ERROR("NULL param passed (%p, %p, %p)\n", attributes, attributeIndex, preparedCall);
+        return rdkssaBadPointer;
+    }
+    *preparedCall = NULL;
+
+    for( n=0; n < MAX_SUPPORTED_ATTRIBUTES && attributes[n] != NULL; n++ ) {
+        attrLen[n] = strnlen( attributes[n], MAX_ATTRIBUTE_NAME_LENGTH+1 );
+        if ( attrLen[n] > MAX_ATTRIBUTE_NAME_LENGTH ) {
+            RDKSSA_LOG_ERROR("unexpected attribute length %lu\n",(unsigned long)attrLen[n]);
+            return rdkssaGeneralFailure;
+        }
+        total += attrLen[n] + 1;
+    }
+
+    preparedCall_t *prep = calloc( 1, sizeof(preparedCall_t) + total );
+    if ( prep == NULL ) {
+        RDKSSA_LOG_ERROR("prepared call allocation failure\n");
+        return rdkssaGeneralFailure;
+    }
+    prep->magic = RDKSSA_PREPARED_MAGIC;
+    prep->size = sizeof(preparedCall_t) + total;
+    prep->attributeTable = attributeIndex->attributeTable;
+    prep->count = n;
+
+    char *str = prep->strings;
+    for( i=0; i<n; i++ ) {
+        memcpy( str, attributes[i], attrLen[i] );
+        str[attrLen[i]] = '\0';
+        iRet = indexedLookup( attributeIndex, str, &prep->attr[i].view, &prep->attr[i].entry );
+        if ( iRet != rdkssaOK ) {
+            goto prepFailed;
+        }
+        if ( prep->attr[i].entry == NULL ) {
+            RDKSSA_LOG_ERROR("Attribute not available [%s]\n", str);
+            iRet = rdkssaAttributeNotFound;
+            goto prepFailed;
+        }
+        /* view handlers check their values; do it here once instead of on every execution */
+        if ( prep->attr[i].entry->attributeViewOperation != NULL && prep->attr[i].view.value != NULL ) {
+            if ( rdkssaAttrViewCheck( &prep->attr[i].view ) == NULL ) {
+                iRet = rdkssaValidityError;
+                goto prepFailed;
+            }
+            prep->attr[i].view.flags |= RDKSSA_ATTRVIEW_CHECKED;
+        }
+        str += attrLen[i] + 1;
+    }
+    *preparedCall = (rdkssa_handle_t)prep;
+    return rdkssaOK;
+
+prepFailed:
+    rdkssaReleasePrepared( (rdkssa_handle_t *)&prep );
+    return iRet;
+}
+
+rdkssaStatus_t rdkssaExecutePreparedHelper( rdkssa_blobptr_t apiBlobPtr, rdkssa_handle_t preparedCall, AttributeHandlerIndex *attributeIndex )
+{
+    preparedCall_t *prep = (preparedCall_t *)preparedCall;
+    rdkssaStatus_t iRetAtr = rdkssaAttributeNotFound;
+    int i;
+
+    if ( prep == NULL || attributeIndex == NULL ) {
+        RDKSSA_LOG_ERROR("NULL param passed (%p, %p)\n", preparedCall, attributeIndex);
+        return rdkssaBadPointer;
+    }
+    if ( prep->magic != RDKSSA_PREPARED_MAGIC || prep->attributeTable != attributeIndex->attributeTable ) {
+        RDKSSA_LOG_ERROR("prepared call does not belong to this API\n");
+        return rdkssaBadPointer;
+    }
+    for( i=0; i<prep->count; i++ ) {
+        iRetAtr = callAttributeHandler( prep->attr[i].entry, apiBlobPtr, &prep->attr[i].view );
+        if ( iRetAtr != rdkssaOK ) { break; }
+    }
+    return iRetAtr;
+}
+
+// rdkssaReleasePrepared - wipe (attributes may name key material) and free a prepared call
+void rdkssaReleasePrepared( rdkssa_handle_t *preparedCall )
+{
+    if ( preparedCall == NULL ) {
+        RDKSSA_LOG_ERROR("NULL ptr passed \n");
+        return;
+    }
+    preparedCall_t *prep = (preparedCall_t *)*preparedCall;
+    if ( prep != NULL && prep->magic == RDKSSA_PREPARED_MAGIC ) {
+        rdkssa_memfree( (void **)&prep, prep->size );
+    }
+    *preparedCall = NULL;
+}
+
 /**
  * See template for an example
  */
@@ -336,31 +1254,60 @@ rdkssaStatus_t rdkssaHandleAPIHelper( rdkssa_blobptr_t apiBlobPtr, const char *
 #ifdef UNIT_TESTS
 int utmain_helpers(int argc, char *argv[] );
 
+// ssaHelper.c stubs: no helper process, everything runs locally
+int rdkssaHelperActive( void ) { return 0; }
+int rdkssaHelperExec( const char * const exargv[], int stdinFd, int timeoutMs, int *status ) { return -1; }
+// ssaSecMem.c stubs
+void *rdkssaSecAlloc( size_t size ) { return calloc( 1, size ); }
+void rdkssaSecFree( void *mem ) { free( mem ); }
+
 int main(int argc, char *argv[]  ) {
     return utmain_helpers( argc, argv );
 }
 
 // unit test subroutines for test sets 
+static void ut_logLevel( void );
 static void ut_rdkssaCleanupVector( void );
 static void ut_rdkssaHelpersMem( void );
+static void ut_rdkssaCopyFd( void );
 static void ut_rdkssaExecv( void );
+static void ut_spawnHelper( void );
+static void ut_rdkssaExecAsync( void );
+static void ut_benchSpawn( void );
 static void ut_rdkssaAttrCheck( void );
+static void ut_attrScan( void );
+static void ut_benchAttrCheck( void );
 static void ut_attributeHandlerHelper( void );
 static void ut_rdkssaHandleAPIHelper( void );
 static void ut_rdkssaHandleAPIHelperTemplate( void );
+static void ut_attributeIndexedHandlerHelper( void );
+static void ut_benchAttributeDispatch( void );
+static void ut_attributeViewHandler( void );
+static void ut_rdkssaPreparedCall( void );
 
 int utmain_helpers(int argc, char *argv[]  )
 {
 
     RDKSSA_LOG_UT("=== Unit tests HELPERS begin ===\n");
 
+    ut_logLevel( );
     ut_rdkssaCleanupVector( );
     ut_rdkssaHelpersMem( );
+    ut_rdkssaCopyFd( );
     ut_rdkssaExecv( );
+    ut_spawnHelper( );
+    ut_rdkssaExecAsync( );
+    ut_benchSpawn( );
     ut_rdkssaAttrCheck( );
+    ut_attrScan( );
+    ut_benchAttrCheck( );
     ut_attributeHandlerHelper( );
     ut_rdkssaHandleAPIHelper( );
     ut_rdkssaHandleAPIHelperTemplate( );
+    ut_attributeIndexedHandlerHelper( );
+    ut_benchAttributeDispatch( );
+    ut_attributeViewHandler( );
+    ut_rdkssaPreparedCall( );
 
     RDKSSA_LOG_UT("=== Unit tests HELPERS SUCCESS ===\n");
     return 0;
@@ -383,6 +1330,65 @@ char **utNewVector( const char *arg0, const char *arg1, const char *arg2,
     return newVector;
 }
 
+static int utLogArgEval = 0;
+static int utLogArg( void ) {
+    return ++utLogArgEval;
+}
+
+static void ut_logLevel( void ) {
+    RDKSSA_LOG_UT("logLevel\n");
+    int saved = rdkssaLogLevel;
+
+    UTST( logLevelParse( "DEBUG" ) == RDKSSA_LEVEL_DEBUG );
+    UTST( logLevelParse( "  info\n" ) == RDKSSA_LEVEL_INFO );
+    UTST( logLevelParse( "Error" ) == RDKSSA_LEVEL_ERROR );
+    UTST( logLevelParse( "none" ) == RDKSSA_LEVEL_NONE );
+    UTST( logLevelParse( "0" ) == RDKSSA_LEVEL_NONE );
+    UTST( logLevelParse( "3\n" ) == RDKSSA_LEVEL_DEBUG );
+    UTST( logLevelParse( "4" ) < 0 );
+    UTST( logLevelParse( "DEBUGX" ) < 0 );
+    UTST( logLevelParse( "" ) < 0 );
+    UTST( logLevelParse( NULL ) < 0 );
+
+    // env var wins over the file and the default
+    UTST0( setenv( "RDKSSA_LOG_LEVEL", "none", 1 ) );
+    logLevelInit( );
+    UTST( rdkssaLogLevel == RDKSSA_LEVEL_NONE );
+    UTST0( setenv( "RDKSSA_LOG_LEVEL", "bogus", 1 ) );
+    rdkssaLogLevel = RDKSSA_LEVEL_INFO;
+    logLevelInit( );    // bad value: falls through to the file, if there is none the level stays
+    UTST( rdkssaLogLevel == RDKSSA_LEVEL_INFO || access( RDKSSA_LOG_LEVEL_FILE, R_OK ) == 0 );
+    UTST0( unsetenv( "RDKSSA_LOG_LEVEL" ) );
+
+    // a disabled level does not evaluate its arguments
+    rdkssaLogLevel = RDKSSA_LEVEL_NONE;
+    RDKSSA_LOG_ERROR( "not printed %d\n", utLogArg() );
+    UTST( utLogArgEval == 0 );
+#ifdef RDKSSA_ERROR_ENABLED
+    RDKSSA_LOG_UT("  logLevel expect 1 error\n");
+    rdkssaLogLevel = RDKSSA_LEVEL_ERROR;
+    RDKSSA_LOG_ERROR( "printed %d\n", utLogArg() );
+    UTST( utLogArgEval == 1 );
+#endif
+    // safe as the only statement of an if/else
+    if ( utLogArgEval < 0 ) RDKSSA_LOG_DEBUG( "never\n" ); else utLogArgEval = 0;
+    UTST( utLogArgEval == 0 );
+
+    // bench: cost of a disabled log line
+    const int iter = 1000000;
+    uint64_t t0;
+    int i;
+    rdkssaLogLevel = RDKSSA_LEVEL_NONE;
+    t0 = utNowNs();
+    for ( i = 0; i < iter; i++ ) {
+        RDKSSA_LOG_ERROR( "bench %d %s\n", i, __func__ );
+    }
+    t0 = utNowNs() - t0;
+    rdkssaLogLevel = saved;
+    RDKSSA_LOG_UT("    disabled log line %llu ps/call\n", (unsigned long long)(t0*1000/iter) );
+    RDKSSA_LOG_UT("logLevel SUCCESS\n");
+}
+
 static void ut_rdkssaCleanupVector( void ) {
     RDKSSA_LOG_UT("rdkssaCleanupVector\n");
     char **cmdvctr1 = utNewVector( "app", NULL, NULL, NULL, NULL, NULL );
@@ -464,6 +1470,232 @@ static void ut_rdkssaExecv( void ) {
     RDKSSA_LOG_UT("    ut_rdkssaExecv SUCCESS\n");
 }
 
+// spawn and wait the way rdkssaExecv does, with the launcher picked by the caller
+static int utRunHelper( const char * const exargv[], int stdinFd, int closeFd, int usePosixSpawn ) {
+    pid_t pid = spawnHelper( exargv, stdinFd, closeFd, usePosixSpawn );
+    if ( pid == SPAWN_NOEXEC ) return SPAWN_NOEXEC_STATUS;
+    if ( pid < 0 ) return -1;
+    if ( stdinFd >= 0 ) {
+        close( stdinFd );
+        UTST( write( closeFd, "hello\n", 6 ) == 6 );
+        close( closeFd );
+    }
+    return waitHelper( pid );
+}
+
+// both launchers must give the same exit codes
+static void ut_spawnHelper( void ) {
+    RDKSSA_LOG_UT("  spawnHelper (default %s)\n", RDKSSA_SPAWN_DEFAULT ? "posix_spawn" : "fork" );
+    const char * const argTrue[] = { "/bin/true", NULL };
+    const char * const argFalse[] = { "/bin/false", NULL };
+    const char * const argExit[] = { "/bin/sh", "-c", "exit 7", NULL };
+    const char * const argMissing[] = { "/notfound/helper", NULL };
+    const char * const argStdin[] = { "/bin/sh", "-c", "read x; test \"$x\" = hello", NULL };
+    int mode, fds[2];
+
+    for ( mode = 0; mode <= 1; mode++ ) {
+        RDKSSA_LOG_UT("    %s, expect %d error(s)\n", mode ? "posix_spawn" : "fork", mode );
+        UTST( utRunHelper( argTrue, -1, -1, mode ) == 0 );
+        UTST( utRunHelper( argFalse, -1, -1, mode ) == 1 );
+        UTST( utRunHelper( argExit, -1, -1, mode ) == 7 );
+        UTST( utRunHelper( argMissing, -1, -1, mode ) == SPAWN_NOEXEC_STATUS );
+        UTST0( pipe( fds ) );
+        UTST( utRunHelper( argStdin, fds[0], fds[1], mode ) == 0 );
+    }
+    RDKSSA_LOG_UT("  spawnHelper SUCCESS\n");
+}
+
+static rdkssaStatus_t utWriteHello( int fd, rdkssa_blobptr_t blob ) {
+    return ( write( fd, "hello\n", 6 ) == 6 ) ? rdkssaOK : rdkssaFileError;
+}
+static rdkssaStatus_t utWriteNothing( int fd, rdkssa_blobptr_t blob ) {
+    return rdkssaOK;
+}
+static rdkssaStatus_t utWriteFails( int fd, rdkssa_blobptr_t blob ) {
+    return rdkssaFileError;
+}
+
+// timeouts and completion handles, with a pidfd and with the waiter thread
+#define UTCOPY_IN   "/tmp/ut_rdkssa_copy_in"
+#define UTCOPY_OUT  "/tmp/ut_rdkssa_copy_out"
+#define UTCOPY_LEN  (5000)
+#define UTCOPY_KEY  (16)
+#define UTCOPY_TRIES (200)
+// a helper that reads its key and exits without waiting for EOF
+static void *utKeyReader( void *arg ) {
+    int fd = *(int *)arg;
+    char key[UTCOPY_KEY];
+    size_t got = 0;
+    ssize_t n;
+
+    while ( got < UTCOPY_KEY && ( n = read( fd, key + got, UTCOPY_KEY - got ) ) > 0 ) {
+        got += (size_t)n;
+    }
+    close( fd );
+    return NULL;
+}
+static void ut_rdkssaCopyFd( void ) {
+    RDKSSA_LOG_UT("  rdkssaCopyFd\n");
+    static char data[UTCOPY_LEN], back[UTCOPY_LEN + 1];
+    int in, out, fds[2], src[2];
+    size_t copied;
+    int i;
+
+    for ( i = 0; i < UTCOPY_LEN; i++ ) {
+        data[i] = (char)( i * 31 );
+    }
+    UTST( ( in = open( UTCOPY_IN, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600 ) ) >= 0 );
+    UTST( write( in, data, UTCOPY_LEN ) == UTCOPY_LEN );
+
+    // file to pipe: spliced
+    UTST0( pipe2( fds, O_CLOEXEC ) );
+    UTST( lseek( in, 0, SEEK_SET ) == 0 );
+    UTST0( rdkssaCopyFd( fds[1], in, UTCOPY_LEN, &copied ) );
+    UTST( copied == UTCOPY_LEN );
+    close( fds[1] );
+    UTST( read( fds[0], back, sizeof( back ) ) == UTCOPY_LEN );
+    UTST0( memcmp( back, data, UTCOPY_LEN ) );
+    close( fds[0] );
+
+    // pipe to pipe, and a source over the limit
+    UTST0( pipe2( src, O_CLOEXEC ) );
+    UTST( write( src[1], data, 3000 ) == 3000 );
+    close( src[1] );
+    UTST0( pipe2( fds, O_CLOEXEC ) );
+    UTST( rdkssaCopyFd( fds[1], src[0], 2999, &copied ) == -1 && errno == EFBIG );
+    UTST( copied == 3000 );
+    close( src[0] );
+    close( fds[0] );
+    close( fds[1] );
+
+    // file to file: no splice, through the buffer
+    UTST( ( out = open( UTCOPY_OUT, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600 ) ) >= 0 );
+    UTST( lseek( in, 0, SEEK_SET ) == 0 );
+    UTST0( rdkssaCopyFd( out, in, UTCOPY_LEN, &copied ) );
+    UTST( copied == UTCOPY_LEN );
+    UTST( pread( out, back, sizeof( back ), 0 ) == UTCOPY_LEN );
+    UTST0( memcmp( back, data, UTCOPY_LEN ) );
+    UTST( lseek( in, 0, SEEK_SET ) == 0 );
+    UTST( rdkssaCopyFd( out, in, 100, NULL ) == -1 && errno == EFBIG );
+    close( out );
+
+    // a reader that takes its key and closes at once: no EOF probe into the closed pipe
+    for ( i = 0; i < UTCOPY_TRIES; i++ ) {
+        pthread_t reader;
+        UTST0( pipe2( fds, O_CLOEXEC ) );
+        UTST( lseek( in, UTCOPY_LEN - UTCOPY_KEY, SEEK_SET ) == UTCOPY_LEN - UTCOPY_KEY );
+        UTST0( pthread_create( &reader, NULL, utKeyReader, &fds[0] ) );
+        UTST0( rdkssaCopyFd( fds[1], in, UTCOPY_LEN, &copied ) );
+        UTST( copied == UTCOPY_KEY );
+        UTST0( pthread_join( reader, NULL ) );
+        close( fds[1] );
+    }
+
+    // nobody reading: EPIPE, and no SIGPIPE to kill us
+    UTST0( pipe2( fds, O_CLOEXEC ) );
+    close( fds[0] );
+    UTST( lseek( in, 0, SEEK_SET ) == 0 );
+    UTST( rdkssaCopyFd( fds[1], in, UTCOPY_LEN, NULL ) == -1 && errno == EPIPE );
+    close( fds[1] );
+    close( in );
+    remove( UTCOPY_IN );
+    remove( UTCOPY_OUT );
+}
+
+static void ut_rdkssaExecAsync( void ) {
+    RDKSSA_LOG_UT("  rdkssaExecAsync\n");
+    const char *argStdin[] = { "/bin/sh", "-c", "read x; test \"$x\" = hello", NULL };
+    const char *argExit[] = { "/bin/sh", "-c", "exit 5", NULL };
+    const char *argSleep[] = { "/bin/sleep", "5", NULL };
+    const char *argNap[] = { "/bin/sleep", "0.3", NULL };
+    const char *argMissing[] = { "/notfound/helper", NULL };
+    rdkssaExec_t *exec[3];
+    uint64_t t0, t;
+    int mode, i;
+
+    for ( mode = 1; mode >= 0; mode-- ) {
+        execUsePidfd = mode;
+        RDKSSA_LOG_UT("    %s, expect %d errors\n", mode ? "pidfd" : "waiter thread", 5 + RDKSSA_SPAWN_DEFAULT );
+        UTST( rdkssaExecvPipeOutputTimeout( argStdin, NULL, utWriteHello, 2000 ) == 0 );
+        UTST( rdkssaExecvPipeOutputTimeout( argExit, NULL, utWriteNothing, 2000 ) == 5 );
+        UTST( rdkssaExecvPipeOutputTimeout( argMissing, NULL, utWriteNothing, 2000 ) == SPAWN_NOEXEC_STATUS );
+        UTST( rdkssaExecvPipeOutput( argStdin, NULL, utWriteHello ) == 0 );
+
+        // a failing callback stops the helper
+        t0 = utNowNs();
+        UTST( rdkssaExecvPipeOutputTimeout( argSleep, NULL, utWriteFails, 2000 ) == rdkssaFileError );
+        UTST( utNowNs() - t0 < 1000000000ull );
+
+        // a hung helper is killed at the deadline
+        t0 = utNowNs();
+        UTST( rdkssaExecvPipeOutputTimeout( argSleep, NULL, utWriteNothing, 200 ) == rdkssaTimeout );
+        t = utNowNs() - t0;
+        UTST( t >= 200000000ull && t < 2000000000ull );
+        UTST( rdkssaExecvLocal( (const char * const *)argSleep, -1, 100 ) == rdkssaTimeout );
+        UTST( rdkssaExecvLocal( (const char * const *)argExit, -1, 2000 ) == 5 );
+
+        // overlap: three helpers in flight, completion seen on their fds
+        t0 = utNowNs();
+        for ( i = 0; i < 3; i++ ) {
+            UTST( rdkssaExecvPipeOutputAsync( argNap, NULL, utWriteNothing, &exec[i] ) == rdkssaOK );
+            UTST( exec[i] != NULL && rdkssaExecFd( exec[i] ) >= 0 );
+        }
+        for ( i = 0; i < 3; i++ ) {
+            struct pollfd pfd = { rdkssaExecFd( exec[i] ), POLLIN, 0 };
+            UTST( poll( &pfd, 1, 2000 ) == 1 );
+            UTST( rdkssaExecWait( exec[i], 0 ) == 0 );
+        }
+        UTST( utNowNs() - t0 < 600000000ull );
+
+        // checking a helper that is not done ends it
+        UTST( rdkssaExecvPipeOutputAsync( argSleep, NULL, utWriteNothing, &exec[0] ) == rdkssaOK );
+        UTST( rdkssaExecWait( exec[0], 0 ) == rdkssaTimeout );
+
+        // posix_spawn knows at once, a forked child reports it as its exit status
+        i = rdkssaExecvPipeOutputAsync( argMissing, NULL, utWriteNothing, &exec[0] );
+        if ( i == rdkssaOK ) i = rdkssaExecWait( exec[0], 2000 );
+        else UTST( exec[0] == NULL );
+        UTST( i == SPAWN_NOEXEC_STATUS );
+    }
+    execUsePidfd = 1;
+    UTST( rdkssaExecWait( NULL, 0 ) == rdkssaBadPointer );
+    UTST( rdkssaExecvPipeOutputAsync( argExit, NULL, NULL, &exec[0] ) == rdkssaBadPointer );
+    RDKSSA_LOG_UT("  rdkssaExecAsync SUCCESS\n");
+}
+
+// bench: launch + wait latency of a trivial helper against the caller's resident set size
+static void ut_benchSpawn( void ) {
+    RDKSSA_LOG_UT("  bench spawn\n");
+    static const size_t rssMb[] = { 0, 64, 256 };
+    const char * const argTrue[] = { "/bin/true", NULL };
+    const int iter = 20;
+    uint64_t t0, tFork, tSpawn;
+    size_t n;
+    int i;
+
+    for ( n = 0; n < sizeof(rssMb)/sizeof(rssMb[0]); n++ ) {
+        char *ballast = NULL;
+        if ( rssMb[n] ) {
+            ballast = malloc( rssMb[n] << 20 );
+            if ( ballast == NULL ) {
+                RDKSSA_LOG_UT("    %zu MB: no memory, skipped\n", rssMb[n] );
+                continue;
+            }
+            memset( ballast, 0x5a, rssMb[n] << 20 );   // make it resident
+        }
+        t0 = utNowNs();
+        for ( i = 0; i < iter; i++ ) UTST( utRunHelper( argTrue, -1, -1, 0 ) == 0 );
+        tFork = utNowNs() - t0;
+        t0 = utNowNs();
+        for ( i = 0; i < iter; i++ ) UTST( utRunHelper( argTrue, -1, -1, 1 ) == 0 );
+        tSpawn = utNowNs() - t0;
+        free( ballast );
+        RDKSSA_LOG_UT("    +%3zu MB RSS: fork %llu us/helper, posix_spawn %llu us/helper\n", rssMb[n],
+                      (unsigned long long)(tFork/iter/1000), (unsigned long long)(tSpawn/iter/1000) );
+    }
+    RDKSSA_LOG_UT("  bench spawn SUCCESS\n");
+}
+
 static void ut_rdkssaAttrCheck( void ) {
     RDKSSA_LOG_UT("  ut_attrSyntaxCheck\n");
     UTST( rdkssaAttrCheck( NULL ) == NULL );
@@ -490,6 +1722,82 @@ static void ut_rdkssaAttrCheck( void ) {
     RDKSSA_LOG_UT("  ut_rdkssaAttrCheck SUCCESS\n");
 }
 
+// attrScan must agree with strcspn for every alignment, length and stop character
+static void ut_attrScan( void ) {
+    RDKSSA_LOG_UT("  attrScan (%s)\n", RDKSSA_ATTR_SIMD );
+    static const char stops[] = RDKSSA_BADCHARS;
+    static char buf[MAX_ATTRIBUTE_VALUE_LENGTH+64] __attribute__((aligned(16)));
+    size_t align, len, pos, c, ref;
+
+    for ( align = 0; align < 16; align++ ) {
+        char *str = buf + align;
+        for ( len = 0; len < 80; len++ ) {
+            memset( buf, 'a', sizeof(buf) );
+            str[len] = '\0';
+            UTST( attrScan( str, MAX_ATTRIBUTE_VALUE_LENGTH+1 ) == len );
+            UTST( attrScan( str, len/2 ) == len/2 );    // limit reached first
+            for ( pos = 0; pos < len; pos++ ) {
+                for ( c = 0; c < sizeof(stops)-1; c++ ) {
+                    str[pos] = stops[c];
+                    ref = strcspn( str, RDKSSA_BADCHARS );
+                    UTST( ref == pos );
+                    UTST( attrScan( str, MAX_ATTRIBUTE_VALUE_LENGTH+1 ) == ref );
+                    UTST( attrScan( str, pos ) == pos );
+                }
+                str[pos] = (char)(0x80 | pos);    // high bytes are allowed
+            }
+            UTST( attrScan( str, MAX_ATTRIBUTE_VALUE_LENGTH+1 ) == len );
+        }
+        // around the maximum length
+        memset( buf, 'b', sizeof(buf) );
+        for ( len = MAX_ATTRIBUTE_VALUE_LENGTH-17; len < MAX_ATTRIBUTE_VALUE_LENGTH+17; len++ ) {
+            str[len] = '\0';
+            ref = len < MAX_ATTRIBUTE_VALUE_LENGTH+1 ? len : MAX_ATTRIBUTE_VALUE_LENGTH+1;
+            UTST( attrScan( str, MAX_ATTRIBUTE_VALUE_LENGTH+1 ) == ref );
+            str[len] = 'b';
+        }
+    }
+
+    // same verdicts as the scalar check
+    RDKSSA_LOG_UT("  attrScan expect 6 errors\n");
+    memset( buf, 'c', sizeof(buf) );
+    buf[MAX_ATTRIBUTE_VALUE_LENGTH] = '\0';
+    UTST( rdkssaAttrCheck( buf ) == buf && rdkssaAttrCheckScalar( buf ) == buf );
+    buf[MAX_ATTRIBUTE_VALUE_LENGTH] = 'c';
+    buf[MAX_ATTRIBUTE_VALUE_LENGTH+1] = '\0';
+    UTST( rdkssaAttrCheck( buf ) == NULL && rdkssaAttrCheckScalar( buf ) == NULL );
+    buf[30] = '$';
+    buf[32] = '\0';
+    UTST( rdkssaAttrCheck( buf ) == NULL && rdkssaAttrCheckScalar( buf ) == NULL );
+    RDKSSA_LOG_UT("  attrScan SUCCESS\n");
+}
+
+// bench: scalar strnlen+strpbrk vs. single pass check over realistic value sizes
+static void ut_benchAttrCheck( void ) {
+    RDKSSA_LOG_UT("  bench rdkssaAttrCheck (%s)\n", RDKSSA_ATTR_SIMD );
+    static const size_t sizes[] = { 32, 128, 512, 2048 };
+    static char value[MAX_ATTRIBUTE_VALUE_LENGTH+1];
+    const int iter = 20000;
+    uint64_t t0, tScalar, tCheck;
+    size_t n;
+    int i;
+
+    for ( n = 0; n < sizeof(sizes)/sizeof(sizes[0]); n++ ) {
+        // path-like value, e.g. MOUNTPOINT=/nvram/secure/...
+        for ( i = 0; i < (int)sizes[n]; i++ ) value[i] = "/nvram/secure-store_0123456789.key"[i % 34];
+        value[sizes[n]] = '\0';
+        t0 = utNowNs();
+        for ( i = 0; i < iter; i++ ) UTST( rdkssaAttrCheckScalar( value ) == value );
+        tScalar = utNowNs() - t0;
+        t0 = utNowNs();
+        for ( i = 0; i < iter; i++ ) UTST( rdkssaAttrCheck( value ) == value );
+        tCheck = utNowNs() - t0;
+        RDKSSA_LOG_UT("    %4zu bytes: scalar %llu ns/call, single pass %llu ns/call\n", sizes[n],
+                      (unsigned long long)(tScalar/iter), (unsigned long long)(tCheck/iter) );
+    }
+    RDKSSA_LOG_UT("  bench rdkssaAttrCheck SUCCESS\n");
+}
+
 
 
 // attribute handlers for unit tests
@@ -774,4 +2082,241 @@ static void ut_rdkssaHandleAPIHelperTemplate( void ) {
     RDKSSA_LOG_UT("  rdkssaHandleAPIHelper Template SUCCESS\n");
 }
 
+static void ut_attributeIndexedHandlerHelper( void ) {
+    RDKSSA_LOG_UT("  attributeIndexedHandlerHelper\n");
+    static const AttributeHandlerStruct utAttTable2[] = { {"red", &utHandler1},
+                                                         {"red1", &utHandler2},
+                                                         {"blue1",&utHandler3},
+                                                         {"blue", &utHandler4},
+                                                         {ATTRIBUTE_NULL, NULL} };
+    AttributeHandlerIndex utIndex2 = RDKSSA_HANDLER_INDEX( utAttTable2 );
+
+    reset_ut();
+    UTST( attributeIndexedHandlerHelper( (void *)&utm.mem, "red=alpha", &utIndex2 ) == rdkssaOK );
+    UTST( utIndex2.state == 1 ); // built on first use
+    UTST( chk_utcnt( 1,1,0,0,0 ) );
+    UTST0( strcmp( utm.mem[1], "H1:alpha" ));
+    UTST( attributeIndexedHandlerHelper( (void *)&utm.mem, "red1=beta", &utIndex2 ) == rdkssaOK );
+    UTST( chk_utcnt( 2,1,1,0,0 ) );
+    UTST0( strcmp( utm.mem[2], "H2:beta" ));
+    UTST( attributeIndexedHandlerHelper( (void *)&utm.mem, "blue1=gamma", &utIndex2 ) == rdkssaOK );
+    UTST( chk_utcnt( 3,1,1,1,0 ) );
+    UTST0( strcmp( utm.mem[3], "H3:gamma" ));
+    UTST( attributeIndexedHandlerHelper( (void *)&utm.mem, "blue", &utIndex2 ) == rdkssaOK );
+    UTST( chk_utcnt( 4,1,1,1,1 ) );
+    UTST0( strcmp( utm.mem[4], "H4:blue" ));
+
+    const char * const attArray[] = { "blue=1", "red1=2", "red=3", NULL };
+    reset_ut();
+    UTST( rdkssaHandleAPIIndexedHelper( (void *)&utm.mem, attArray, &utIndex2 ) == rdkssaOK );
+    UTST( chk_utcnt( 3,1,1,0,1 ) );
+    UTST0( strcmp( utm.mem[1], "H1:3" ));
+    UTST0( strcmp( utm.mem[4], "H4:1" ));
+
+    // reserved (NULL) entries are skipped, the first of duplicate names wins
+    static const AttributeHandlerStruct utAttTable3[] = { {"A1", NULL},
+                                                         {"A1", &utHandler1},
+                                                         {"A1", &utHandler2},
+                                                         {"A2", &utHandler3},
+                                                         {ATTRIBUTE_NULL, NULL} };
+    AttributeHandlerIndex utIndex3 = RDKSSA_HANDLER_INDEX( utAttTable3 );
+    reset_ut();
+    UTST( attributeIndexedHandlerHelper( NULL, "A1=x", &utIndex3 ) == rdkssaOK );
+    UTST( attributeIndexedHandlerHelper( NULL, "A2=y", &utIndex3 ) == rdkssaOK );
+    UTST( chk_utcnt( 2,1,0,1,0 ) );
+
+    // a full table still hashes
+    static const AttributeHandlerStruct utAttTableFull[] = {
+        {"MOUNTPOINT", &utHandler1}, {"PATH", &utHandler1}, {"KEY", &utHandler1}, {"PARTITION", &utHandler1},
+        {"NAME", &utHandler1}, {"PERM", &utHandler1}, {"TYPE", &utHandler1}, {"LENGTH", &utHandler1},
+        {"SEED", &utHandler1}, {"SALT", &utHandler1}, {"ITER", &utHandler1}, {"LABEL", &utHandler1},
+        {"CONTEXT", &utHandler1}, {"SRC", &utHandler1}, {"DST", &utHandler1}, {"DEL", &utHandler1},
+        {"CN", &utHandler1}, {"MAC", &utHandler1}, {"SER", &utHandler1}, {"PP", &utHandler1},
+        {"SAN", &utHandler1}, {"IP", &utHandler1}, {"VALID", &utHandler1}, {"VALIDITY", &utHandler1},
+        {"PKCS12", &utHandler1}, {"X509", &utHandler1}, {"BASEMACADDRESS", &utHandler1}, {"SERIALNUMBER", &utHandler1},
+        {"CREATE", &utHandler1}, {"UPDATE", &utHandler1}, {"CHECK", &utHandler2}, {"STORAGE", &utHandler3},
+        {ATTRIBUTE_NULL, NULL} };
+    AttributeHandlerIndex utIndexFull = RDKSSA_HANDLER_INDEX( utAttTableFull );
+    reset_ut();
+    UTST( attributeIndexedHandlerHelper( NULL, "STORAGE=x", &utIndexFull ) == rdkssaOK );
+    UTST( utIndexFull.state == 1 );
+    UTST( attributeIndexedHandlerHelper( NULL, "CHECK", &utIndexFull ) == rdkssaOK );
+    UTST( attributeIndexedHandlerHelper( NULL, "SER=1234", &utIndexFull ) == rdkssaOK );
+    UTST( chk_utcnt( 3,1,1,1,0 ) );
+
+    RDKSSA_LOG_UT("  attributeIndexedHandlerHelper expect 7 errors\n");
+    reset_ut();
+    UTST( attributeIndexedHandlerHelper( NULL, NULL, &utIndex2 ) == rdkssaBadPointer );
+    UTST( attributeIndexedHandlerHelper( NULL, "red", NULL ) == rdkssaBadPointer );
+    UTST( attributeIndexedHandlerHelper( NULL, "niy", &utIndex2 ) == rdkssaAttributeNotFound );
+    UTST( attributeIndexedHandlerHelper( NULL, "re=1", &utIndex2 ) == rdkssaAttributeNotFound );
+    UTST( attributeIndexedHandlerHelper( NULL, "=red", &utIndex2 ) == rdkssaSyntaxError );
+    UTST( attributeIndexedHandlerHelper( NULL, "o", &utIndex2 ) == rdkssaGeneralFailure );
+    char longname[MAX_ATTRIBUTE_NAME_LENGTH+3]={0};
+    memset( longname, 'y', sizeof(longname)-1 );
+    UTST( attributeIndexedHandlerHelper( NULL, longname, &utIndex2 ) == rdkssaGeneralFailure );
+    UTST( chk_utcnt( 0,0,0,0,0 ) );
+
+    RDKSSA_LOG_UT("  attributeIndexedHandlerHelper SUCCESS\n");
+}
+
+static rdkssaStatus_t utHandlerNop(rdkssa_blobptr_t blobPtr,const char *attribStr) {
+    return rdkssaOK;
+}
+
+// linear scan vs. hashed index over a mount/keyring sized table
+#define UT_BENCH_ITER 200000
+static void ut_benchAttributeDispatch( void ) {
+    RDKSSA_LOG_UT("  bench attribute dispatch\n");
+    static const AttributeHandlerStruct benchTable[] = {
+        {"MOUNTPOINT", utHandlerNop}, {"PATH", utHandlerNop}, {"KEY", utHandlerNop}, {"PARTITION", utHandlerNop},
+        {"NAME", utHandlerNop}, {"PERM", utHandlerNop}, {"TYPE", utHandlerNop}, {"LENGTH", utHandlerNop},
+        {ATTRIBUTE_NULL, NULL} };
+    static AttributeHandlerIndex benchIndex = RDKSSA_HANDLER_INDEX( benchTable );
+    const char * const benchAttrs[] = { "MOUNTPOINT=/nvram/rdkssa", "PATH=/nvram/secure",
+                                        "KEY=/etc/ecfs-mount-sample-dummy-key", "LENGTH=256", NULL };
+    uint64_t t0, tLinear, tIndexed;
+    int i;
+
+    t0 = utNowNs();
+    for( i=0; i<UT_BENCH_ITER; i++ ) {
+        UTST( rdkssaHandleAPIHelper( NULL, benchAttrs, benchTable ) == rdkssaOK );
+    }
+    tLinear = utNowNs() - t0;
+    t0 = utNowNs();
+    for( i=0; i<UT_BENCH_ITER; i++ ) {
+        UTST( rdkssaHandleAPIIndexedHelper( NULL, benchAttrs, &benchIndex ) == rdkssaOK );
+    }
+    tIndexed = utNowNs() - t0;
+    RDKSSA_LOG_UT("    %d calls x 4 attributes: linear %llu ns/call, indexed %llu ns/call\n", UT_BENCH_ITER,
+                  (unsigned long long)(tLinear/UT_BENCH_ITER), (unsigned long long)(tIndexed/UT_BENCH_ITER) );
+    RDKSSA_LOG_UT("  bench attribute dispatch SUCCESS\n");
+}
+
+// view handler: keep a copy of the view it was called with
+static rdkssaAttrView_t utLastView;
+static rdkssaStatus_t utViewHandler(rdkssa_blobptr_t blobPtr, const rdkssaAttrView_t *view) {
+    if ( view == NULL ) return rdkssaBadPointer;
+    incr_utcnt(0,1);
+    utLastView = *view;
+    return rdkssaOK;
+}
+
+static void ut_attributeViewHandler( void ) {
+    RDKSSA_LOG_UT("  attribute view handlers\n");
+    static const AttributeHandlerStruct utViewTable[] = { {"red", &utHandler1},
+                                                         {"MOUNTPOINT", NULL, &utViewHandler},
+                                                         {"FLAG", NULL, &utViewHandler},
+                                                         {ATTRIBUTE_NULL, NULL} };
+    AttributeHandlerIndex utViewIndex = RDKSSA_HANDLER_INDEX( utViewTable );
+    const char *attr = "MOUNTPOINT=/nvram/rdkssa";
+    rdkssaAttrView_t view;
+
+    UTST( rdkssaAttrViewParse( attr, &view ) == rdkssaOK );
+    UTST( view.name == attr && view.nameLen == 10 );
+    UTST( view.value == attr+11 && view.valueLen == 13 );
+    UTST( rdkssaAttrViewCheck( &view ) == attr+11 );
+    UTST( rdkssaAttrViewParse( "FLAG", &view ) == rdkssaOK );
+    UTST( view.value == NULL && view.valueLen == 0 && view.nameLen == 4 );
+
+    // linear and hashed lookups hand out the caller's storage, no copy
+    reset_ut();
+    rdkssa_memwipe( &utLastView, sizeof(utLastView) );
+    UTST( attributeHandlerHelper( NULL, attr, utViewTable ) == rdkssaOK );
+    UTST( utLastView.value == attr+11 && utLastView.valueLen == 13 );
+    rdkssa_memwipe( &utLastView, sizeof(utLastView) );
+    UTST( attributeIndexedHandlerHelper( NULL, attr, &utViewIndex ) == rdkssaOK );
+    UTST( utLastView.name == attr && utLastView.nameLen == 10 );
+    UTST( utLastView.value == attr+11 && utLastView.valueLen == 13 );
+    UTST( attributeIndexedHandlerHelper( NULL, "FLAG", &utViewIndex ) == rdkssaOK );
+    UTST( utLastView.value == NULL );
+    // string handlers in the same table still get the value string
+    UTST( attributeIndexedHandlerHelper( (void *)&utm.mem, "red=1", &utViewIndex ) == rdkssaOK );
+    UTST0( strcmp( utm.mem[1], "H1:1" ));
+    UTST( chk_utcnt( 4,1,0,0,0 ) );
+
+    RDKSSA_LOG_UT("  attribute view handlers expect 4 errors\n");
+    UTST( rdkssaAttrViewParse( NULL, &view ) == rdkssaBadPointer );
+    UTST( rdkssaAttrViewParse( "=x", &view ) == rdkssaSyntaxError );
+    UTST( rdkssaAttrViewParse( "FLAG", &view ) == rdkssaOK );
+    UTST( rdkssaAttrViewCheck( &view ) == NULL );   // no value
+    UTST( rdkssaAttrViewParse( "K=a;b", &view ) == rdkssaOK );
+    UTST( rdkssaAttrViewCheck( &view ) == NULL );   // bad char
+
+    RDKSSA_LOG_UT("  attribute view handlers SUCCESS\n");
+}
+
+static const AttributeHandlerStruct utAttTableMxDummy[] = { {"A1", &utHandler1}, {ATTRIBUTE_NULL, NULL} };
+static void ut_rdkssaPreparedCall( void ) {
+    RDKSSA_LOG_UT("  rdkssaPrepareAPIHelper/rdkssaExecutePreparedHelper\n");
+    static const AttributeHandlerStruct utPrepTable[] = { {"A1", &utHandler1},
+                                                         {"A2", &utHandler2},
+                                                         {"MOUNTPOINT", NULL, &utViewHandler},
+                                                         {ATTRIBUTE_NULL, NULL} };
+    static AttributeHandlerIndex utPrepIndex = RDKSSA_HANDLER_INDEX( utPrepTable );
+    static AttributeHandlerIndex utOtherIndex = RDKSSA_HANDLER_INDEX( utAttTableMxDummy );
+    rdkssa_handle_t prep = NULL;
+    char *blob1[UTAPISZ] = {0};
+
+    // the caller's vector can go away after prepare
+    char **vctr = utNewVector( "A2=two", "MOUNTPOINT=/nvram/rdkssa", "A1=one", NULL, NULL, NULL );
+    UTST( rdkssaPrepareAPIHelper( (const char * const *)vctr, &utPrepIndex, &prep ) == rdkssaOK );
+    UTST( prep != NULL );
+    rdkssaCleanupVector( &vctr );
+
+    reset_ut();
+    UTST( rdkssaExecutePreparedHelper( (void *)&utm.mem, prep, &utPrepIndex ) == rdkssaOK );
+    UTST( chk_utcnt( 3,1,1,0,0 ) );
+    UTST0( strcmp( utm.mem[1], "H1:one" ));
+    UTST0( strcmp( utm.mem[2], "H2:two" ));
+    UTST( utLastView.valueLen == 13 && strcmp( utLastView.value, "/nvram/rdkssa" ) == 0 );
+    UTST( utLastView.flags & RDKSSA_ATTRVIEW_CHECKED );
+    // execute again with a different blob
+    UTST( rdkssaExecutePreparedHelper( (void *)blob1, prep, &utPrepIndex ) == rdkssaOK );
+    UTST( chk_utcnt( 6,2,2,0,0 ) );
+    UTST0( strcmp( blob1[1], "H1:one" ));
+    rdkssa_memfree( (void **)&blob1[1], strnlen( blob1[1], UTSTRSZ ) );
+    rdkssa_memfree( (void **)&blob1[2], strnlen( blob1[2], UTSTRSZ ) );
+
+    RDKSSA_LOG_UT("  prepared call expect 6 errors\n");
+    UTST( rdkssaExecutePreparedHelper( NULL, prep, &utOtherIndex ) == rdkssaBadPointer ); // wrong API
+    UTST( rdkssaExecutePreparedHelper( NULL, NULL, &utPrepIndex ) == rdkssaBadPointer );
+    rdkssaReleasePrepared( &prep );
+    UTST( prep == NULL );
+    rdkssaReleasePrepared( &prep ); // harmless
+
+    // errors are reported at prepare time, nothing is returned
+    const char * const badName[] = { "A1=x", "NOPE=y", NULL };
+    UTST( rdkssaPrepareAPIHelper( badName, &utPrepIndex, &prep ) == rdkssaAttributeNotFound );
+    UTST( prep == NULL );
+    const char * const badValue[] = { "MOUNTPOINT=/a;b", NULL };
+    UTST( rdkssaPrepareAPIHelper( badValue, &utPrepIndex, &prep ) == rdkssaValidityError );
+    UTST( prep == NULL );
+    const char * const badSyntax[] = { "=A1", NULL };
+    UTST( rdkssaPrepareAPIHelper( badSyntax, &utPrepIndex, &prep ) == rdkssaSyntaxError );
+    UTST( rdkssaPrepareAPIHelper( NULL, &utPrepIndex, &prep ) == rdkssaBadPointer );
+
+    // bench: per-call attribute processing vs. prepared execution
+    const char * const benchAttrs[] = { "A1=/nvram/rdkssa", "A2=/nvram/secure", "MOUNTPOINT=/etc/ecfs-mount-sample-dummy-key", NULL };
+    uint64_t t0, tCall, tPrep;
+    int i;
+    UTST( rdkssaPrepareAPIHelper( benchAttrs, &utPrepIndex, &prep ) == rdkssaOK );
+    t0 = utNowNs();
+    for( i=0; i<UT_BENCH_ITER; i++ ) {
+        UTST( rdkssaHandleAPIIndexedHelper( NULL, benchAttrs, &utPrepIndex ) == rdkssaOK );
+    }
+    tCall = utNowNs() - t0;
+    t0 = utNowNs();
+    for( i=0; i<UT_BENCH_ITER; i++ ) {
+        UTST( rdkssaExecutePreparedHelper( NULL, prep, &utPrepIndex ) == rdkssaOK );
+    }
+    tPrep = utNowNs() - t0;
+    rdkssaReleasePrepared( &prep );
+    RDKSSA_LOG_UT("    %d calls x 3 attributes: per call %llu ns/call, prepared %llu ns/call\n", UT_BENCH_ITER,
+                  (unsigned long long)(tCall/UT_BENCH_ITER), (unsigned long long)(tPrep/UT_BENCH_ITER) );
+    reset_ut();
+
+    RDKSSA_LOG_UT("  rdkssaPrepareAPIHelper/rdkssaExecutePreparedHelper SUCCESS\n");
+}
+
 #endif // UNIT_TESTS
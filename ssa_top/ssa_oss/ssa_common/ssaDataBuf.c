@@ -0,0 +1,540 @@
+/*
+ * Copyright 2020 Comcast Cable Communications Management, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+*/
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "rdkssa.h"
+#include "rdkssaCommonProtected.h"
+
+/**
+ * rdkssaDataBuf_t pool
+ *
+ * Every buffer has a header in front of it with its capacity and size class.  Class c holds
+ * DATABUF_MIN << c bytes of data, up to RDKSSA_DATABUF_MAX_POOLED; a bigger buffer has no class and is
+ * always freed.  A released buffer is wiped and pushed on the releasing thread's free list for its class,
+ * unless that thread already caches RDKSSA_DATABUF_CACHE_BYTES of data; then it is freed.  No lock is
+ * taken: a thread only touches its own lists.  A thread's lists are freed when it exits.
+ *
+ * The thread's pending result (rdkssaPendingOffer) hangs off its lists too, but in locked memory from
+ * rdkssaSecDataBuf: it may be key material the caller hasn't taken yet.
+ */
+#ifndef RDKSSA_DATABUF_CACHE_BYTES
+#define RDKSSA_DATABUF_CACHE_BYTES  (128 * 1024)
+#endif
+
+#define DATABUF_MIN         (64)
+#define DATABUF_CLASSES     (10)        /* 64 .. 32768 */
+#define DATABUF_MAGIC       (0x53534442u)
+
+_Static_assert( ( DATABUF_MIN << ( DATABUF_CLASSES - 1 ) ) == RDKSSA_DATABUF_MAX_POOLED, "DATABUF_CLASSES" );
+_Static_assert( RDKSSA_DATABUF_MAX_POOLED > MAX_ATTRIBUTE_BUFF_LENGTH, "RDKSSA_DATABUF_MAX_POOLED" );
+
+// keeps the rdkssaDataBuf_t behind it aligned as malloc would
+typedef union databuf_hdr {
+    struct {
+        union databuf_hdr *next;    /* free list link while cached */
+        size_t capacity;
+        unsigned cls;               /* DATABUF_CLASSES: not pooled */
+        uint32_t magic;
+    } h;
+    long double ld;
+    long long ll;
+    void *ptr;
+} databuf_hdr_t;
+
+typedef struct {
+    databuf_hdr_t *head[DATABUF_CLASSES];
+    size_t bytes;
+    rdkssaDataBufPtr_t pending;         /* NULL if there is no pending result */
+    uint64_t pendingVersion;
+    uint64_t pendingMs;                 /* when it was kept */
+    size_t pendingKeyLen;
+    char pendingKey[RDKSSA_PENDING_KEY_MAX];
+} databuf_cache_t;
+
+static __thread databuf_cache_t *threadCache;
+static pthread_key_t cacheKey;
+static pthread_once_t cacheOnce = PTHREAD_ONCE_INIT;
+static int cacheKeyOk;
+
+static void pendingDrop( databuf_cache_t *cache );
+
+// thread exit: free what it cached
+static void cacheDestroy( void *arg ) {
+    databuf_cache_t *cache = arg;
+    databuf_hdr_t *hdr;
+    unsigned cls;
+
+    pendingDrop( cache );
+    for ( cls = 0; cls < DATABUF_CLASSES; cls++ ) {
+        while ( ( hdr = cache->head[cls] ) != NULL ) {
+            cache->head[cls] = ( hdr->h.next == hdr ) ? NULL : hdr->h.next;
+            free( hdr );                // wiped when it was released
+        }
+    }
+    free( cache );
+    threadCache = NULL;
+}
+
+static void cacheKeyCreate( void ) {
+    cacheKeyOk = ( pthread_key_create( &cacheKey, cacheDestroy ) == 0 );
+}
+
+// this thread's lists, NULL if they can't be set up (buffers are then just freed)
+static databuf_cache_t *databufCache( void ) {
+    databuf_cache_t *cache = threadCache;
+
+    if ( cache == NULL ) {
+        pthread_once( &cacheOnce, cacheKeyCreate );
+        if ( !cacheKeyOk || ( cache = calloc( 1, sizeof( *cache ) ) ) == NULL ) {
+            return NULL;
+        }
+        if ( pthread_setspecific( cacheKey, cache ) != 0 ) {
+            free( cache );
+            return NULL;
+        }
+        threadCache = cache;
+    }
+    return cache;
+}
+
+// smallest class that holds size bytes, DATABUF_CLASSES if none does
+static unsigned databufClass( size_t size ) {
+    unsigned cls = 0;
+
+    while ( cls < DATABUF_CLASSES && ( (size_t)DATABUF_MIN << cls ) < size ) {
+        cls++;
+    }
+    return cls;
+}
+
+rdkssaDataBufPtr_t rdkssaDataBufAlloc( size_t sizeOfData ) {
+    unsigned cls = databufClass( sizeOfData );
+    size_t capacity = ( cls < DATABUF_CLASSES ) ? (size_t)DATABUF_MIN << cls : sizeOfData;
+    databuf_cache_t *cache = ( cls < DATABUF_CLASSES ) ? databufCache() : NULL;
+    databuf_hdr_t *hdr = NULL;
+    rdkssaDataBufPtr_t buf;
+
+    if ( cache != NULL && ( hdr = cache->head[cls] ) != NULL ) {
+        cache->head[cls] = ( hdr->h.next == hdr ) ? NULL : hdr->h.next;
+        cache->bytes -= capacity;
+    } else {
+        if ( capacity > SIZE_MAX - sizeof( *hdr ) - sizeof( rdkssaDataBuf_t ) ||
+             ( hdr = calloc( 1, sizeof( *hdr ) + sizeof( rdkssaDataBuf_t ) + capacity ) ) == NULL ) {
+            RDKSSA_LOG_ERROR( "rdkssaDataBufAlloc of %zu bytes failed\n", sizeOfData );
+            return NULL;
+        }
+        hdr->h.capacity = capacity;
+        hdr->h.cls = cls;
+        hdr->h.magic = DATABUF_MAGIC;
+    }
+    hdr->h.next = NULL;
+    buf = (rdkssaDataBufPtr_t)( hdr + 1 );
+    buf->sizeOfData = sizeOfData;
+    return buf;
+}
+
+void rdkssaDataBufRelease( rdkssaDataBufPtr_t buf ) {
+    databuf_hdr_t *hdr;
+    databuf_cache_t *cache;
+
+    if ( buf == NULL ) return;
+    hdr = (databuf_hdr_t *)buf - 1;
+    if ( hdr->h.magic != DATABUF_MAGIC || hdr->h.next != NULL ) {
+        RDKSSA_LOG_ERROR( "rdkssaDataBufRelease of a buffer not from rdkssaDataBufAlloc, or released twice\n" );
+        return;
+    }
+    RDKSSA_WIPE( buf, sizeof( rdkssaDataBuf_t ) + hdr->h.capacity );
+    if ( hdr->h.cls < DATABUF_CLASSES && ( cache = databufCache() ) != NULL &&
+         cache->bytes + hdr->h.capacity <= RDKSSA_DATABUF_CACHE_BYTES ) {
+        /* a cached buffer is marked by its link; the last one in a list links to itself */
+        hdr->h.next = cache->head[hdr->h.cls] ? cache->head[hdr->h.cls] : hdr;
+        cache->head[hdr->h.cls] = hdr;
+        cache->bytes += hdr->h.capacity;
+        return;
+    }
+    hdr->h.magic = 0;
+    free( hdr );
+}
+
+static uint64_t pendingNowMs( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+// api and the attributes as 0-terminated strings one after the other in key; the length, 0 if it doesn't fit
+static size_t pendingKey( char key[RDKSSA_PENDING_KEY_MAX], const char *api, const char * const attributes[] ) {
+    size_t len, keyLen;
+    int i;
+
+    if ( api == NULL || ( keyLen = strlen( api ) + 1 ) > RDKSSA_PENDING_KEY_MAX ) {
+        return 0;
+    }
+    memcpy( key, api, keyLen );
+    for ( i = 0; attributes != NULL && attributes[i] != NULL; i++ ) {
+        if ( ( len = strlen( attributes[i] ) + 1 ) > RDKSSA_PENDING_KEY_MAX - keyLen ) {
+            return 0;
+        }
+        memcpy( key + keyLen, attributes[i], len );
+        keyLen += len;
+    }
+    return keyLen;
+}
+
+static void pendingDrop( databuf_cache_t *cache ) {
+    if ( cache->pending != NULL ) {
+        rdkssaSecFree( cache->pending );            // wiped
+        cache->pending = NULL;
+    }
+}
+
+rdkssaStatus_t rdkssaPendingOffer( const char *api, const char * const attributes[], uint64_t version,
+                                   const void *result, size_t len, rdkssaDataBufPtr_t out ) {
+    char key[RDKSSA_PENDING_KEY_MAX];
+    databuf_cache_t *cache;
+    size_t keyLen;
+
+    if ( out == NULL || ( result == NULL && len != 0 ) ) {
+        RDKSSA_LOG_ERROR( "rdkssaPendingOffer NULL ptr\n" );
+        return rdkssaBadPointer;
+    }
+    if ( out->sizeOfData >= len ) {
+        memcpy( out->dataBuffer, result, len );
+        out->sizeOfData = len;
+        return rdkssaOK;
+    }
+    out->sizeOfData = len;
+    if ( ( cache = databufCache() ) != NULL && ( keyLen = pendingKey( key, api, attributes ) ) != 0 ) {
+        pendingDrop( cache );
+        if ( ( cache->pending = rdkssaSecDataBuf( len ) ) != NULL ) {
+            memcpy( cache->pending->dataBuffer, result, len );
+            memcpy( cache->pendingKey, key, keyLen );
+            cache->pendingKeyLen = keyLen;
+            cache->pendingVersion = version;
+            cache->pendingMs = pendingNowMs();
+        }
+    }
+    return rdkssaBadLength;
+}
+
+int rdkssaPendingTake( const char *api, const char * const attributes[], uint64_t version,
+                       rdkssaDataBufPtr_t out, rdkssaStatus_t *status ) {
+    databuf_cache_t *cache = threadCache;
+    char key[RDKSSA_PENDING_KEY_MAX];
+    size_t keyLen;
+
+    if ( cache == NULL || cache->pending == NULL || out == NULL || status == NULL ) {
+        return 0;
+    }
+    if ( pendingNowMs() - cache->pendingMs > RDKSSA_PENDING_TTL_MS ) {
+        pendingDrop( cache );
+        return 0;
+    }
+    if ( version != cache->pendingVersion || ( keyLen = pendingKey( key, api, attributes ) ) != cache->pendingKeyLen ||
+         memcmp( key, cache->pendingKey, keyLen ) != 0 ) {
+        return 0;
+    }
+    if ( out->sizeOfData < cache->pending->sizeOfData ) {
+        out->sizeOfData = cache->pending->sizeOfData;
+        *status = rdkssaBadLength;
+        return 1;
+    }
+    memcpy( out->dataBuffer, cache->pending->dataBuffer, cache->pending->sizeOfData );
+    out->sizeOfData = cache->pending->sizeOfData;
+    pendingDrop( cache );
+    *status = rdkssaOK;
+    return 1;
+}
+
+#ifdef UNIT_TESTS
+#include "unit_tests.h"
+
+int rdkssaLogLevel = RDKSSA_LOG_LEVEL_DEFAULT;
+
+// STUB secure memory - counts what is held, to see pending results come from it and go back
+static int utSecHeld;
+rdkssaDataBufPtr_t rdkssaSecDataBuf( size_t sizeOfData ) {
+    rdkssaDataBufPtr_t buf = calloc( 1, sizeof( rdkssaDataBuf_t ) + sizeOfData );
+    if ( buf != NULL ) {
+        buf->sizeOfData = sizeOfData;
+        utSecHeld++;
+    }
+    return buf;
+}
+void rdkssaSecFree( void *mem ) {
+    if ( mem != NULL ) {
+        utSecHeld--;
+        free( mem );
+    }
+}
+
+static void ut_dataBufClasses( void );
+static void ut_dataBufReuse( void );
+static void ut_dataBufThreads( void );
+static void ut_pendingResult( void );
+static void ut_benchDataBuf( void );
+
+int utmain_databuf( int argc, char *argv[] ) {
+    RDKSSA_LOG_UT("=== Unit tests DATABUF begin ===\n");
+
+    ut_dataBufClasses( );
+    ut_dataBufReuse( );
+    ut_dataBufThreads( );
+    ut_pendingResult( );
+    ut_benchDataBuf( );
+
+    RDKSSA_LOG_UT("=== Unit tests DATABUF SUCCESS ===\n");
+    return 0;
+}
+
+int main( int argc, char *argv[] ) {
+    return utmain_databuf( argc, argv );
+}
+
+static databuf_hdr_t *utHdr( rdkssaDataBufPtr_t buf ) {
+    return (databuf_hdr_t *)buf - 1;
+}
+
+static int utIsZero( const uint8_t *p, size_t len ) {
+    size_t i;
+    for ( i = 0; i < len; i++ ) {
+        if ( p[i] != 0 ) return 0;
+    }
+    return 1;
+}
+
+static void ut_dataBufClasses( void ) {
+    RDKSSA_LOG_UT("  databuf size classes\n");
+    static const struct { size_t size, capacity; unsigned cls; } c[] = {
+        { 0, 64, 0 }, { 1, 64, 0 }, { 64, 64, 0 }, { 65, 128, 1 }, { 4096, 4096, 6 },
+        { MAX_ATTRIBUTE_BUFF_LENGTH, 32768, 9 }, { 32768, 32768, 9 }, { 32769, 32769, DATABUF_CLASSES },
+    };
+    rdkssaDataBufPtr_t buf;
+    size_t i;
+
+    for ( i = 0; i < sizeof( c ) / sizeof( c[0] ); i++ ) {
+        UTST( ( buf = rdkssaDataBufAlloc( c[i].size ) ) != NULL );
+        UTST( buf->sizeOfData == c[i].size && utIsZero( buf->dataBuffer, c[i].capacity ) );
+        UTST( utHdr( buf )->h.capacity == c[i].capacity && utHdr( buf )->h.cls == c[i].cls );
+        UTST( (uintptr_t)buf->dataBuffer % sizeof( void * ) == 0 );
+        rdkssaDataBufRelease( buf );
+    }
+    rdkssaDataBufRelease( NULL );
+    RDKSSA_LOG_UT("  databuf size classes SUCCESS\n");
+}
+
+static void ut_dataBufReuse( void ) {
+    RDKSSA_LOG_UT("  databuf reuse\n");
+    rdkssaDataBufPtr_t a, b, big[RDKSSA_DATABUF_CACHE_BYTES / RDKSSA_DATABUF_MAX_POOLED + 1];
+    union { databuf_hdr_t hdr; uint8_t bytes[sizeof( databuf_hdr_t ) + sizeof( rdkssaDataBuf_t ) + 16]; } fake;
+    size_t i, cached;
+
+    UTST( ( a = rdkssaDataBufAlloc( 100 ) ) != NULL );
+    memset( a->dataBuffer, 0xa5, 100 );
+    a->sizeOfData = 10;                     // an API returned less than was asked for
+    rdkssaDataBufRelease( a );
+    UTST( utIsZero( a->dataBuffer, 128 ) );
+    // same class, same thread: the buffer just released
+    UTST( ( b = rdkssaDataBufAlloc( 120 ) ) == a && b->sizeOfData == 120 );
+    rdkssaDataBufRelease( b );
+
+    // the cache holds RDKSSA_DATABUF_CACHE_BYTES, the rest is freed
+    cached = threadCache->bytes;
+    for ( i = 0; i < sizeof( big ) / sizeof( big[0] ); i++ ) {
+        UTST( ( big[i] = rdkssaDataBufAlloc( RDKSSA_DATABUF_MAX_POOLED ) ) != NULL );
+    }
+    for ( i = 0; i < sizeof( big ) / sizeof( big[0] ); i++ ) {
+        rdkssaDataBufRelease( big[i] );
+    }
+    UTST( threadCache->bytes <= RDKSSA_DATABUF_CACHE_BYTES && threadCache->bytes > cached );
+
+    RDKSSA_LOG_UT("  expect 2 errors\n");
+    UTST( ( a = rdkssaDataBufAlloc( 16 ) ) != NULL );
+    rdkssaDataBufRelease( a );
+    rdkssaDataBufRelease( a );              // twice
+    UTST( rdkssaDataBufAlloc( 16 ) == a );  // and still only once in the list
+    UTST( ( b = rdkssaDataBufAlloc( 16 ) ) != a );
+    rdkssaDataBufRelease( a );
+    rdkssaDataBufRelease( b );
+    memset( &fake, 0, sizeof( fake ) );
+    rdkssaDataBufRelease( (rdkssaDataBufPtr_t)( &fake.hdr + 1 ) );
+    RDKSSA_LOG_UT("  databuf reuse SUCCESS\n");
+}
+
+#define UT_THREADS      (4)
+#define UT_ROUNDS       (20000)
+
+static rdkssaDataBufPtr_t utHandOff[UT_THREADS];
+
+// each thread churns buffers of a few sizes, marking and checking them; one buffer is left for main
+static void *utDataBufThread( void *arg ) {
+    uint8_t mark = (uint8_t)(uintptr_t)arg;
+    rdkssaDataBufPtr_t p[3];
+    int r, i;
+
+    for ( r = 0; r < UT_ROUNDS; r++ ) {
+        for ( i = 0; i < 3; i++ ) {
+            UTST( ( p[i] = rdkssaDataBufAlloc( (size_t)( 50 << ( 2 * i ) ) ) ) != NULL );
+            UTST( utIsZero( p[i]->dataBuffer, p[i]->sizeOfData ) );
+            memset( p[i]->dataBuffer, mark, p[i]->sizeOfData );
+        }
+        for ( i = 0; i < 3; i++ ) {
+            UTST( p[i]->dataBuffer[0] == mark && p[i]->dataBuffer[p[i]->sizeOfData - 1] == mark );
+            rdkssaDataBufRelease( p[i] );
+        }
+    }
+    UTST( ( utHandOff[mark - 1] = rdkssaDataBufAlloc( 3000 ) ) != NULL );
+    return NULL;
+}
+
+static void ut_dataBufThreads( void ) {
+    RDKSSA_LOG_UT("  databuf threads\n");
+    pthread_t t[UT_THREADS];
+    uintptr_t i;
+
+    for ( i = 0; i < UT_THREADS; i++ ) {
+        UTST( pthread_create( &t[i], NULL, utDataBufThread, (void *)( i + 1 ) ) == 0 );
+    }
+    for ( i = 0; i < UT_THREADS; i++ ) {
+        UTST( pthread_join( t[i], NULL ) == 0 );
+    }
+    // released here, so they go to this thread's list
+    for ( i = 0; i < UT_THREADS; i++ ) {
+        rdkssaDataBufRelease( utHandOff[i] );
+        UTST( threadCache->head[databufClass( 3000 )] == utHdr( utHandOff[i] ) );
+    }
+    RDKSSA_LOG_UT("  databuf threads SUCCESS\n");
+}
+
+// a provider whose result is expensive: counts how often it is computed
+static int utComputed;
+static uint64_t utVersion;
+static rdkssaStatus_t utExpensive( rdkssaDataBufPtr_t out, const char * const attributes[] ) {
+    char result[300];
+    rdkssaStatus_t status;
+
+    if ( rdkssaPendingTake( "utExpensive", attributes, utVersion, out, &status ) ) {
+        return status;
+    }
+    utComputed++;
+    memset( result, 'r', sizeof( result ) );
+    snprintf( result, sizeof( result ), "%s:%llu", attributes[0], (unsigned long long)utVersion );
+    return rdkssaPendingOffer( "utExpensive", attributes, utVersion, result, sizeof( result ), out );
+}
+
+static void *utPendingOtherThread( void *arg ) {
+    rdkssaDataBufPtr_t out = rdkssaDataBufAlloc( 300 );
+    UTST( out != NULL && utExpensive( out, (const char * const *)arg ) == rdkssaOK );
+    rdkssaDataBufRelease( out );
+    return NULL;
+}
+
+static void ut_pendingResult( void ) {
+    RDKSSA_LOG_UT("  pending result\n");
+    const char * const attrs[] = { "NAME=one", "FORMAT=PEM", NULL };
+    const char * const other[] = { "NAME=two", "FORMAT=PEM", NULL };
+    char longAttr[RDKSSA_PENDING_KEY_MAX];
+    const char * const tooLong[] = { longAttr, NULL };
+    rdkssaDataBufPtr_t small = rdkssaDataBufAlloc( 16 ), smaller = rdkssaDataBufAlloc( 8 ), out = rdkssaDataBufAlloc( 300 );
+    pthread_t t;
+
+    UTST( small != NULL && smaller != NULL && out != NULL );
+    // ask, learn the size, ask again: computed once
+    utComputed = 0;
+    UTST( utExpensive( small, attrs ) == rdkssaBadLength && small->sizeOfData == 300 && utComputed == 1 );
+    UTST( utSecHeld == 1 );                     // kept in secure memory
+    UTST( utExpensive( out, attrs ) == rdkssaOK && out->sizeOfData == 300 && utComputed == 1 );
+    UTST( strcmp( (char *)out->dataBuffer, "NAME=one:0" ) == 0 );
+    UTST( threadCache->pending == NULL && utSecHeld == 0 );
+    // taken once: the next call computes
+    UTST( utExpensive( out, attrs ) == rdkssaOK && utComputed == 2 );
+
+    // still too small: kept for the next try
+    small->sizeOfData = 16;
+    UTST( utExpensive( small, attrs ) == rdkssaBadLength && utComputed == 3 );
+    UTST( utExpensive( smaller, attrs ) == rdkssaBadLength && smaller->sizeOfData == 300 && utComputed == 3 );
+    UTST( utExpensive( out, attrs ) == rdkssaOK && utComputed == 3 );
+
+    // other attributes, a new version, another thread or too late: computed again
+    small->sizeOfData = 16;
+    UTST( utExpensive( small, attrs ) == rdkssaBadLength && utComputed == 4 );
+    UTST( utExpensive( out, other ) == rdkssaOK && utComputed == 5 );
+    UTST( strcmp( (char *)out->dataBuffer, "NAME=two:0" ) == 0 );
+    UTST( pthread_create( &t, NULL, utPendingOtherThread, (void *)attrs ) == 0 && pthread_join( t, NULL ) == 0 );
+    UTST( utComputed == 6 );
+    utVersion++;
+    UTST( utExpensive( out, attrs ) == rdkssaOK && utComputed == 7 );
+    UTST( strcmp( (char *)out->dataBuffer, "NAME=one:1" ) == 0 );
+    small->sizeOfData = 16;
+    UTST( utExpensive( small, attrs ) == rdkssaBadLength && utComputed == 8 );
+    threadCache->pendingMs -= RDKSSA_PENDING_TTL_MS + 1;
+    UTST( utExpensive( out, attrs ) == rdkssaOK && utComputed == 9 && threadCache->pending == NULL && utSecHeld == 0 );
+
+    // a key that does not fit is not kept
+    memset( longAttr, 'a', sizeof( longAttr ) - 1 );
+    longAttr[sizeof( longAttr ) - 1] = '\0';
+    small->sizeOfData = 16;
+    UTST( utExpensive( small, tooLong ) == rdkssaBadLength && threadCache->pending == NULL );
+
+    RDKSSA_LOG_UT("  expect 1 error\n");
+    UTST( rdkssaPendingOffer( "utExpensive", attrs, 0, NULL, 1, out ) == rdkssaBadPointer );
+    rdkssaDataBufRelease( small );
+    rdkssaDataBufRelease( smaller );
+    rdkssaDataBufRelease( out );
+    RDKSSA_LOG_UT("  pending result SUCCESS\n");
+}
+
+// bench: a buffer from the pool vs. malloc, wipe and free
+static void ut_benchDataBuf( void ) {
+    RDKSSA_LOG_UT("  bench databuf\n");
+    static const size_t size[] = { 256, 4096, MAX_ATTRIBUTE_BUFF_LENGTH };
+    const int iter = 20000;
+    uint64_t t0, tPool, tMalloc;
+    rdkssaDataBufPtr_t buf;
+    size_t s;
+    int i;
+
+    for ( s = 0; s < sizeof( size ) / sizeof( size[0] ); s++ ) {
+        t0 = utNowNs();
+        for ( i = 0; i < iter; i++ ) {
+            UTST( ( buf = rdkssaDataBufAlloc( size[s] ) ) != NULL );
+            buf->dataBuffer[0] = 1;
+            rdkssaDataBufRelease( buf );
+        }
+        tPool = ( utNowNs() - t0 ) / iter;
+        t0 = utNowNs();
+        for ( i = 0; i < iter; i++ ) {
+            UTST( ( buf = calloc( 1, sizeof( rdkssaDataBuf_t ) + size[s] ) ) != NULL );
+            buf->sizeOfData = size[s];
+            buf->dataBuffer[0] = 1;
+            RDKSSA_WIPE( buf, sizeof( rdkssaDataBuf_t ) + size[s] );
+            free( buf );
+        }
+        tMalloc = ( utNowNs() - t0 ) / iter;
+        RDKSSA_LOG_UT("    %5zu bytes: pool %llu ns, malloc %llu ns\n", size[s],
+                      (unsigned long long)tPool, (unsigned long long)tMalloc );
+    }
+    RDKSSA_LOG_UT("  bench databuf SUCCESS\n");
+}
+
+#endif // UNIT_TESTS
@@ -0,0 +1,821 @@
+/*
+ * Copyright 2020 Comcast Cable Communications Management, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <pthread.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <sys/mount.h>
+#include <time.h>
+
+#include "rdkssa.h"
+#include "rdkssaCommonProtected.h"
+
+/**
+ * Helper process mode
+ *
+ * rdkssaHelperStart launches a long-lived worker (by default "ssacli --helper") connected to the
+ * library by a SOCK_SEQPACKET socketpair on the worker's fd RDKSSA_HELPER_FD.  From then on rdkssaExecv and
+ * rdkssaExecvPipeOutput send their helper launches to the worker instead of starting them from the caller:
+ * the worker is small, so its fork is cheap, and it has already paid for its own start-up and loading.
+ *
+ * Protocol: every request brings its own reply socket, so callers don't wait for each other; helperLock is
+ * only held to send.  The worker runs each request on a thread of its own.
+ *   request   helperRequest_t, then argc 0-terminated strings; SCM_RIGHTS carries the reply socket and, for
+ *             EXEC, an optional stdin fd.  EXEC runs argv[0] and waits up to flags ms (the worker enforces
+ *             the timeout), UMOUNT calls umount2( argv[0], flags ), PING does nothing.
+ *   replies   helperReply_t with RDKSSA_HELPER_TAKEN as soon as the worker has the request, before it acts
+ *             on it; then helperReply_t: EXEC the helper's exit status, UMOUNT 0 or -1 and the errno.
+ *
+ * Crash handling: if the worker can not be reached the request was not delivered, so the worker is reaped,
+ * restarted and the request sent once more; if that fails too the caller runs the helper itself.  If the
+ * worker dies after taking a request, the request is not repeated (a mount may have happened), the caller
+ * sees a failed helper (rdkssaGeneralFailure) and the next request starts a new worker.
+ * A worker that hangs is killed by the first caller it keeps waiting.  If it hasn't taken the request in
+ * RDKSSA_HELPER_TAKE_MS (less if the caller's timeout plus RDKSSA_HELPER_GRACE_MS is sooner), nothing was run
+ * and the caller runs the helper itself; if it took it but hasn't answered by the caller's timeout plus
+ * RDKSSA_HELPER_GRACE_MS, the helper is reported as timed out (rdkssaTimeout) and not run again.
+ */
+
+#define RDKSSA_HELPER_MAGIC         (0x48415353u)   // "SSAH"
+#define RDKSSA_HELPER_TAKEN         (0x54415353u)   // "SSAT"
+#define RDKSSA_HELPER_MSG_MAX       (MAX_ATTRIBUTE_VALUE_LENGTH * 4)
+#ifndef RDKSSA_HELPER_TAKE_MS
+#define RDKSSA_HELPER_TAKE_MS       (1000)
+#endif
+#ifndef RDKSSA_HELPER_GRACE_MS
+#define RDKSSA_HELPER_GRACE_MS      (1000)
+#endif
+
+typedef enum { helperOpPing = 1, helperOpExec, helperOpUmount } helperOp_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t op;
+    uint32_t argc;
+    uint32_t flags;
+} helperRequest_t;
+
+typedef struct {
+    uint32_t magic;
+    int32_t status;
+    int32_t err;
+} helperReply_t;
+
+static struct {
+    int sock;
+    pid_t pid;
+    char path[256];
+    unsigned restarts;
+} helper = { -1, -1, "", 0 };
+
+static pthread_mutex_t helperLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t helperAtforkOnce = PTHREAD_ONCE_INIT;
+
+// a forked child must not talk over its parent's connection
+static void helperAtforkChild( void ) {
+    if ( helper.sock >= 0 ) {
+        close( helper.sock );
+    }
+    helper.sock = -1;
+    helper.pid = -1;
+}
+
+static void helperAtforkInstall( void ) {
+    pthread_atfork( NULL, NULL, helperAtforkChild );
+}
+
+// send one message and nfds (0..2) fds; 0 or -1
+static int helperSend( int sock, const void *buf, size_t len, const int *fds, int nfds ) {
+    struct iovec iov = { (void *)buf, len };
+    union { struct cmsghdr hdr; char buf[CMSG_SPACE(2 * sizeof(int))]; } ctl;
+    struct msghdr msg;
+    ssize_t n;
+
+    memset( &msg, 0, sizeof(msg) );
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if ( nfds > 0 ) {
+        memset( &ctl, 0, sizeof(ctl) );
+        msg.msg_control = ctl.buf;
+        msg.msg_controllen = CMSG_SPACE( nfds * sizeof(int) );
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR( &msg );
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN( nfds * sizeof(int) );
+        memcpy( CMSG_DATA( cmsg ), fds, nfds * sizeof(int) );
+    }
+    do {
+        n = sendmsg( sock, &msg, MSG_NOSIGNAL );
+    } while ( n < 0 && errno == EINTR );
+    return ( n == (ssize_t)len ) ? 0 : -1;
+}
+
+// receive one message and up to 2 fds (-1 for those that didn't come); bytes received, 0 on hangup, -1 on error
+static ssize_t helperRecv( int sock, void *buf, size_t len, int fds[2] ) {
+    struct iovec iov = { buf, len };
+    union { struct cmsghdr hdr; char buf[CMSG_SPACE(2 * sizeof(int))]; } ctl;
+    struct msghdr msg;
+    int rfds[2] = { -1, -1 };
+    ssize_t n;
+    size_t i, nfds;
+
+    memset( &msg, 0, sizeof(msg) );
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctl.buf;
+    msg.msg_controllen = sizeof(ctl.buf);
+    do {
+        n = recvmsg( sock, &msg, MSG_CMSG_CLOEXEC );
+    } while ( n < 0 && errno == EINTR );
+
+    if ( n > 0 ) {
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR( &msg );
+        if ( cmsg != NULL && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS ) {
+            nfds = ( cmsg->cmsg_len - CMSG_LEN( 0 ) ) / sizeof(int);
+            memcpy( rfds, CMSG_DATA( cmsg ), ( nfds < 2 ? nfds : 2 ) * sizeof(int) );
+        }
+        if ( fds == NULL || ( msg.msg_flags & ( MSG_TRUNC | MSG_CTRUNC ) ) ) {
+            for ( i = 0; i < 2; i++ ) {
+                if ( rfds[i] >= 0 ) close( rfds[i] );
+                rfds[i] = -1;
+            }
+            if ( msg.msg_flags & ( MSG_TRUNC | MSG_CTRUNC ) ) {
+                errno = EMSGSIZE;
+                n = -1;
+            }
+        }
+    }
+    if ( fds != NULL ) {
+        fds[0] = rfds[0];
+        fds[1] = rfds[1];
+    }
+    return n;
+}
+
+// an idle control socket carries nothing back, so anything readable means the worker is gone
+static int helperHungUp( int sock ) {
+    struct pollfd pfd = { sock, POLLIN, 0 };
+    return poll( &pfd, 1, 0 ) != 0;
+}
+
+// forget the worker; it exits when it sees the hangup
+static void helperDisconnect( void ) {
+    if ( helper.sock >= 0 ) {
+        close( helper.sock );
+        helper.sock = -1;
+    }
+    if ( helper.pid > 0 ) {
+        while ( waitpid( helper.pid, NULL, 0 ) < 0 && errno == EINTR ) {}
+        helper.pid = -1;
+    }
+}
+
+// launch the worker, helperLock held
+static rdkssaStatus_t helperLaunch( void ) {
+    posix_spawn_file_actions_t actions;
+    char *argv[] = { helper.path, RDKSSA_HELPER_ARG, NULL };
+    int sv[2];
+    pid_t pid;
+    int ret;
+
+    if ( socketpair( AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv ) != 0 ) {
+        RDKSSA_LOG_ERROR( "helper socketpair failed (%d)\n", errno );
+        return rdkssaGeneralFailure;
+    }
+    // dup2 onto itself would leave close-on-exec set
+    if ( sv[1] == RDKSSA_HELPER_FD ) {
+        int moved = fcntl( sv[1], F_DUPFD_CLOEXEC, RDKSSA_HELPER_FD+1 );
+        close( sv[1] );
+        sv[1] = moved;
+    }
+    ret = posix_spawn_file_actions_init( &actions );
+    if ( ret == 0 && sv[1] >= 0 ) {
+        ret = posix_spawn_file_actions_adddup2( &actions, sv[1], RDKSSA_HELPER_FD );
+        if ( ret == 0 ) ret = posix_spawn( &pid, helper.path, &actions, NULL, argv, rdkssaHelperEnv() );
+        posix_spawn_file_actions_destroy( &actions );
+    } else if ( ret == 0 ) {
+        posix_spawn_file_actions_destroy( &actions );
+        ret = EBADF;
+    }
+    if ( sv[1] >= 0 ) close( sv[1] );
+    if ( ret != 0 ) {
+        RDKSSA_LOG_ERROR( "helper %s could not be started (%d)\n", helper.path, ret );
+        close( sv[0] );
+        return rdkssaGeneralFailure;
+    }
+    helper.sock = sv[0];
+    helper.pid = pid;
+    RDKSSA_LOG_INFO( "helper %s started, pid %d\n", helper.path, (int)pid );
+    return rdkssaOK;
+}
+
+rdkssaStatus_t rdkssaHelperStart( const char *helperPath ) {
+    rdkssaStatus_t ret;
+
+    if ( helperPath == NULL ) {
+        helperPath = RDKSSA_HELPER_PATH;
+    }
+    if ( strnlen( helperPath, sizeof(helper.path) ) >= sizeof(helper.path) ) {
+        RDKSSA_LOG_ERROR( "helper path too long\n" );
+        return rdkssaBadLength;
+    }
+    pthread_once( &helperAtforkOnce, helperAtforkInstall );
+    pthread_mutex_lock( &helperLock );
+    helperDisconnect();
+    strcpy( helper.path, helperPath );
+    helper.restarts = 0;
+    ret = helperLaunch();
+    pthread_mutex_unlock( &helperLock );
+    return ret;
+}
+
+void rdkssaHelperStop( void ) {
+    pthread_mutex_lock( &helperLock );
+    helperDisconnect();
+    helper.path[0] = '\0';
+    pthread_mutex_unlock( &helperLock );
+}
+
+int rdkssaHelperActive( void ) {
+    return __atomic_load_n( &helper.path[0], __ATOMIC_RELAXED ) != '\0';
+}
+
+// pack a request; message length or 0 if it does not fit
+static size_t helperPack( char *msg, helperOp_t op, uint32_t flags, const char * const argv[] ) {
+    helperRequest_t *req = (helperRequest_t *)msg;
+    size_t used = sizeof(*req);
+    size_t len;
+    uint32_t argc = 0;
+
+    req->magic = RDKSSA_HELPER_MAGIC;
+    req->op = op;
+    req->flags = flags;
+    while ( argv != NULL && argv[argc] != NULL ) {
+        if ( argc >= MAX_SUPPORTED_ATTRIBUTES ) return 0;
+        len = strnlen( argv[argc], RDKSSA_HELPER_MSG_MAX ) + 1;
+        if ( used + len > RDKSSA_HELPER_MSG_MAX ) return 0;
+        memcpy( msg + used, argv[argc], len );
+        used += len;
+        argc++;
+    }
+    req->argc = argc;
+    return used;
+}
+
+static uint64_t helperNowMs( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+// wait for a reply with magic until endMs (0: no limit); 1 if it came, 0 on timeout, -1 on hangup or garbage
+static int helperWaitReply( int sock, uint32_t magic, uint64_t endMs, helperReply_t *reply ) {
+    struct pollfd pfd = { sock, POLLIN, 0 };
+    uint64_t now;
+    int ms, r;
+
+    for ( ;; ) {
+        ms = -1;
+        if ( endMs != 0 ) {
+            now = helperNowMs();
+            ms = ( now >= endMs ) ? 0 : (int)( endMs - now );
+        }
+        r = poll( &pfd, 1, ms );
+        if ( r < 0 && errno == EINTR ) continue;
+        if ( r == 0 ) return 0;
+        break;
+    }
+    if ( r < 0 || helperRecv( sock, reply, sizeof(*reply), NULL ) != sizeof(*reply) || reply->magic != magic ) {
+        return -1;
+    }
+    return 1;
+}
+
+// stop using the worker pid, killing it if it hangs; the next request starts another
+static void helperDrop( pid_t pid, int hung ) {
+    pthread_mutex_lock( &helperLock );
+    if ( helper.pid == pid && helper.sock >= 0 ) {
+        if ( hung ) {
+            kill( pid, SIGKILL );
+            helperDisconnect();
+        } else {
+            close( helper.sock );
+            helper.sock = -1;
+        }
+    }
+    pthread_mutex_unlock( &helperLock );
+}
+
+/**
+ * send a request to the worker and wait for the reply, at most timeoutMs + RDKSSA_HELPER_GRACE_MS (< 0: no limit)
+ * returns 0 if the worker took the request (*reply is set), -1 if it did not and the caller should do the work
+ */
+static int helperCall( helperOp_t op, uint32_t flags, const char * const argv[], int fd, int timeoutMs, helperReply_t *reply ) {
+    char msg[RDKSSA_HELPER_MSG_MAX];
+    size_t len = helperPack( msg, op, flags, argv );
+    uint64_t endMs = 0, takeMs;
+    int attempt, sent = 0, rs[2], fds[2];
+    pid_t pid = -1;
+    int r;
+
+    if ( len == 0 ) {
+        RDKSSA_LOG_ERROR( "helper request too large\n" );
+        return -1;
+    }
+    if ( socketpair( AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, rs ) != 0 ) {
+        RDKSSA_LOG_ERROR( "helper socketpair failed (%d)\n", errno );
+        return -1;
+    }
+    fds[0] = rs[1];
+    fds[1] = fd;
+    pthread_mutex_lock( &helperLock );
+    for ( attempt = 0; attempt < 2 && !sent; attempt++ ) {
+        if ( helper.path[0] == '\0' ) break;
+        if ( helper.sock < 0 ) {
+            helperDisconnect();     // reap what is left of the last one
+            helper.restarts++;
+            if ( helperLaunch() != rdkssaOK ) break;
+        }
+        if ( helperHungUp( helper.sock ) || helperSend( helper.sock, msg, len, fds, ( fd >= 0 ) ? 2 : 1 ) != 0 ) {
+            RDKSSA_LOG_ERROR( "helper pid %d not reachable (%d), restarting\n", (int)helper.pid, errno );
+            close( helper.sock );
+            helper.sock = -1;
+            continue;
+        }
+        pid = helper.pid;
+        sent = 1;
+    }
+    pthread_mutex_unlock( &helperLock );
+    close( rs[1] );                 // the worker has its own
+    if ( !sent ) {
+        close( rs[0] );
+        return -1;
+    }
+
+    takeMs = helperNowMs() + RDKSSA_HELPER_TAKE_MS;
+    if ( timeoutMs >= 0 ) {
+        endMs = helperNowMs() + (uint64_t)timeoutMs + RDKSSA_HELPER_GRACE_MS;
+        takeMs = ( endMs < takeMs ) ? endMs : takeMs;
+    }
+    r = helperWaitReply( rs[0], RDKSSA_HELPER_TAKEN, takeMs, reply );
+    if ( r == 0 ) {
+        RDKSSA_LOG_ERROR( "helper pid %d did not take the request, stopping it\n", (int)pid );
+        helperDrop( pid, 1 );
+        r = ( helperWaitReply( rs[0], RDKSSA_HELPER_TAKEN, 1, reply ) == 1 ) ? 1 : -1;  // unless it just did
+    }
+    if ( r < 0 ) {
+        close( rs[0] );             // nothing was run
+        return -1;
+    }
+    r = helperWaitReply( rs[0], RDKSSA_HELPER_MAGIC, endMs, reply );
+    close( rs[0] );
+    if ( r != 1 ) {
+        // taken but no answer: don't run it twice
+        if ( r == 0 ) {
+            RDKSSA_LOG_ERROR( "helper pid %d did not answer in %d ms, stopping it\n", (int)pid, timeoutMs );
+        } else {
+            RDKSSA_LOG_ERROR( "helper pid %d died during request\n", (int)pid );
+        }
+        helperDrop( pid, r == 0 );
+        reply->magic = RDKSSA_HELPER_MAGIC;
+        reply->status = ( r == 0 ) ? rdkssaTimeout : rdkssaGeneralFailure;
+        reply->err = ( r == 0 ) ? ETIMEDOUT : EPIPE;
+    }
+    return 0;
+}
+
+int rdkssaHelperExec( const char * const exargv[], int stdinFd, int timeoutMs, int *status ) {
+    helperReply_t reply;
+
+    if ( !rdkssaHelperActive() ) return -1;
+    if ( helperCall( helperOpExec, (uint32_t)timeoutMs, exargv, stdinFd, timeoutMs, &reply ) != 0 ) return -1;
+    *status = reply.status;
+    return 0;
+}
+
+int rdkssaHelperUmount( const char *target, int flags, int *err ) {
+    const char *argv[] = { target, NULL };
+    helperReply_t reply;
+
+    if ( !rdkssaHelperActive() ) return -1;
+    if ( helperCall( helperOpUmount, (uint32_t)flags, argv, -1, RDKSSA_EXEC_TIMEOUT_MS, &reply ) != 0 ) return -1;
+    *err = ( reply.status == 0 ) ? 0 : reply.err;
+    return 0;
+}
+
+unsigned rdkssaHelperRestarts( void ) {
+    return __atomic_load_n( &helper.restarts, __ATOMIC_RELAXED );
+}
+
+/**
+ * Worker side
+ */
+
+// one request the worker has taken, run on its own thread
+typedef struct {
+    int replySock;
+    int fd;                     /* stdin of an EXEC, or -1 */
+    size_t len;
+    char msg[RDKSSA_HELPER_MSG_MAX];
+} helperJob_t;
+
+static pthread_mutex_t jobLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobDone = PTHREAD_COND_INITIALIZER;
+static unsigned jobsRunning;
+
+// split the strings of a request into argv; argc on success, -1 if malformed
+static int helperUnpack( char *msg, size_t len, const char *argv[MAX_SUPPORTED_ATTRIBUTES+1] ) {
+    helperRequest_t *req = (helperRequest_t *)msg;
+    size_t used = sizeof(*req);
+    uint32_t i;
+
+    if ( len < sizeof(*req) || req->magic != RDKSSA_HELPER_MAGIC || req->argc > MAX_SUPPORTED_ATTRIBUTES ) {
+        return -1;
+    }
+    for ( i = 0; i < req->argc; i++ ) {
+        const char *end = memchr( msg + used, '\0', len - used );
+        if ( end == NULL ) return -1;
+        argv[i] = msg + used;
+        used = (size_t)( end - msg ) + 1;
+    }
+    argv[i] = NULL;
+    return ( used == len ) ? (int)req->argc : -1;
+}
+
+// run a request and answer it on its reply socket
+static void helperRun( helperJob_t *job ) {
+    const char *argv[MAX_SUPPORTED_ATTRIBUTES+1];
+    helperRequest_t *req = (helperRequest_t *)job->msg;
+    helperReply_t reply;
+    int argc;
+
+    reply.magic = RDKSSA_HELPER_MAGIC;
+    reply.status = rdkssaGeneralFailure;
+    reply.err = 0;
+    argc = helperUnpack( job->msg, job->len, argv );
+    if ( argc < 0 ) {
+        RDKSSA_LOG_ERROR( "helper malformed request\n" );
+        reply.err = EPROTO;
+    } else if ( req->op == helperOpPing ) {
+        reply.status = 0;
+    } else if ( req->op == helperOpExec && argc > 0 ) {
+        reply.status = rdkssaExecvLocal( argv, job->fd, (int)req->flags );
+    } else if ( req->op == helperOpUmount && argc == 1 ) {
+        reply.status = umount2( argv[0], (int)req->flags );
+        reply.err = ( reply.status == 0 ) ? 0 : errno;
+    } else {
+        reply.err = EINVAL;
+    }
+    (void)helperSend( job->replySock, &reply, sizeof(reply), NULL, 0 );     // the caller may have given up
+    if ( job->fd >= 0 ) close( job->fd );
+    close( job->replySock );
+    free( job );
+}
+
+static void *helperJobThread( void *arg ) {
+    helperRun( arg );
+    pthread_mutex_lock( &jobLock );
+    if ( --jobsRunning == 0 ) {
+        pthread_cond_broadcast( &jobDone );
+    }
+    pthread_mutex_unlock( &jobLock );
+    return NULL;
+}
+
+int rdkssaHelperServe( int sock ) {
+    const helperReply_t taken = { RDKSSA_HELPER_TAKEN, 0, 0 };
+    helperJob_t *job;
+    pthread_attr_t attr;
+    pthread_t t;
+    ssize_t n;
+    int fds[2], ret = 0;
+
+    RDKSSA_LOG_INFO( "helper serving on fd %d\n", sock );
+    pthread_attr_init( &attr );
+    pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+    for ( ;; ) {
+        if ( ( job = malloc( sizeof(*job) ) ) == NULL ) {
+            RDKSSA_LOG_ERROR( "helper out of memory\n" );
+            ret = 1;
+            break;
+        }
+        n = helperRecv( sock, job->msg, sizeof(job->msg), fds );
+        if ( n <= 0 ) {
+            free( job );
+            if ( n < 0 && errno == EMSGSIZE ) continue;
+            if ( n < 0 ) {
+                RDKSSA_LOG_ERROR( "helper receive failed (%d)\n", errno );
+                ret = 1;
+            }
+            break;      // or client gone
+        }
+        if ( fds[0] < 0 ) {
+            RDKSSA_LOG_ERROR( "helper request without a reply socket\n" );
+            if ( fds[1] >= 0 ) close( fds[1] );
+            free( job );
+            continue;
+        }
+        job->replySock = fds[0];
+        job->fd = fds[1];
+        job->len = (size_t)n;
+        if ( helperSend( job->replySock, &taken, sizeof(taken), NULL, 0 ) != 0 ) {
+            if ( job->fd >= 0 ) close( job->fd );
+            close( job->replySock );                // the caller gave up
+            free( job );
+            continue;
+        }
+        pthread_mutex_lock( &jobLock );
+        jobsRunning++;
+        pthread_mutex_unlock( &jobLock );
+        if ( pthread_create( &t, &attr, helperJobThread, job ) != 0 ) {
+            helperJobThread( job );                 // no thread: run it here
+        }
+    }
+    pthread_attr_destroy( &attr );
+    // finish what was taken before going
+    pthread_mutex_lock( &jobLock );
+    while ( jobsRunning > 0 ) {
+        pthread_cond_wait( &jobDone, &jobLock );
+    }
+    pthread_mutex_unlock( &jobLock );
+    return ret;
+}
+
+#ifdef UNIT_TESTS
+#include "unit_tests.h"
+
+// stubs of the ssaCommon.c functions
+int rdkssaLogLevel = RDKSSA_LOG_LEVEL_DEFAULT;
+char * const *rdkssaHelperEnv( void ) {
+    extern char** environ;
+    return environ;
+}
+int rdkssaExecvLocal( const char * const exargv[], int stdinFd, int timeoutMs ) {
+    extern char** environ;
+    int status;
+    pid_t pid = fork();
+    if ( pid == 0 ) {
+        if ( stdinFd >= 0 ) dup2( stdinFd, 0 );
+        execve( exargv[0], (char * const *)exargv, environ );
+        _exit( 255 );
+    }
+    if ( pid < 0 ) return rdkssaGeneralFailure;
+    while ( timeoutMs >= 0 && waitpid( pid, &status, WNOHANG ) == 0 ) {
+        struct timespec ts = { 0, 10000000 };
+        if ( timeoutMs == 0 ) {
+            kill( pid, SIGKILL );
+            waitpid( pid, &status, 0 );
+            return rdkssaTimeout;
+        }
+        nanosleep( &ts, NULL );
+        timeoutMs = ( timeoutMs > 10 ) ? timeoutMs - 10 : 0;
+    }
+    if ( timeoutMs < 0 && waitpid( pid, &status, 0 ) != pid ) return rdkssaGeneralFailure;
+    return WIFEXITED( status ) ? WEXITSTATUS( status ) : rdkssaGeneralFailure;
+}
+
+static void ut_helperExec( void );
+static void ut_helperRestart( void );
+static void ut_helperConcurrent( void );
+static void ut_helperHung( void );
+static void ut_benchHelper( void );
+
+int utmain_helper( int argc, char *argv[] ) {
+    RDKSSA_LOG_UT("=== Unit tests HELPER begin ===\n");
+
+    ut_helperExec( );
+    ut_helperRestart( );
+    ut_helperConcurrent( );
+    ut_helperHung( );
+    ut_benchHelper( );
+
+    rdkssaHelperStop( );
+    RDKSSA_LOG_UT("=== Unit tests HELPER SUCCESS ===\n");
+    return 0;
+}
+
+// this binary is also the stub worker
+int main( int argc, char *argv[] ) {
+    if ( argc == 2 && strcmp( argv[1], RDKSSA_HELPER_ARG ) == 0 ) {
+        return rdkssaHelperServe( RDKSSA_HELPER_FD );
+    }
+    return utmain_helper( argc, argv );
+}
+
+static int utPipeWith( const char *data ) {
+    int fds[2];
+    UTST0( pipe( fds ) );
+    UTST( write( fds[1], data, strlen(data) ) == (ssize_t)strlen(data) );
+    close( fds[1] );
+    return fds[0];
+}
+
+static void ut_helperExec( void ) {
+    RDKSSA_LOG_UT("  helper exec\n");
+    const char * const argTrue[] = { "/bin/true", NULL };
+    const char * const argExit[] = { "/bin/sh", "-c", "exit 3", NULL };
+    const char * const argStdin[] = { "/bin/sh", "-c", "read x; test \"$x\" = hello", NULL };
+    const char * const argMissing[] = { "/notfound/helper", NULL };
+    int status = -1, err = -1, fd;
+
+    UTST( rdkssaHelperActive() == 0 );
+    UTST( rdkssaHelperExec( argTrue, -1, -1, &status ) == -1 );     // not started: caller runs it
+
+    UTST( rdkssaHelperStart( "/proc/self/exe" ) == rdkssaOK );
+    UTST( rdkssaHelperActive() );
+    UTST( rdkssaHelperExec( argTrue, -1, -1, &status ) == 0 && status == 0 );
+    UTST( rdkssaHelperExec( argExit, -1, -1, &status ) == 0 && status == 3 );
+    UTST( rdkssaHelperExec( argMissing, -1, -1, &status ) == 0 && status == 255 );
+    fd = utPipeWith( "hello\n" );
+    UTST( rdkssaHelperExec( argStdin, fd, -1, &status ) == 0 && status == 0 );
+    close( fd );
+    fd = utPipeWith( "bye\n" );
+    UTST( rdkssaHelperExec( argStdin, fd, -1, &status ) == 0 && status == 1 );
+    close( fd );
+
+    // the worker enforces the caller's timeout
+    const char * const argSleep[] = { "/bin/sleep", "5", NULL };
+    UTST( rdkssaHelperExec( argSleep, -1, 200, &status ) == 0 && status == rdkssaTimeout );
+
+    // the worker can umount; this target is not mounted
+    UTST( rdkssaHelperUmount( "/tmp/rdkssa-not-mounted", 0, &err ) == 0 && err != 0 );
+
+    // too big for one request: not delivered
+    static char big[RDKSSA_HELPER_MSG_MAX];
+    memset( big, 'a', sizeof(big)-1 );
+    const char * const argBig[] = { "/bin/true", big, NULL };
+    RDKSSA_LOG_UT("  helper exec expect 1 error\n");
+    UTST( rdkssaHelperExec( argBig, -1, -1, &status ) == -1 );
+    RDKSSA_LOG_UT("  helper exec SUCCESS\n");
+}
+
+static void ut_helperRestart( void ) {
+    RDKSSA_LOG_UT("  helper restart\n");
+    const char * const argTrue[] = { "/bin/true", NULL };
+    const char * const argSleep[] = { "/bin/sleep", "1", NULL };
+    int status = -1;
+    unsigned restarts = rdkssaHelperRestarts();
+    pid_t victim;
+
+    // killed while idle: the request is not lost, a new worker takes it
+    RDKSSA_LOG_UT("  helper restart expect 1 error\n");
+    victim = helper.pid;
+    UTST0( kill( victim, SIGKILL ) );
+    siginfo_t info;
+    UTST0( waitid( P_PID, victim, &info, WEXITED | WNOWAIT ) );    // gone, but left for the library to reap
+    UTST( rdkssaHelperExec( argTrue, -1, -1, &status ) == 0 && status == 0 );
+    UTST( helper.pid != victim );
+    UTST( rdkssaHelperRestarts() == restarts + 1 );
+
+    // killed while working: reported as a failed helper, not repeated
+    RDKSSA_LOG_UT("  helper restart expect 1 error\n");
+    victim = helper.pid;
+    if ( fork() == 0 ) {
+        struct timespec ts = { 0, 200000000 };
+        nanosleep( &ts, NULL );
+        kill( victim, SIGKILL );
+        _exit( 0 );
+    }
+    UTST( rdkssaHelperExec( argSleep, -1, -1, &status ) == 0 && status == rdkssaGeneralFailure );
+    wait( NULL );
+    UTST( rdkssaHelperExec( argTrue, -1, -1, &status ) == 0 && status == 0 );
+    UTST( rdkssaHelperRestarts() == restarts + 2 );
+
+    // a worker that can not be started: callers fall back to running helpers themselves
+    RDKSSA_LOG_UT("  helper restart expect 2 errors\n");
+    UTST( rdkssaHelperStart( "/notfound/worker" ) != rdkssaOK );
+    UTST( rdkssaHelperExec( argTrue, -1, -1, &status ) == -1 );
+    rdkssaHelperStop( );
+    UTST( rdkssaHelperActive() == 0 );
+    RDKSSA_LOG_UT("  helper restart SUCCESS\n");
+}
+
+#define UT_CALLERS      (4)
+
+static void *utSleepCaller( void *arg ) {
+    const char * const argNap[] = { "/bin/sleep", "0.3", NULL };
+    int status = -1;
+    UTST( rdkssaHelperExec( argNap, -1, -1, &status ) == 0 && status == 0 );
+    return NULL;
+}
+
+// requests from several threads run at the same time in the worker
+static void ut_helperConcurrent( void ) {
+    RDKSSA_LOG_UT("  helper concurrent\n");
+    pthread_t t[UT_CALLERS];
+    uint64_t t0, elapsed;
+    int i;
+
+    UTST( rdkssaHelperStart( "/proc/self/exe" ) == rdkssaOK );
+    t0 = utNowNs();
+    for ( i = 0; i < UT_CALLERS; i++ ) {
+        UTST0( pthread_create( &t[i], NULL, utSleepCaller, NULL ) );
+    }
+    for ( i = 0; i < UT_CALLERS; i++ ) {
+        UTST0( pthread_join( t[i], NULL ) );
+    }
+    elapsed = ( utNowNs() - t0 ) / 1000000;
+    RDKSSA_LOG_UT("    %d x 300 ms helpers in %llu ms\n", UT_CALLERS, (unsigned long long)elapsed );
+    UTST( elapsed < 300 * UT_CALLERS / 2 );
+    RDKSSA_LOG_UT("  helper concurrent SUCCESS\n");
+}
+
+static void *utStopWorker( void *arg ) {
+    struct timespec ts = { 0, 100000000 };
+    nanosleep( &ts, NULL );
+    kill( (pid_t)(intptr_t)arg, SIGSTOP );
+    return NULL;
+}
+
+// a worker that stops answering: the caller's timeout still holds, and the next request gets a new worker
+static void ut_helperHung( void ) {
+    RDKSSA_LOG_UT("  helper hung\n");
+    const char * const argTrue[] = { "/bin/true", NULL };
+    const char * const argSleep[] = { "/bin/sleep", "2", NULL };
+    unsigned restarts = rdkssaHelperRestarts();
+    int status = -1;
+    uint64_t t0, elapsed;
+    pthread_t t;
+
+    // hung before taking the request: not taken, the caller runs it
+    RDKSSA_LOG_UT("  helper hung expect 1 error\n");
+    UTST0( kill( helper.pid, SIGSTOP ) );
+    t0 = utNowNs();
+    UTST( rdkssaHelperExec( argTrue, -1, 200, &status ) == -1 );
+    elapsed = ( utNowNs() - t0 ) / 1000000;
+    UTST( elapsed >= 200 && elapsed < 200 + RDKSSA_HELPER_GRACE_MS + 500 );
+    UTST( rdkssaHelperExec( argTrue, -1, -1, &status ) == 0 && status == 0 );
+    UTST( rdkssaHelperRestarts() == restarts + 1 );
+
+    // hung while the helper runs: a timed out helper, not run again
+    RDKSSA_LOG_UT("  helper hung expect 1 error\n");
+    UTST0( pthread_create( &t, NULL, utStopWorker, (void *)(intptr_t)helper.pid ) );
+    t0 = utNowNs();
+    UTST( rdkssaHelperExec( argSleep, -1, 300, &status ) == 0 && status == rdkssaTimeout );
+    elapsed = ( utNowNs() - t0 ) / 1000000;
+    UTST0( pthread_join( t, NULL ) );
+    UTST( elapsed >= 300 + RDKSSA_HELPER_GRACE_MS && elapsed < 300 + RDKSSA_HELPER_GRACE_MS + 500 );
+    UTST( rdkssaHelperExec( argTrue, -1, -1, &status ) == 0 && status == 0 );
+    UTST( rdkssaHelperRestarts() == restarts + 2 );
+    RDKSSA_LOG_UT("  helper hung SUCCESS\n");
+}
+
+static uint64_t utRunLocal( const char * const argv[], int iter ) {
+    uint64_t t0 = utNowNs();
+    int i;
+    for ( i = 0; i < iter; i++ ) UTST( rdkssaExecvLocal( argv, -1, -1 ) == 0 );
+    return ( utNowNs() - t0 ) / iter;
+}
+
+static uint64_t utRunHelper( const char * const argv[], int iter ) {
+    uint64_t t0 = utNowNs();
+    int i, status;
+    for ( i = 0; i < iter; i++ ) UTST( rdkssaHelperExec( argv, -1, -1, &status ) == 0 && status == 0 );
+    return ( utNowNs() - t0 ) / iter;
+}
+
+// bench: helper launch from a caller with a large RSS, directly vs. through the worker
+static void ut_benchHelper( void ) {
+    RDKSSA_LOG_UT("  bench helper\n");
+    const char * const argTrue[] = { "/bin/true", NULL };
+    const size_t ballastSz = (size_t)256 << 20;
+    const int iter = 20;
+    uint64_t tLocal, tHelper;
+    char *ballast;
+
+    UTST( rdkssaHelperStart( "/proc/self/exe" ) == rdkssaOK );     // small worker, started before the ballast
+    ballast = malloc( ballastSz );
+    if ( ballast == NULL ) {
+        RDKSSA_LOG_UT("  bench helper skipped, no memory\n");
+        return;
+    }
+    memset( ballast, 0x5a, ballastSz );
+    tLocal = utRunLocal( argTrue, iter );
+    tHelper = utRunHelper( argTrue, iter );
+    free( ballast );
+    RDKSSA_LOG_UT("    caller +256 MB RSS: fork in caller %llu us/helper, worker %llu us/helper\n",
+                  (unsigned long long)(tLocal/1000), (unsigned long long)(tHelper/1000) );
+    RDKSSA_LOG_UT("  bench helper SUCCESS\n");
+}
+
+#endif // UNIT_TESTS
@@ -0,0 +1,462 @@
+/*
+ * Copyright 2020 Comcast Cable Communications Management, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#include "rdkssa.h"
+
+#ifdef RDKSSA_LOG_FILE
+
+/**
+ * Log file backend
+ *
+ * Callers format their line into a slot of a bounded lock-free ring (one CAS to claim a slot, one store
+ * to publish it) and go on.  A writer thread, started on first use, keeps RDKSSA_DEBUG_LOG_FILE_NAME open
+ * and drains the ring in batches: waiting lines are gathered into one buffer and appended with one write().
+ * The writer does not use stdio, so a forked child never inherits half a batch to write out again.
+ *
+ * - the writer only sleeps when the ring is empty; producers post the semaphore only when it does
+ * - if the ring is full the line is dropped and counted, the writer reports the count in the log
+ * - lines longer than RDKSSA_LOG_LINE_MAX are cut short
+ * - rdkssaLogFlush waits until everything logged so far is written; it is registered with atexit
+ * - a forked child has no writer thread, so it logs synchronously (fopen/fclose per line) until it exits
+ *   or execs; the same happens if the writer thread can not be started
+ */
+
+#ifndef RDKSSA_LOG_RING_SLOTS
+#define RDKSSA_LOG_RING_SLOTS   (128)   // power of 2
+#endif
+#ifndef RDKSSA_LOG_LINE_MAX
+#define RDKSSA_LOG_LINE_MAX     (512)
+#endif
+#define RDKSSA_LOG_FLUSH_WAIT_MS (2000)
+#define RDKSSA_LOG_BATCH_SIZE   (16*1024)
+
+typedef struct {
+    size_t seq;                         // slot sequence, see logRingPut/logRingPeek
+    unsigned len;
+    char text[RDKSSA_LOG_LINE_MAX];
+} logSlot_t;
+
+typedef enum { logModeIdle = 0, logModeAsync, logModeSync } logMode_t;
+
+static struct {
+    logSlot_t slot[RDKSSA_LOG_RING_SLOTS];
+    size_t putPos;                      // next slot to claim, shared by producers
+    size_t getPos;                      // next slot to write, writer only
+    unsigned dropped;
+    int writerSleeping;
+    int mode;                           // logMode_t
+    sem_t wake;
+    pthread_mutex_t flushLock;
+    pthread_cond_t flushed;
+    int fd;
+} logRing = { .flushLock = PTHREAD_MUTEX_INITIALIZER, .flushed = PTHREAD_COND_INITIALIZER, .fd = -1 };
+
+static pthread_mutex_t logStartLock = PTHREAD_MUTEX_INITIALIZER;
+
+// the pre-ring behaviour, used whenever there is no writer thread
+static void logSync( const char *fmt, va_list va ) {
+    FILE* debug_file = fopen(RDKSSA_DEBUG_LOG_FILE_NAME, "ae" );
+    if (debug_file != NULL) {
+        vfprintf(debug_file,fmt,va);
+        fflush(debug_file);
+        fclose(debug_file);
+    }
+    else{
+       fprintf(stderr,"ERROR!!! rdkssa debug log file not set \n");
+    }
+}
+
+static void logRingReset( void ) {
+    size_t i;
+    for ( i = 0; i < RDKSSA_LOG_RING_SLOTS; i++ ) {
+        logRing.slot[i].seq = i;
+    }
+    logRing.putPos = 0;
+    logRing.getPos = 0;
+    logRing.dropped = 0;
+    logRing.writerSleeping = 0;
+}
+
+// claim a slot, format into it, publish it. returns 0 if the ring is full
+static int logRingPut( const char *fmt, va_list va ) {
+    size_t pos = __atomic_load_n( &logRing.putPos, __ATOMIC_RELAXED );
+    logSlot_t *slot;
+    int len;
+
+    for ( ;; ) {
+        slot = &logRing.slot[pos & (RDKSSA_LOG_RING_SLOTS-1)];
+        size_t seq = __atomic_load_n( &slot->seq, __ATOMIC_ACQUIRE );
+        long dif = (long)seq - (long)pos;
+        if ( dif == 0 ) {
+            if ( __atomic_compare_exchange_n( &logRing.putPos, &pos, pos+1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) ) {
+                break;
+            }
+        } else if ( dif < 0 ) {
+            return 0;   // full: the writer has not freed this slot yet
+        } else {
+            pos = __atomic_load_n( &logRing.putPos, __ATOMIC_RELAXED );
+        }
+    }
+
+    len = vsnprintf( slot->text, sizeof(slot->text), fmt, va );
+    if ( len < 0 ) {
+        len = 0;
+    } else if ( len >= (int)sizeof(slot->text) ) {
+        memcpy( &slot->text[sizeof(slot->text)-5], "...\n", 5 );
+        len = sizeof(slot->text) - 1;
+    }
+    slot->len = (unsigned)len;
+    __atomic_store_n( &slot->seq, pos+1, __ATOMIC_SEQ_CST );
+    return 1;
+}
+
+// writer side: next published slot or NULL
+static logSlot_t *logRingPeek( void ) {
+    logSlot_t *slot = &logRing.slot[logRing.getPos & (RDKSSA_LOG_RING_SLOTS-1)];
+    if ( __atomic_load_n( &slot->seq, __ATOMIC_SEQ_CST ) != logRing.getPos+1 ) {
+        return NULL;
+    }
+    return slot;
+}
+
+static void logRingRelease( logSlot_t *slot ) {
+    __atomic_store_n( &slot->seq, logRing.getPos + RDKSSA_LOG_RING_SLOTS, __ATOMIC_RELEASE );
+    __atomic_store_n( &logRing.getPos, logRing.getPos+1, __ATOMIC_RELEASE );
+}
+
+static void logWake( void ) {
+    if ( __atomic_exchange_n( &logRing.writerSleeping, 0, __ATOMIC_SEQ_CST ) ) {
+        sem_post( &logRing.wake );
+    }
+}
+
+static void logWriteAll( const char *buf, size_t len ) {
+    ssize_t n;
+    while ( len > 0 && logRing.fd >= 0 ) {
+        n = write( logRing.fd, buf, len );
+        if ( n < 0 ) {
+            if ( errno == EINTR ) continue;
+            close( logRing.fd );    // reopen on the next batch (log rotation, full disk)
+            logRing.fd = -1;
+            return;
+        }
+        buf += n;
+        len -= (size_t)n;
+    }
+}
+
+// write one batch, return number of lines written
+static unsigned logDrain( void ) {
+    static char batch[RDKSSA_LOG_BATCH_SIZE];
+    size_t used = 0;
+    logSlot_t *slot;
+    unsigned lines = 0;
+    unsigned dropped;
+
+    if ( logRing.fd < 0 ) {
+        logRing.fd = open( RDKSSA_DEBUG_LOG_FILE_NAME, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0666 );
+        if ( logRing.fd < 0 ) {
+            fprintf(stderr,"ERROR!!! rdkssa debug log file not set \n");
+        }
+    }
+    while ( ( slot = logRingPeek() ) != NULL ) {
+        if ( used + slot->len > sizeof(batch) ) {
+            logWriteAll( batch, used );
+            used = 0;
+        }
+        memcpy( &batch[used], slot->text, slot->len );
+        used += slot->len;
+        logRingRelease( slot );
+        lines++;
+    }
+    dropped = __atomic_exchange_n( &logRing.dropped, 0, __ATOMIC_RELAXED );
+    if ( dropped ) {
+        if ( used + 64 > sizeof(batch) ) {
+            logWriteAll( batch, used );
+            used = 0;
+        }
+        used += (size_t)snprintf( &batch[used], 64, "rdkssa log: %u lines dropped\n", dropped );
+    }
+    logWriteAll( batch, used );
+    return lines;
+}
+
+static void *logWriter( void *arg ) {
+    (void)arg;
+    for ( ;; ) {
+        logDrain();
+        pthread_mutex_lock( &logRing.flushLock );
+        pthread_cond_broadcast( &logRing.flushed );
+        pthread_mutex_unlock( &logRing.flushLock );
+
+        // announce the nap, then look once more so a line published in between is not missed
+        __atomic_store_n( &logRing.writerSleeping, 1, __ATOMIC_SEQ_CST );
+        if ( logRingPeek() != NULL || __atomic_load_n( &logRing.dropped, __ATOMIC_RELAXED ) ) {
+            if ( __atomic_exchange_n( &logRing.writerSleeping, 0, __ATOMIC_SEQ_CST ) ) {
+                continue;
+            }
+        }
+        while ( sem_wait( &logRing.wake ) != 0 && errno == EINTR ) {}
+    }
+    return NULL;
+}
+
+// a child keeps the ring of its parent but not the writer thread
+static void logAtforkChild( void ) {
+    logRing.mode = logModeSync;
+}
+
+static void logStart( void ) {
+    pthread_t writer;
+    pthread_attr_t attr;
+    int mode = logModeSync;
+
+    pthread_mutex_lock( &logStartLock );
+    if ( logRing.mode == logModeIdle ) {
+        logRingReset();
+        if ( sem_init( &logRing.wake, 0, 0 ) == 0 ) {
+            pthread_attr_init( &attr );
+            pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+            if ( pthread_create( &writer, &attr, logWriter, NULL ) == 0 ) {
+                mode = logModeAsync;
+                pthread_atfork( NULL, NULL, logAtforkChild );
+                atexit( rdkssaLogFlush );
+            }
+            pthread_attr_destroy( &attr );
+        }
+        __atomic_store_n( &logRing.mode, mode, __ATOMIC_RELEASE );
+    }
+    pthread_mutex_unlock( &logStartLock );
+}
+
+void _rdkssa_debug_log( const char* fmt, ...) {
+    va_list va;
+    int mode = __atomic_load_n( &logRing.mode, __ATOMIC_ACQUIRE );
+
+    if ( mode == logModeIdle ) {
+        logStart();
+        mode = __atomic_load_n( &logRing.mode, __ATOMIC_ACQUIRE );
+    }
+    va_start(va,fmt);
+    if ( mode == logModeAsync ) {
+        if ( !logRingPut( fmt, va ) ) {
+            __atomic_add_fetch( &logRing.dropped, 1, __ATOMIC_RELAXED );
+        }
+        logWake();
+    } else {
+        logSync( fmt, va );
+    }
+    va_end(va);
+}
+
+void rdkssaLogFlush( void ) {
+    struct timespec deadline;
+    size_t target;
+
+    if ( __atomic_load_n( &logRing.mode, __ATOMIC_ACQUIRE ) != logModeAsync ) {
+        return;
+    }
+    target = __atomic_load_n( &logRing.putPos, __ATOMIC_ACQUIRE );
+    clock_gettime( CLOCK_REALTIME, &deadline );
+    deadline.tv_sec += RDKSSA_LOG_FLUSH_WAIT_MS / 1000;
+    deadline.tv_nsec += (RDKSSA_LOG_FLUSH_WAIT_MS % 1000) * 1000000L;
+    if ( deadline.tv_nsec >= 1000000000L ) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock( &logRing.flushLock );
+    while ( (long)( __atomic_load_n( &logRing.getPos, __ATOMIC_ACQUIRE ) - target ) < 0 ) {
+        logWake();
+        if ( pthread_cond_timedwait( &logRing.flushed, &logRing.flushLock, &deadline ) == ETIMEDOUT ) {
+            break;  // a producer stalled mid line or the writer is stuck, don't hang the caller
+        }
+    }
+    pthread_mutex_unlock( &logRing.flushLock );
+}
+
+#endif // RDKSSA_LOG_FILE
+
+#ifdef UNIT_TESTS
+#include <unistd.h>
+#include <sys/wait.h>
+#include "unit_tests.h"
+
+#ifndef RDKSSA_LOG_FILE
+#error "log unit tests need RDKSSA_LOG_FILE and a scratch RDKSSA_DEBUG_LOG_FILE_NAME"
+#endif
+
+#define UT_LOG_THREADS  (8)
+#define UT_LOG_LINES    (4000)
+
+static void ut_logBasic( void );
+static void ut_logThreads( void );
+static void ut_logFork( void );
+static void ut_benchLog( void );
+
+int utmain_log( int argc, char *argv[] ) {
+    RDKSSA_LOG_UT("=== Unit tests LOG begin ===\n");
+
+    ut_logBasic( );
+    ut_logThreads( );
+    ut_logFork( );
+    ut_benchLog( );
+
+    unlink( RDKSSA_DEBUG_LOG_FILE_NAME );
+    RDKSSA_LOG_UT("=== Unit tests LOG SUCCESS ===\n");
+    return 0;
+}
+
+int main( int argc, char *argv[] ) {
+    return utmain_log( argc, argv );
+}
+
+// count the lines of the log file that start with prefix, and add up any drop reports
+static int utCountLines( const char *prefix, unsigned *dropped ) {
+    char line[RDKSSA_LOG_LINE_MAX+1];
+    unsigned n;
+    int count = 0;
+    FILE *f = fopen( RDKSSA_DEBUG_LOG_FILE_NAME, "r" );
+    if ( f == NULL ) return -1;
+    if ( dropped ) *dropped = 0;
+    while ( fgets( line, sizeof(line), f ) != NULL ) {
+        if ( strncmp( line, prefix, strlen(prefix) ) == 0 ) {
+            count++;
+        } else if ( dropped && sscanf( line, "rdkssa log: %u lines dropped", &n ) == 1 ) {
+            *dropped += n;
+        }
+    }
+    fclose( f );
+    return count;
+}
+
+static void ut_logBasic( void ) {
+    RDKSSA_LOG_UT("  log basic\n");
+    unlink( RDKSSA_DEBUG_LOG_FILE_NAME );
+    UTST( logRing.mode == logModeIdle );
+    rdkssaLogFlush( );  // nothing started yet
+    _rdkssa_debug_log( "basic %d %s\n", 1, "one" );
+    UTST( logRing.mode == logModeAsync );
+    _rdkssa_debug_log( "basic %d %s\n", 2, "two" );
+    rdkssaLogFlush( );
+    UTST( utCountLines( "basic ", NULL ) == 2 );
+
+    // overlong lines are cut, not split
+    char big[RDKSSA_LOG_LINE_MAX*2];
+    memset( big, 'x', sizeof(big)-1 );
+    big[sizeof(big)-1] = '\0';
+    _rdkssa_debug_log( "basic long %s\n", big );
+    rdkssaLogFlush( );
+    UTST( utCountLines( "basic ", NULL ) == 3 );
+    UTST( utCountLines( "xxx", NULL ) == 0 );
+    RDKSSA_LOG_UT("  log basic SUCCESS\n");
+}
+
+static void *utLogProducer( void *arg ) {
+    int id = (int)(intptr_t)arg;
+    int i;
+    for ( i = 0; i < UT_LOG_LINES; i++ ) {
+        _rdkssa_debug_log( "thread %d line %d\n", id, i );
+        if ( (i & 63) == 0 ) sched_yield();
+    }
+    return NULL;
+}
+
+static void ut_logThreads( void ) {
+    RDKSSA_LOG_UT("  log threads\n");
+    pthread_t tid[UT_LOG_THREADS];
+    unsigned dropped;
+    int i, written;
+
+    for ( i = 0; i < UT_LOG_THREADS; i++ ) {
+        UTST0( pthread_create( &tid[i], NULL, utLogProducer, (void *)(intptr_t)i ) );
+    }
+    for ( i = 0; i < UT_LOG_THREADS; i++ ) {
+        UTST0( pthread_join( tid[i], NULL ) );
+    }
+    rdkssaLogFlush( );
+    written = utCountLines( "thread ", &dropped );
+    RDKSSA_LOG_UT("    %d lines written, %u dropped\n", written, dropped );
+    UTST( (unsigned)written + dropped == UT_LOG_THREADS * UT_LOG_LINES );
+    UTST( written > 0 );
+    RDKSSA_LOG_UT("  log threads SUCCESS\n");
+}
+
+static void ut_logFork( void ) {
+    RDKSSA_LOG_UT("  log fork\n");
+    int status = 0;
+    pid_t pid = fork();
+    UTST( pid >= 0 );
+    if ( pid == 0 ) {
+        UTST( logRing.mode == logModeSync );
+        _rdkssa_debug_log( "fork child %d\n", 1 );
+        _exit( 0 );
+    }
+    UTST( waitpid( pid, &status, 0 ) == pid && WIFEXITED( status ) && WEXITSTATUS( status ) == 0 );
+    UTST( logRing.mode == logModeAsync );
+    _rdkssa_debug_log( "fork parent %d\n", 1 );
+    rdkssaLogFlush( );
+    UTST( utCountLines( "fork child ", NULL ) == 1 );
+    UTST( utCountLines( "fork parent ", NULL ) == 1 );
+    RDKSSA_LOG_UT("  log fork SUCCESS\n");
+}
+
+static void utLogSync( const char *fmt, ... ) {
+    va_list va;
+    va_start( va, fmt );
+    logSync( fmt, va );
+    va_end( va );
+}
+
+// bench: caller side cost of a line, fopen/fclose per line vs. ring
+static void ut_benchLog( void ) {
+    RDKSSA_LOG_UT("  bench log\n");
+    const int iter = 2000;
+    uint64_t t0, tSync, tRing;
+    int i;
+
+    t0 = utNowNs();
+    for ( i = 0; i < iter; i++ ) {
+        utLogSync( "bench sync %d\n", i );
+    }
+    tSync = utNowNs() - t0;
+    t0 = utNowNs();
+    for ( i = 0; i < iter; i++ ) {
+        _rdkssa_debug_log( "bench ring %d\n", i );
+        if ( (i & 63) == 63 ) rdkssaLogFlush( );    // stay within the ring, keep the count honest
+    }
+    rdkssaLogFlush( );
+    tRing = utNowNs() - t0;
+    RDKSSA_LOG_UT("    %d lines: sync %llu ns/line, ring (incl. flush) %llu ns/line\n", iter,
+                  (unsigned long long)(tSync/iter), (unsigned long long)(tRing/iter) );
+    RDKSSA_LOG_UT("  bench log SUCCESS\n");
+}
+
+#endif // UNIT_TESTS
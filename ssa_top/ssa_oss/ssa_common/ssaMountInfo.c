@@ -0,0 +1,457 @@
+/*
+ * Copyright 2020 Comcast Cable Communications Management, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+
+#include "rdkssa.h"
+#include "rdkssaCommonProtected.h"
+
+/**
+ * /proc/self/mountinfo snapshot
+ *
+ * The file is read with a few read() calls into one buffer and parsed in place: one entry per line,
+ * pointing into the buffer, in the kernel's order (a mount always comes after the mount it sits on).
+ * Line format (proc(5)):
+ *   id parent major:minor root mountpoint options [optional fields...] - fstype source superoptions
+ * Blanks, tabs, newlines and backslashes in mountpoint and source are escaped as \ooo; they are unescaped.
+ */
+
+#define MOUNTINFO_INITIAL_SIZE      (8192)
+#define MOUNTINFO_MAX_SIZE          (8 << 20)
+
+// next blank-separated field, 0-terminated in place; NULL at the end of the line
+static char *nextField( char **cursor ) {
+    char *p = *cursor, *field;
+    while ( *p == ' ' ) p++;
+    if ( *p == '\0' ) return NULL;
+    field = p;
+    while ( *p != ' ' && *p != '\0' ) p++;
+    if ( *p == ' ' ) *p++ = '\0';
+    *cursor = p;
+    return field;
+}
+
+// undo the kernel's \ooo escapes in place
+static void unescapeOctal( char *s ) {
+    char *d = s;
+    while ( *s != '\0' ) {
+        if ( s[0] == '\\' && s[1] >= '0' && s[1] <= '3' && s[2] >= '0' && s[2] <= '7' && s[3] >= '0' && s[3] <= '7' ) {
+            *d++ = (char)( ( s[1] - '0' ) * 64 + ( s[2] - '0' ) * 8 + ( s[3] - '0' ) );
+            s += 4;
+        } else {
+            *d++ = *s++;
+        }
+    }
+    *d = '\0';
+}
+
+// parse one line into e; 0 or -1 if it is not a mountinfo line
+static int parseLine( char *line, rdkssaMountEntry_t *e ) {
+    char *cursor = line, *f;
+    char *field[5];
+    int i;
+
+    for ( i = 0; i < 5; i++ ) {
+        if ( ( field[i] = nextField( &cursor ) ) == NULL ) return -1;
+    }
+    // optional fields up to the "-" separator
+    while ( ( f = nextField( &cursor ) ) != NULL && strcmp( f, "-" ) != 0 ) {}
+    if ( f == NULL ) return -1;
+    if ( ( e->fsType = nextField( &cursor ) ) == NULL ) return -1;
+    if ( ( e->source = nextField( &cursor ) ) == NULL ) return -1;
+    e->id = atoi( field[0] );
+    e->parentId = atoi( field[1] );
+    e->mountPoint = field[4];
+    unescapeOctal( field[4] );
+    unescapeOctal( (char *)e->source );
+    return 0;
+}
+
+rdkssaStatus_t rdkssaMountInfoParse( rdkssaMountInfo_t *info, char *text ) {
+    char *line, *eol;
+    int lines = 0;
+
+    if ( info == NULL || text == NULL ) {
+        RDKSSA_LOG_ERROR( "NULL ptr passed\n" );
+        return rdkssaBadPointer;
+    }
+    for ( line = text; *line != '\0'; line = eol + 1 ) {
+        lines++;
+        if ( ( eol = strchr( line, '\n' ) ) == NULL ) break;
+    }
+    info->text = text;
+    info->count = 0;
+    info->entry = calloc( lines ? lines : 1, sizeof(rdkssaMountEntry_t) );
+    if ( info->entry == NULL ) {
+        return rdkssaGeneralFailure;
+    }
+    for ( line = text; *line != '\0'; line = eol + 1 ) {
+        eol = strchr( line, '\n' );
+        if ( eol != NULL ) *eol = '\0';
+        if ( parseLine( line, &info->entry[info->count] ) == 0 ) {
+            info->count++;
+        } else if ( *line != '\0' ) {
+            RDKSSA_LOG_ERROR( "  mountinfo line not understood, skipped\n" );
+        }
+        if ( eol == NULL ) break;
+    }
+    return rdkssaOK;
+}
+
+// read a whole (proc) file from the start, 0-terminated; NULL on error
+static char *readFd( int fd, const char *path ) {
+    size_t size = MOUNTINFO_INITIAL_SIZE, used = 0;
+    char *buf = malloc( size ), *bigger;
+    ssize_t n = 0;
+
+    if ( buf == NULL ) return NULL;
+    for ( ;; ) {
+        if ( used + 1 == size ) {
+            if ( size >= MOUNTINFO_MAX_SIZE || ( bigger = realloc( buf, size * 2 ) ) == NULL ) {
+                RDKSSA_LOG_ERROR( "  %s too large\n", path );
+                break;
+            }
+            buf = bigger;
+            size *= 2;
+        }
+        n = pread( fd, buf + used, size - used - 1, (off_t)used );
+        if ( n < 0 && errno == EINTR ) continue;
+        if ( n <= 0 ) break;
+        used += (size_t)n;
+    }
+    if ( n < 0 || used + 1 == size ) {
+        free( buf );
+        return NULL;
+    }
+    buf[used] = '\0';
+    return buf;
+}
+
+static char *readAll( const char *path ) {
+    char *buf;
+    int fd = open( path, O_RDONLY | O_CLOEXEC );
+
+    if ( fd < 0 ) {
+        RDKSSA_LOG_ERROR( "  can't open %s (%d)\n", path, errno );
+        return NULL;
+    }
+    buf = readFd( fd, path );
+    close( fd );
+    return buf;
+}
+
+rdkssaStatus_t rdkssaMountInfoLoadFile( rdkssaMountInfo_t *info, const char *path ) {
+    rdkssaStatus_t ret;
+    char *text;
+
+    if ( info == NULL || path == NULL ) {
+        RDKSSA_LOG_ERROR( "NULL ptr passed\n" );
+        return rdkssaBadPointer;
+    }
+    info->text = NULL;
+    info->entry = NULL;
+    info->count = 0;
+    if ( ( text = readAll( path ) ) == NULL ) {
+        return rdkssaFileError;
+    }
+    ret = rdkssaMountInfoParse( info, text );
+    if ( ret != rdkssaOK ) {
+        free( text );
+        info->text = NULL;
+    }
+    return ret;
+}
+
+rdkssaStatus_t rdkssaMountInfoLoad( rdkssaMountInfo_t *info ) {
+    return rdkssaMountInfoLoadFile( info, RDKSSA_MOUNTINFO_FILE );
+}
+
+void rdkssaMountInfoRelease( rdkssaMountInfo_t *info ) {
+    if ( info == NULL ) return;
+    free( info->entry );
+    free( info->text );
+    info->entry = NULL;
+    info->text = NULL;
+    info->count = 0;
+}
+
+// same path, ignoring trailing slashes on either side
+static int samePath( const char *a, const char *b ) {
+    size_t la = strlen( a ), lb = strlen( b );
+    while ( la > 1 && a[la-1] == '/' ) la--;
+    while ( lb > 1 && b[lb-1] == '/' ) lb--;
+    return la == lb && memcmp( a, b, la ) == 0;
+}
+
+// the topmost (last) entry for the path, if it is mounted
+const rdkssaMountEntry_t *rdkssaMountInfoFind( const rdkssaMountInfo_t *info, const char *mountPoint ) {
+    int i;
+    if ( info == NULL || mountPoint == NULL ) return NULL;
+    for ( i = info->count - 1; i >= 0; i-- ) {
+        if ( samePath( info->entry[i].mountPoint, mountPoint ) ) return &info->entry[i];
+    }
+    return NULL;
+}
+
+const rdkssaMountEntry_t *rdkssaMountInfoFindSource( const rdkssaMountInfo_t *info, const char *source ) {
+    int i;
+    if ( info == NULL || source == NULL ) return NULL;
+    for ( i = info->count - 1; i >= 0; i-- ) {
+        if ( samePath( info->entry[i].source, source ) ) return &info->entry[i];
+    }
+    return NULL;
+}
+
+/**
+ * Cached mount table
+ *
+ * proc files have no useful mtime, but the kernel flags an open mountinfo file with POLLPRI whenever the
+ * mount table changes.  The cache keeps that file open and parses it again only after such a change, so
+ * the common "is it mounted yet" question costs one poll() when nothing has been mounted or unmounted.
+ * The fd belongs to the process that opened it; a forked child opens its own.
+ */
+static struct {
+    pthread_mutex_t lock;
+    int fd;
+    pid_t owner;
+    rdkssaMountInfo_t info;
+    unsigned reloads;
+} mountCache = { PTHREAD_MUTEX_INITIALIZER, -1, 0, { 0, NULL, NULL }, 0 };
+
+// bring the cache up to date, lock held
+static rdkssaStatus_t mountCacheRefresh( void ) {
+    struct pollfd pfd;
+    char *text;
+
+    if ( mountCache.fd >= 0 && mountCache.owner == getpid() ) {
+        pfd.fd = mountCache.fd;
+        pfd.events = POLLPRI;
+        pfd.revents = 0;
+        if ( poll( &pfd, 1, 0 ) == 0 && mountCache.info.entry != NULL ) {
+            return rdkssaOK;    // unchanged
+        }
+    } else {
+        if ( mountCache.fd >= 0 && mountCache.owner != getpid() ) {
+            close( mountCache.fd );
+        }
+        mountCache.fd = open( RDKSSA_MOUNTINFO_FILE, O_RDONLY | O_CLOEXEC );
+        mountCache.owner = getpid();
+        if ( mountCache.fd < 0 ) {
+            RDKSSA_LOG_ERROR( "  can't open %s (%d)\n", RDKSSA_MOUNTINFO_FILE, errno );
+            return rdkssaFileError;
+        }
+    }
+    // reading the file again also clears the change notification
+    rdkssaMountInfoRelease( &mountCache.info );
+    if ( ( text = readFd( mountCache.fd, RDKSSA_MOUNTINFO_FILE ) ) == NULL ) {
+        close( mountCache.fd );
+        mountCache.fd = -1;
+        return rdkssaFileError;
+    }
+    mountCache.reloads++;
+    if ( rdkssaMountInfoParse( &mountCache.info, text ) != rdkssaOK ) {
+        rdkssaMountInfoRelease( &mountCache.info );
+        return rdkssaGeneralFailure;
+    }
+    return rdkssaOK;
+}
+
+rdkssaStatus_t rdkssaMountInfoIsMounted( const char *mountPoint, const char *source, int *mounted ) {
+    const rdkssaMountEntry_t *e;
+    rdkssaStatus_t ret;
+
+    if ( mountPoint == NULL || mounted == NULL ) {
+        RDKSSA_LOG_ERROR( "NULL ptr passed\n" );
+        return rdkssaBadPointer;
+    }
+    pthread_mutex_lock( &mountCache.lock );
+    ret = mountCacheRefresh();
+    *mounted = 0;
+    if ( ret == rdkssaOK && ( e = rdkssaMountInfoFind( &mountCache.info, mountPoint ) ) != NULL ) {
+        *mounted = ( source == NULL || samePath( e->source, source ) );
+    }
+    pthread_mutex_unlock( &mountCache.lock );
+    return ret;
+}
+
+#ifdef UNIT_TESTS
+#include <sys/mount.h>
+#include <sys/stat.h>
+#include "unit_tests.h"
+
+int rdkssaLogLevel = RDKSSA_LOG_LEVEL_DEFAULT;
+
+static void ut_mountInfoParse( void );
+static void ut_mountInfoLoad( void );
+static void ut_mountInfoCache( void );
+static void ut_benchMountInfo( void );
+
+int utmain_mountinfo( int argc, char *argv[] ) {
+    RDKSSA_LOG_UT("=== Unit tests MOUNTINFO begin ===\n");
+
+    ut_mountInfoParse( );
+    ut_mountInfoLoad( );
+    ut_mountInfoCache( );
+    ut_benchMountInfo( );
+
+    RDKSSA_LOG_UT("=== Unit tests MOUNTINFO SUCCESS ===\n");
+    return 0;
+}
+
+int main( int argc, char *argv[] ) {
+    return utmain_mountinfo( argc, argv );
+}
+
+static void ut_mountInfoParse( void ) {
+    RDKSSA_LOG_UT("  mountinfo parse\n");
+    static const char sample[] =
+        "21 1 8:1 / / rw,relatime shared:1 - ext4 /dev/sda1 rw\n"
+        "30 21 0:26 / /nvram rw,nosuid master:4 shared:7 - ubifs ubi0:nvram rw\n"
+        "41 30 0:40 / /nvram/rdk\\040ssa rw,relatime - ecryptfs /nvram/secure\\040path rw,ecryptfs_sig=1\n"
+        "garbage line\n"
+        "42 30 0:41 / /nvram/rdkssa/ rw - ecryptfs /nvram/secure rw\n"
+        "43 42 0:42 / /nvram/rdkssa rw - tmpfs tmpfs rw";
+    rdkssaMountInfo_t info;
+    const rdkssaMountEntry_t *e;
+    char *text = strdup( sample );
+
+    RDKSSA_LOG_UT("  mountinfo parse expect 2 errors\n");
+    UTST( rdkssaMountInfoParse( &info, text ) == rdkssaOK );
+    UTST( info.count == 5 );
+    UTST( info.entry[1].id == 30 && info.entry[1].parentId == 21 );
+    UT_STRCMP( info.entry[1].fsType, "ubifs", 6 );
+    UT_STRCMP( info.entry[1].source, "ubi0:nvram", 11 );
+
+    // escapes
+    UTST( ( e = rdkssaMountInfoFind( &info, "/nvram/rdk ssa" ) ) != NULL );
+    UT_STRCMP( e->source, "/nvram/secure path", 19 );
+    UTST( rdkssaMountInfoFindSource( &info, "/nvram/secure path/" ) == e );
+
+    // stacked mounts: the topmost one, trailing slashes ignored
+    UTST( ( e = rdkssaMountInfoFind( &info, "/nvram/rdkssa/" ) ) != NULL );
+    UTST( e->id == 43 );
+    UTST( rdkssaMountInfoFind( &info, "/" )->id == 21 );
+    UTST( rdkssaMountInfoFindSource( &info, "/nvram/secure" )->id == 42 );
+
+    UTST( rdkssaMountInfoFind( &info, "/nvram/rdk" ) == NULL );
+    UTST( rdkssaMountInfoFind( &info, NULL ) == NULL );
+    UTST( rdkssaMountInfoParse( NULL, text ) == rdkssaBadPointer );
+    rdkssaMountInfoRelease( &info );
+    UTST( info.count == 0 && info.entry == NULL );
+    RDKSSA_LOG_UT("  mountinfo parse SUCCESS\n");
+}
+
+static void ut_mountInfoLoad( void ) {
+    RDKSSA_LOG_UT("  mountinfo load\n");
+    rdkssaMountInfo_t info;
+    const rdkssaMountEntry_t *e;
+    FILE *f;
+    int i;
+
+    UTST( rdkssaMountInfoLoad( &info ) == rdkssaOK );
+    UTST( info.count > 0 );
+    UTST( ( e = rdkssaMountInfoFind( &info, "/proc" ) ) != NULL );
+    UT_STRCMP( e->fsType, "proc", 5 );
+    rdkssaMountInfoRelease( &info );
+
+    // larger than the first buffer
+#define UTMI "/tmp/ut_rdkssa_mountinfo.txt"
+    UTST( ( f = fopen( UTMI, "w" ) ) != NULL );
+    for ( i = 0; i < 1000; i++ ) {
+        fprintf( f, "%d 1 0:%d / /mnt/vol%d rw - tmpfs tmpfs rw\n", 100 + i, i, i );
+    }
+    fclose( f );
+    UTST( rdkssaMountInfoLoadFile( &info, UTMI ) == rdkssaOK );
+    UTST( info.count == 1000 );
+    UTST( rdkssaMountInfoFind( &info, "/mnt/vol999" )->id == 1099 );
+    rdkssaMountInfoRelease( &info );
+    remove( UTMI );
+
+    RDKSSA_LOG_UT("  mountinfo load expect 1 error\n");
+    UTST( rdkssaMountInfoLoadFile( &info, "/notfound/mountinfo" ) == rdkssaFileError );
+    rdkssaMountInfoRelease( &info );
+    RDKSSA_LOG_UT("  mountinfo load SUCCESS\n");
+}
+
+// the cache follows mounts and unmounts, and is not parsed again while nothing changes
+#define UTMI_MNT    "/tmp/ut_rdkssa_mi_mnt"
+#define UTMI_SRC    "/tmp/ut_rdkssa_mi_src"
+static void ut_mountInfoCache( void ) {
+    RDKSSA_LOG_UT("  mountinfo cache\n");
+    unsigned reloads;
+    int mounted;
+
+    UTST( rdkssaMountInfoIsMounted( "/proc", NULL, &mounted ) == rdkssaOK && mounted );
+    reloads = mountCache.reloads;
+    UTST( rdkssaMountInfoIsMounted( "/proc", "proc", &mounted ) == rdkssaOK && mounted );
+    UTST( rdkssaMountInfoIsMounted( "/proc", "/other", &mounted ) == rdkssaOK && !mounted );
+    UTST( rdkssaMountInfoIsMounted( UTMI_MNT, NULL, &mounted ) == rdkssaOK && !mounted );
+    UTST( mountCache.reloads == reloads );
+
+    mkdir( UTMI_MNT, 0700 );
+    if ( mount( UTMI_SRC, UTMI_MNT, "tmpfs", 0, NULL ) != 0 ) {
+        RDKSSA_LOG_UT("  mountinfo cache mount skipped, can't mount tmpfs (%d)\n", errno );
+    } else {
+        UTST( rdkssaMountInfoIsMounted( UTMI_MNT, UTMI_SRC "/", &mounted ) == rdkssaOK && mounted );
+        UTST( mountCache.reloads == reloads + 1 );
+        UTST( rdkssaMountInfoIsMounted( UTMI_MNT, "/tmp/ut_rdkssa_mi_other", &mounted ) == rdkssaOK && !mounted );
+        UTST0( umount( UTMI_MNT ) );
+        UTST( rdkssaMountInfoIsMounted( UTMI_MNT, UTMI_SRC, &mounted ) == rdkssaOK && !mounted );
+        UTST( mountCache.reloads == reloads + 2 );
+    }
+    rmdir( UTMI_MNT );
+    RDKSSA_LOG_UT("  mountinfo cache expect 1 error\n");
+    UTST( rdkssaMountInfoIsMounted( NULL, NULL, &mounted ) == rdkssaBadPointer );
+    RDKSSA_LOG_UT("  mountinfo cache SUCCESS\n");
+}
+
+// bench: what finding out that a volume is not mounted costs, in-process vs. asking a helper
+static void ut_benchMountInfo( void ) {
+    RDKSSA_LOG_UT("  bench mountinfo\n");
+    rdkssaMountInfo_t info;
+    const int iter = 200;
+    uint64_t t0, tLoad, tExec, tCached;
+    int i, mounted;
+
+    t0 = utNowNs();
+    for ( i = 0; i < iter; i++ ) {
+        UTST( rdkssaMountInfoLoad( &info ) == rdkssaOK );
+        UTST( rdkssaMountInfoFind( &info, "/nvram/notmounted" ) == NULL );
+        rdkssaMountInfoRelease( &info );
+    }
+    tLoad = ( utNowNs() - t0 ) / iter;
+    t0 = utNowNs();
+    for ( i = 0; i < iter / 10; i++ ) {
+        UTST( system( "grep -q ' /nvram/notmounted ' /proc/self/mountinfo" ) != 0 );
+    }
+    tExec = ( utNowNs() - t0 ) / ( iter / 10 );
+    t0 = utNowNs();
+    for ( i = 0; i < iter; i++ ) {
+        UTST( rdkssaMountInfoIsMounted( "/nvram/notmounted", NULL, &mounted ) == rdkssaOK && !mounted );
+    }
+    tCached = ( utNowNs() - t0 ) / iter;
+    RDKSSA_LOG_UT("    load+find %llu us, cached %llu ns, helper process %llu us\n",
+                  (unsigned long long)( tLoad / 1000 ), (unsigned long long)tCached,
+                  (unsigned long long)( tExec / 1000 ) );
+    RDKSSA_LOG_UT("  bench mountinfo SUCCESS\n");
+}
+
+#endif // UNIT_TESTS
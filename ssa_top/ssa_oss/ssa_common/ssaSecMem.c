@@ -0,0 +1,360 @@
+/*
+ * Copyright 2020 Comcast Cable Communications Management, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+*/
+
+#include <errno.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#include "rdkssa.h"
+#include "rdkssaCommonProtected.h"
+
+/**
+ * Locked memory for key material
+ *
+ * The region is mapped on first use, locked with one mlock() and marked MADV_DONTDUMP, so key bytes are
+ * never written to swap or to a core file.  One mlock for the region costs less than locking every buffer,
+ * and the free slots are a stack, so the slot freed last, still in cache, is the next one handed out.
+ * If the region can't be locked (RLIMIT_MEMLOCK) it is used unlocked.  Memory that does not come from
+ * the region carries a header with its size, so rdkssaSecFree can wipe it too.
+ */
+#define SECMEM_SIZE         ( (size_t)RDKSSA_SECMEM_SLOTS * RDKSSA_SECMEM_SLOT_SIZE )
+#define SECMEM_MAP_WORDS    ( ( RDKSSA_SECMEM_SLOTS + 63 ) / 64 )
+#define SECMEM_BIT( slot )  ( (uint64_t)1 << ( (slot) % 64 ) )
+
+_Static_assert( RDKSSA_SECMEM_SLOTS <= UINT16_MAX, "RDKSSA_SECMEM_SLOTS" );
+
+// keeps what follows it aligned as malloc would
+typedef union {
+    size_t size;
+    long double ld;
+    long long ll;
+    void *ptr;
+} secmem_hdr_t;
+
+static struct {
+    pthread_mutex_t lock;
+    int state;              /* 0 not set up, 1 set up (base is NULL if the mmap failed) */
+    int locked;
+    uint8_t *base;
+    unsigned nfree;
+    unsigned fallbacks;     /* slot-sized requests that got malloc'd memory */
+    uint16_t freeSlot[RDKSSA_SECMEM_SLOTS];
+    uint64_t inUse[SECMEM_MAP_WORDS];     /* a bit per slot handed out, so a second free is refused */
+} secmem = { PTHREAD_MUTEX_INITIALIZER, 0, 0, NULL, 0, 0, {0}, {0} };
+
+// map, lock and fill the free stack; lock held
+static void secmemSetup( void ) {
+    void *p;
+    unsigned i;
+
+    secmem.state = 1;
+    p = mmap( NULL, SECMEM_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if ( p == MAP_FAILED ) {
+        RDKSSA_LOG_ERROR( "secure memory mmap failed (%d)\n", errno );
+        return;
+    }
+    if ( mlock( p, SECMEM_SIZE ) == 0 ) {
+        secmem.locked = 1;
+    } else {
+        RDKSSA_LOG_INFO( "secure memory not locked (%d)\n", errno );
+    }
+    (void)madvise( p, SECMEM_SIZE, MADV_DONTDUMP );
+    secmem.base = p;
+    for ( i = 0; i < RDKSSA_SECMEM_SLOTS; i++ ) {
+        secmem.freeSlot[i] = (uint16_t)( RDKSSA_SECMEM_SLOTS - 1 - i );     /* slot 0 on top */
+    }
+    secmem.nfree = RDKSSA_SECMEM_SLOTS;
+}
+
+void *rdkssaSecAlloc( size_t size ) {
+    secmem_hdr_t *hdr;
+    uint8_t *slot = NULL;
+    unsigned n;
+
+    if ( size <= RDKSSA_SECMEM_SLOT_SIZE ) {
+        pthread_mutex_lock( &secmem.lock );
+        if ( secmem.state == 0 ) {
+            secmemSetup();
+        }
+        if ( secmem.nfree > 0 ) {
+            n = secmem.freeSlot[--secmem.nfree];
+            secmem.inUse[n / 64] |= SECMEM_BIT( n );
+            slot = secmem.base + (size_t)n * RDKSSA_SECMEM_SLOT_SIZE;
+        } else {
+            secmem.fallbacks++;
+        }
+        pthread_mutex_unlock( &secmem.lock );
+        if ( slot != NULL ) {
+            return slot;    // zero: fresh from mmap, or wiped when it was freed
+        }
+    }
+    if ( size > SIZE_MAX - sizeof( *hdr ) || ( hdr = calloc( 1, sizeof( *hdr ) + size ) ) == NULL ) {
+        RDKSSA_LOG_ERROR( "rdkssaSecAlloc of %zu bytes failed\n", size );
+        return NULL;
+    }
+    hdr->size = size;
+    return hdr + 1;
+}
+
+void rdkssaSecFree( void *mem ) {
+    uint8_t *p = mem;
+    secmem_hdr_t *hdr;
+    size_t offset, n;
+
+    if ( p == NULL ) return;
+    pthread_mutex_lock( &secmem.lock );
+    if ( secmem.base != NULL && p >= secmem.base && p < secmem.base + SECMEM_SIZE ) {
+        offset = (size_t)( p - secmem.base );
+        n = offset / RDKSSA_SECMEM_SLOT_SIZE;
+        if ( offset % RDKSSA_SECMEM_SLOT_SIZE != 0 || ( secmem.inUse[n / 64] & SECMEM_BIT( n ) ) == 0 ) {
+            pthread_mutex_unlock( &secmem.lock );
+            RDKSSA_LOG_ERROR( "rdkssaSecFree of memory that is not an allocated slot\n" );
+            return;
+        }
+        RDKSSA_WIPE( p, RDKSSA_SECMEM_SLOT_SIZE );
+        secmem.inUse[n / 64] &= ~SECMEM_BIT( n );
+        secmem.freeSlot[secmem.nfree++] = (uint16_t)n;
+        pthread_mutex_unlock( &secmem.lock );
+        return;
+    }
+    pthread_mutex_unlock( &secmem.lock );
+    hdr = (secmem_hdr_t *)mem - 1;
+    RDKSSA_WIPE( mem, hdr->size );
+    free( hdr );
+}
+
+rdkssaDataBufPtr_t rdkssaSecDataBuf( size_t sizeOfData ) {
+    rdkssaDataBufPtr_t buf;
+
+    if ( sizeOfData > SIZE_MAX - sizeof( rdkssaDataBuf_t ) ) {
+        RDKSSA_LOG_ERROR( "rdkssaSecDataBuf of %zu bytes failed\n", sizeOfData );
+        return NULL;
+    }
+    if ( ( buf = rdkssaSecAlloc( sizeof( rdkssaDataBuf_t ) + sizeOfData ) ) != NULL ) {
+        buf->sizeOfData = sizeOfData;
+    }
+    return buf;
+}
+
+#ifdef UNIT_TESTS
+#include <stdio.h>
+#include "unit_tests.h"
+
+int rdkssaLogLevel = RDKSSA_LOG_LEVEL_DEFAULT;
+
+static void ut_secAlloc( void );
+static void ut_secFallback( void );
+static void ut_secThreads( void );
+static void ut_benchSecAlloc( void );
+
+int utmain_secmem( int argc, char *argv[] ) {
+    RDKSSA_LOG_UT("=== Unit tests SECMEM begin ===\n");
+
+    ut_secAlloc( );
+    ut_secFallback( );
+    ut_secThreads( );
+    ut_benchSecAlloc( );
+
+    RDKSSA_LOG_UT("=== Unit tests SECMEM SUCCESS ===\n");
+    return 0;
+}
+
+int main( int argc, char *argv[] ) {
+    return utmain_secmem( argc, argv );
+}
+
+static int utInRegion( const void *p ) {
+    return secmem.base != NULL && (const uint8_t *)p >= secmem.base && (const uint8_t *)p < secmem.base + SECMEM_SIZE;
+}
+
+static int utIsZero( const uint8_t *p, size_t len ) {
+    size_t i;
+    for ( i = 0; i < len; i++ ) {
+        if ( p[i] != 0 ) return 0;
+    }
+    return 1;
+}
+
+// VmFlags of the mapping at addr, from /proc/self/smaps
+static int utVmFlags( const void *addr, char *flags, size_t size ) {
+    char line[256];
+    unsigned long lo, hi;
+    int in = 0, found = 0;
+    FILE *f = fopen( "/proc/self/smaps", "re" );
+
+    if ( f == NULL ) return 0;
+    while ( !found && fgets( line, sizeof( line ), f ) != NULL ) {
+        if ( sscanf( line, "%lx-%lx ", &lo, &hi ) == 2 ) {
+            in = ( (unsigned long)addr >= lo && (unsigned long)addr < hi );
+        } else if ( in && strncmp( line, "VmFlags:", 8 ) == 0 ) {
+            snprintf( flags, size, "%s", line + 8 );
+            found = 1;
+        }
+    }
+    fclose( f );
+    return found;
+}
+
+static void ut_secAlloc( void ) {
+    RDKSSA_LOG_UT("  secure alloc/free\n");
+    char flags[256];
+    uint8_t *a, *b;
+    rdkssaDataBufPtr_t buf;
+
+    UTST( ( a = rdkssaSecAlloc( 64 ) ) != NULL );
+    UTST( utInRegion( a ) && utIsZero( a, RDKSSA_SECMEM_SLOT_SIZE ) );
+    UTST( utVmFlags( a, flags, sizeof( flags ) ) );
+    UTST( strstr( flags, " dd" ) != NULL );     // not dumped
+    if ( secmem.locked ) {
+        UTST( strstr( flags, " lo" ) != NULL );
+    } else {
+        RDKSSA_LOG_UT("    region not locked (RLIMIT_MEMLOCK), lock check skipped\n");
+    }
+    memset( a, 0xa5, RDKSSA_SECMEM_SLOT_SIZE );
+    UTST( ( b = rdkssaSecAlloc( RDKSSA_SECMEM_SLOT_SIZE ) ) != NULL && utInRegion( b ) && b != a );
+    rdkssaSecFree( a );
+    UTST( utIsZero( a, RDKSSA_SECMEM_SLOT_SIZE ) );
+    // last freed, first reused
+    UTST( rdkssaSecAlloc( 1 ) == a );
+    rdkssaSecFree( a );
+    rdkssaSecFree( b );
+    rdkssaSecFree( NULL );
+
+    UTST( ( buf = rdkssaSecDataBuf( 32 ) ) != NULL && utInRegion( buf ) && buf->sizeOfData == 32 );
+    memset( buf->dataBuffer, 0x5a, 32 );
+    rdkssaSecFree( buf );
+    UTST( utIsZero( (uint8_t *)buf, sizeof( rdkssaDataBuf_t ) + 32 ) );
+    UTST( secmem.nfree == RDKSSA_SECMEM_SLOTS );
+
+    RDKSSA_LOG_UT("  expect 1 error\n");
+    rdkssaSecFree( secmem.base + 1 );
+    UTST( secmem.nfree == RDKSSA_SECMEM_SLOTS );
+
+    // a slot freed twice while others are in use is not handed out twice
+    UTST( ( a = rdkssaSecAlloc( 16 ) ) != NULL && ( b = rdkssaSecAlloc( 16 ) ) != NULL );
+    rdkssaSecFree( a );
+    RDKSSA_LOG_UT("  expect 1 error\n");
+    rdkssaSecFree( a );
+    UTST( secmem.nfree == RDKSSA_SECMEM_SLOTS - 1 );
+    UTST( rdkssaSecAlloc( 16 ) == a );
+    UTST( ( buf = rdkssaSecAlloc( 16 ) ) != NULL && (uint8_t *)buf != a && (uint8_t *)buf != b );
+    rdkssaSecFree( buf );
+    rdkssaSecFree( a );
+    rdkssaSecFree( b );
+    UTST( secmem.nfree == RDKSSA_SECMEM_SLOTS );
+    RDKSSA_LOG_UT("  secure alloc/free SUCCESS\n");
+}
+
+// too big, or no slot left: malloc'd memory, still zeroed and wiped
+static void ut_secFallback( void ) {
+    RDKSSA_LOG_UT("  secure fallback\n");
+    uint8_t *slot[RDKSSA_SECMEM_SLOTS], *big, *extra;
+    unsigned fallbacks = secmem.fallbacks;
+    int i;
+
+    UTST( ( big = rdkssaSecAlloc( 4 * RDKSSA_SECMEM_SLOT_SIZE ) ) != NULL && !utInRegion( big ) );
+    UTST( utIsZero( big, 4 * RDKSSA_SECMEM_SLOT_SIZE ) );
+    memset( big, 0xa5, 4 * RDKSSA_SECMEM_SLOT_SIZE );
+    rdkssaSecFree( big );
+    UTST( secmem.fallbacks == fallbacks );
+
+    for ( i = 0; i < RDKSSA_SECMEM_SLOTS; i++ ) {
+        UTST( ( slot[i] = rdkssaSecAlloc( 16 ) ) != NULL && utInRegion( slot[i] ) );
+    }
+    UTST( secmem.nfree == 0 );
+    UTST( ( extra = rdkssaSecAlloc( 16 ) ) != NULL && !utInRegion( extra ) && utIsZero( extra, 16 ) );
+    UTST( secmem.fallbacks == fallbacks + 1 );
+    rdkssaSecFree( extra );
+    for ( i = 0; i < RDKSSA_SECMEM_SLOTS; i++ ) {
+        rdkssaSecFree( slot[i] );
+    }
+    UTST( secmem.nfree == RDKSSA_SECMEM_SLOTS );
+    RDKSSA_LOG_UT("  expect 1 error\n");
+    UTST( rdkssaSecDataBuf( SIZE_MAX ) == NULL );
+    RDKSSA_LOG_UT("  secure fallback SUCCESS\n");
+}
+
+#define UT_THREADS      (4)
+#define UT_ROUNDS       (20000)
+
+// every thread fills its buffers with its own byte and checks nobody else wrote to them
+static void *utSecThread( void *arg ) {
+    uint8_t mark = (uint8_t)(uintptr_t)arg, *p[3];
+    int r, i;
+
+    for ( r = 0; r < UT_ROUNDS; r++ ) {
+        for ( i = 0; i < 3; i++ ) {
+            UTST( ( p[i] = rdkssaSecAlloc( 100 ) ) != NULL && utIsZero( p[i], 100 ) );
+            memset( p[i], mark, 100 );
+        }
+        for ( i = 0; i < 3; i++ ) {
+            UTST( p[i][0] == mark && p[i][99] == mark );
+            rdkssaSecFree( p[i] );
+        }
+    }
+    return NULL;
+}
+
+static void ut_secThreads( void ) {
+    RDKSSA_LOG_UT("  secure threads\n");
+    pthread_t t[UT_THREADS];
+    uintptr_t i;
+
+    for ( i = 0; i < UT_THREADS; i++ ) {
+        UTST( pthread_create( &t[i], NULL, utSecThread, (void *)( i + 1 ) ) == 0 );
+    }
+    for ( i = 0; i < UT_THREADS; i++ ) {
+        UTST( pthread_join( t[i], NULL ) == 0 );
+    }
+    UTST( secmem.nfree == RDKSSA_SECMEM_SLOTS );
+    RDKSSA_LOG_UT("  secure threads SUCCESS\n");
+}
+
+// bench: a key buffer from the region vs. malloc and locking it for its lifetime
+static void ut_benchSecAlloc( void ) {
+    RDKSSA_LOG_UT("  bench secure alloc\n");
+    const int iter = 20000;
+    uint64_t t0, tSlot, tLock;
+    uint8_t *p;
+    int i;
+
+    t0 = utNowNs();
+    for ( i = 0; i < iter; i++ ) {
+        UTST( ( p = rdkssaSecAlloc( 64 ) ) != NULL );
+        p[0] = 1;
+        rdkssaSecFree( p );
+    }
+    tSlot = ( utNowNs() - t0 ) / iter;
+    t0 = utNowNs();
+    for ( i = 0; i < iter; i++ ) {
+        UTST( ( p = calloc( 1, 64 ) ) != NULL );
+        (void)mlock( p, 64 );
+        p[0] = 1;
+        RDKSSA_WIPE( p, 64 );
+        (void)munlock( p, 64 );
+        free( p );
+    }
+    tLock = ( utNowNs() - t0 ) / iter;
+    RDKSSA_LOG_UT("    slot %llu ns, malloc+mlock %llu ns\n", (unsigned long long)tSlot, (unsigned long long)tLock );
+    RDKSSA_LOG_UT("  bench secure alloc SUCCESS\n");
+}
+
+#endif // UNIT_TESTS
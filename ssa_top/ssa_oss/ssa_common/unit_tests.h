@@ -19,7 +19,7 @@
 #ifndef __unit_tests__
 #define __unit_tests__
 
-#if defined(UNIT_TESTS) || defined(PLTFORM_TEST)
+#if defined(UNIT_TESTS) || defined(PLTFORM_TEST) || defined(MOUNT_STRESS_TEST) || defined(MOUNT_BENCH)
 #include <assert.h>
 #define UTST( t ) assert( (t) != 0 )
 #define UTST0( t ) assert( (t) == 0 )
@@ -31,6 +31,14 @@
 #define UT_REMOVE( f ) {printf("rm %s\n", (f)?(f):"");assert( remove( f ) == 0 );}
 #define UT_EXIT( ) {printf("Early Exit\n");assert( 0 );}
 
+// ut timing, for micro-benchmarks
+#include <time.h>
+static inline uint64_t utNowNs( void ) {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec*1000000000ull + ts.tv_nsec;
+}
+
 // exit codes
 #define UT_OK   0
 #define UT_ERR  1
@@ -50,7 +58,7 @@
 #ifdef USE_COLORS
 #define PREFIXU(formatu)                (COL_CYA"%12s:%3d:%12s - " formatu COL_DEF)
 #define LOG_UNITTEST(formatu, ...)        {fprintf(stdout, formatu, __VA_ARGS__);fflush(stdout);}
-#define RDKSSA_LOG_UT(formatu, ...)     LOG_UNITTEST(PREFIXU("UT:" formatu), strrchr(__FILE__,'/')+1,__LINE__,__FUNCTION__, ##__VA_ARGS__)
+#define RDKSSA_LOG_UT(formatu, ...)     LOG_UNITTEST(PREFIXU("UT:" formatu), RDKSSA_FILE_NAME,__LINE__,__FUNCTION__, ##__VA_ARGS__)
 #else
 #define PREFIXU(formatu)                  ("%d\t: %s - " formatu)
 #define LOG_UNITTEST(formatu, ...)        {fprintf(stdout, formatu, __VA_ARGS__);fflush(stdout);}